@@ -0,0 +1,286 @@
+#include "BlockCompress.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// RGB565 helpers
+static uint16_t packRGB565(const float* c)
+{
+    int r = (int)std::lround(std::max(0.0f, std::min(255.0f, c[0])) * 31.0f / 255.0f);
+    int g = (int)std::lround(std::max(0.0f, std::min(255.0f, c[1])) * 63.0f / 255.0f);
+    int b = (int)std::lround(std::max(0.0f, std::min(255.0f, c[2])) * 31.0f / 255.0f);
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+static void unpackRGB565(uint16_t c, float* out)
+{
+    int r = (c >> 11) & 31;
+    int g = (c >> 5) & 63;
+    int b = c & 31;
+    out[0] = (float)((r << 3) | (r >> 2));
+    out[1] = (float)((g << 2) | (g >> 4));
+    out[2] = (float)((b << 3) | (b >> 2));
+}
+
+static float distSq(const float* a, const float* b)
+{
+    float dr = a[0] - b[0];
+    float dg = a[1] - b[1];
+    float db = a[2] - b[2];
+    return dr * dr + dg * dg + db * db;
+}
+
+// Picks the nearest of the 4 palette entries per pixel, returns total squared error
+static float assignBC1Indices(const float (*px)[3], uint16_t c0, uint16_t c1, uint8_t* indices)
+{
+    float pal[4][3];
+    unpackRGB565(c0, pal[0]);
+    unpackRGB565(c1, pal[1]);
+    for (int k = 0; k < 3; ++k)
+    {
+        pal[2][k] = (2.0f * pal[0][k] + pal[1][k]) / 3.0f;
+        pal[3][k] = (pal[0][k] + 2.0f * pal[1][k]) / 3.0f;
+    }
+
+    float err = 0.0f;
+    for (int i = 0; i < 16; ++i)
+    {
+        int best = 0;
+        float bestD = distSq(px[i], pal[0]);
+        for (int p = 1; p < 4; ++p)
+        {
+            float d = distSq(px[i], pal[p]);
+            if (d < bestD)
+            {
+                bestD = d;
+                best = p;
+            }
+        }
+        indices[i] = (uint8_t)best;
+        err += bestD;
+    }
+    return err;
+}
+
+// Least-squares endpoints for a fixed index assignment
+static bool refineBC1Endpoints(const float (*px)[3], const uint8_t* indices, float* e0, float* e1)
+{
+    static const float weight0[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    float ax[3] = {}, bx[3] = {};
+    for (int i = 0; i < 16; ++i)
+    {
+        float a = weight0[indices[i]];
+        float b = 1.0f - a;
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for (int k = 0; k < 3; ++k)
+        {
+            ax[k] += a * px[i][k];
+            bx[k] += b * px[i][k];
+        }
+    }
+
+    float det = aa * bb - ab * ab;
+    if (std::fabs(det) < 1e-6f)
+        return false;
+
+    float inv = 1.0f / det;
+    for (int k = 0; k < 3; ++k)
+    {
+        e0[k] = (ax[k] * bb - bx[k] * ab) * inv;
+        e1[k] = (bx[k] * aa - ax[k] * ab) * inv;
+    }
+    return true;
+}
+
+// Writes c0/c1 in 4-colour order (c0 > c1) and the 2-bit indices
+static void writeBC1Block(uint16_t c0, uint16_t c1, uint8_t* indices, uint8_t* out)
+{
+    if (c0 < c1)
+    {
+        std::swap(c0, c1);
+        // swapping endpoints maps 0<->1 and 2<->3
+        for (int i = 0; i < 16; ++i)
+            indices[i] ^= 1;
+    }
+    else if (c0 == c1)
+    {
+        // Solid block: every pixel uses endpoint 0
+        memset(indices, 0, 16);
+    }
+
+    uint32_t bits = 0;
+    for (int i = 0; i < 16; ++i)
+        bits |= (uint32_t)indices[i] << (2 * i);
+
+    out[0] = (uint8_t)(c0 & 0xFF);
+    out[1] = (uint8_t)(c0 >> 8);
+    out[2] = (uint8_t)(c1 & 0xFF);
+    out[3] = (uint8_t)(c1 >> 8);
+    out[4] = (uint8_t)(bits & 0xFF);
+    out[5] = (uint8_t)((bits >> 8) & 0xFF);
+    out[6] = (uint8_t)((bits >> 16) & 0xFF);
+    out[7] = (uint8_t)(bits >> 24);
+}
+
+void encodeBC1(const uint8_t* rgba, uint8_t* out)
+{
+    float px[16][3];
+    float mean[3] = {};
+    for (int i = 0; i < 16; ++i)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            px[i][k] = (float)rgba[i * 4 + k];
+            mean[k] += px[i][k];
+        }
+    }
+    for (int k = 0; k < 3; ++k)
+        mean[k] /= 16.0f;
+
+    // Principal axis of the block's colours (power iteration on the covariance)
+    float cov[6] = {};
+    for (int i = 0; i < 16; ++i)
+    {
+        float r = px[i][0] - mean[0];
+        float g = px[i][1] - mean[1];
+        float b = px[i][2] - mean[2];
+        cov[0] += r * r; cov[1] += r * g; cov[2] += r * b;
+        cov[3] += g * g; cov[4] += g * b; cov[5] += b * b;
+    }
+
+    float axis[3] = { 1.0f, 1.0f, 1.0f };
+    for (int it = 0; it < 8; ++it)
+    {
+        float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+        float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+        float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+        float len = std::max(std::fabs(x), std::max(std::fabs(y), std::fabs(z)));
+        if (len < 1e-6f)
+            break;
+        axis[0] = x / len;
+        axis[1] = y / len;
+        axis[2] = z / len;
+    }
+
+    // Extremes along the axis, inset slightly to reduce error on the interpolated entries
+    float minT = 1e30f, maxT = -1e30f;
+    for (int i = 0; i < 16; ++i)
+    {
+        float t = (px[i][0] - mean[0]) * axis[0] + (px[i][1] - mean[1]) * axis[1] + (px[i][2] - mean[2]) * axis[2];
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+    float axisLenSq = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+    if (axisLenSq > 0.0f)
+    {
+        minT /= axisLenSq;
+        maxT /= axisLenSq;
+    }
+    float inset = (maxT - minT) / 16.0f;
+    minT += inset;
+    maxT -= inset;
+
+    float e0[3], e1[3];
+    for (int k = 0; k < 3; ++k)
+    {
+        e0[k] = mean[k] + axis[k] * maxT;
+        e1[k] = mean[k] + axis[k] * minT;
+    }
+
+    uint16_t c0 = packRGB565(e0);
+    uint16_t c1 = packRGB565(e1);
+    uint8_t indices[16];
+    float err = assignBC1Indices(px, c0, c1, indices);
+
+    // A couple of least-squares passes usually shave a good chunk off the error
+    for (int it = 0; it < 2 && err > 0.0f; ++it)
+    {
+        float r0[3], r1[3];
+        if (!refineBC1Endpoints(px, indices, r0, r1))
+            break;
+
+        uint16_t n0 = packRGB565(r0);
+        uint16_t n1 = packRGB565(r1);
+        uint8_t nIdx[16];
+        float nErr = assignBC1Indices(px, n0, n1, nIdx);
+        if (nErr >= err)
+            break;
+
+        c0 = n0;
+        c1 = n1;
+        err = nErr;
+        memcpy(indices, nIdx, sizeof(indices));
+    }
+
+    writeBC1Block(c0, c1, indices, out);
+}
+
+void encodeBC4(const uint8_t* values, uint8_t* out)
+{
+    uint8_t lo = 255, hi = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        lo = std::min(lo, values[i]);
+        hi = std::max(hi, values[i]);
+    }
+
+    // 8-value mode (a0 > a1): palette is a0, a1 and six evenly spaced steps between
+    float pal[8];
+    pal[0] = hi;
+    pal[1] = lo;
+    for (int k = 1; k <= 6; ++k)
+        pal[k + 1] = ((7 - k) * (float)hi + k * (float)lo) / 7.0f;
+
+    uint64_t bits = 0;
+    if (hi != lo)
+    {
+        for (int i = 0; i < 16; ++i)
+        {
+            int best = 0;
+            float bestD = std::fabs(values[i] - pal[0]);
+            for (int p = 1; p < 8; ++p)
+            {
+                float d = std::fabs(values[i] - pal[p]);
+                if (d < bestD)
+                {
+                    bestD = d;
+                    best = p;
+                }
+            }
+            bits |= (uint64_t)best << (3 * i);
+        }
+    }
+
+    out[0] = hi;
+    out[1] = lo;
+    for (int b = 0; b < 6; ++b)
+        out[2 + b] = (uint8_t)((bits >> (8 * b)) & 0xFF);
+}
+
+void encodeBC3(const uint8_t* rgba, uint8_t* out)
+{
+    uint8_t alpha[16];
+    for (int i = 0; i < 16; ++i)
+        alpha[i] = rgba[i * 4 + 3];
+
+    encodeBC4(alpha, out);
+    encodeBC1(rgba, out + 8);
+}
+
+void encodeBC5(const uint8_t* rg, uint8_t* out)
+{
+    uint8_t r[16], g[16];
+    for (int i = 0; i < 16; ++i)
+    {
+        r[i] = rg[i * 2 + 0];
+        g[i] = rg[i * 2 + 1];
+    }
+
+    encodeBC4(r, out);
+    encodeBC4(g, out + 8);
+}
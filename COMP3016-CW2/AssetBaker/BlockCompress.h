@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+// BCn block encoders used by the texture baker
+// Every function takes one 4x4 block of 8-bit pixels (16 entries, row-major)
+// and writes one compressed block.
+
+// BC1: RGB, 8 bytes. rgba is 16 * 4 bytes, alpha is ignored
+void encodeBC1(const uint8_t* rgba, uint8_t* out);
+
+// BC3: RGB + interpolated alpha, 16 bytes
+void encodeBC3(const uint8_t* rgba, uint8_t* out);
+
+// BC4: single channel, 8 bytes. values is 16 bytes
+void encodeBC4(const uint8_t* values, uint8_t* out);
+
+// BC5: two independent channels (tangent-space normal XY), 16 bytes. rg is 16 * 2 bytes
+void encodeBC5(const uint8_t* rg, uint8_t* out);
@@ -0,0 +1,324 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Overdraw clusters may cost at most this much ACMR over the cache-optimal order
+static const float OVERDRAW_ACMR_THRESHOLD = 1.05f;
+
+VertexCacheStats simulateVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, unsigned cacheSize)
+{
+    VertexCacheStats stats;
+    stats.triangles = indexCount / 3;
+
+    // Timestamp FIFO: a vertex is cached while fewer than cacheSize misses happened since it was loaded
+    std::vector<size_t> loadedAt(vertexCount, 0);
+    std::vector<bool> used(vertexCount, false);
+    size_t time = cacheSize + 1;
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        uint32_t v = indices[i];
+        if (!used[v])
+        {
+            used[v] = true;
+            stats.vertices++;
+        }
+        if (time - loadedAt[v] > cacheSize)
+        {
+            loadedAt[v] = time++;
+            stats.misses++;
+        }
+    }
+    return stats;
+}
+
+// Vertex -> triangle adjacency in CSR form
+struct TriangleAdjacency
+{
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> triangles;
+};
+
+static void buildAdjacency(TriangleAdjacency& adj, const uint32_t* indices, size_t indexCount, size_t vertexCount)
+{
+    adj.offsets.assign(vertexCount + 1, 0);
+    for (size_t i = 0; i < indexCount; ++i)
+        adj.offsets[indices[i] + 1]++;
+    for (size_t v = 0; v < vertexCount; ++v)
+        adj.offsets[v + 1] += adj.offsets[v];
+
+    std::vector<uint32_t> fill(adj.offsets.begin(), adj.offsets.end() - 1);
+    adj.triangles.resize(indexCount);
+    for (size_t i = 0; i < indexCount; ++i)
+        adj.triangles[fill[indices[i]]++] = (uint32_t)(i / 3);
+}
+
+// Tipsify: fan around the current vertex, then move to the candidate that is
+// still in the cache with the most live triangles, or back along a dead-end stack
+static void tipsify(std::vector<uint32_t>& out, const uint32_t* indices, size_t indexCount, size_t vertexCount, unsigned cacheSize)
+{
+    const size_t triCount = indexCount / 3;
+    TriangleAdjacency adj;
+    buildAdjacency(adj, indices, indexCount, vertexCount);
+
+    std::vector<uint32_t> live(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v)
+        live[v] = adj.offsets[v + 1] - adj.offsets[v];
+
+    std::vector<size_t> cacheTime(vertexCount, 0);
+    std::vector<bool> emitted(triCount, false);
+    std::vector<uint32_t> deadEnd;
+    std::vector<uint32_t> candidates;
+    size_t time = cacheSize + 1;
+    size_t cursor = 0;
+
+    out.clear();
+    out.reserve(indexCount);
+
+    // First referenced vertex
+    long long fan = -1;
+    while (cursor < vertexCount && live[cursor] == 0)
+        ++cursor;
+    if (cursor < vertexCount)
+        fan = (long long)cursor;
+
+    while (fan >= 0)
+    {
+        candidates.clear();
+        for (uint32_t a = adj.offsets[fan]; a < adj.offsets[fan + 1]; ++a)
+        {
+            uint32_t t = adj.triangles[a];
+            if (emitted[t])
+                continue;
+
+            for (int k = 0; k < 3; ++k)
+            {
+                uint32_t v = indices[t * 3 + k];
+                out.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                live[v]--;
+                if (time - cacheTime[v] > cacheSize)
+                    cacheTime[v] = time++;
+            }
+            emitted[t] = true;
+        }
+
+        // Best candidate: still cached after its remaining fan would be emitted, oldest first
+        long long next = -1;
+        long long best = -1;
+        for (uint32_t v : candidates)
+        {
+            if (live[v] == 0)
+                continue;
+
+            long long priority = 0;
+            if (time - cacheTime[v] + 2 * live[v] <= cacheSize)
+                priority = (long long)(time - cacheTime[v]);
+            if (priority > best)
+            {
+                best = priority;
+                next = v;
+            }
+        }
+
+        if (next < 0)
+        {
+            // Dead end: most recently touched vertex with work left, else the next one in index order
+            while (!deadEnd.empty() && next < 0)
+            {
+                uint32_t v = deadEnd.back();
+                deadEnd.pop_back();
+                if (live[v] > 0)
+                    next = v;
+            }
+            while (next < 0 && cursor < vertexCount)
+            {
+                if (live[cursor] > 0)
+                    next = (long long)cursor;
+                ++cursor;
+            }
+        }
+        fan = next;
+    }
+}
+
+// Cluster boundaries: hard ones where the cache was effectively flushed (all
+// three vertices missed), then soft ones inside those wherever the running
+// ACMR is still within the threshold of the whole cluster's
+static void buildClusters(std::vector<uint32_t>& clusterStarts, const uint32_t* indices, size_t indexCount, size_t vertexCount, unsigned cacheSize)
+{
+    const size_t triCount = indexCount / 3;
+    std::vector<size_t> cacheTime(vertexCount, 0);
+    std::vector<unsigned> triMisses(triCount);
+    size_t time = cacheSize + 1;
+
+    std::vector<uint32_t> hard;
+    for (size_t t = 0; t < triCount; ++t)
+    {
+        unsigned misses = 0;
+        for (int k = 0; k < 3; ++k)
+        {
+            uint32_t v = indices[t * 3 + k];
+            if (time - cacheTime[v] > cacheSize)
+            {
+                cacheTime[v] = time++;
+                misses++;
+            }
+        }
+        triMisses[t] = misses;
+        if (t == 0 || misses == 3)
+            hard.push_back((uint32_t)t);
+    }
+    hard.push_back((uint32_t)triCount);
+
+    clusterStarts.clear();
+    for (size_t h = 0; h + 1 < hard.size(); ++h)
+    {
+        uint32_t begin = hard[h];
+        uint32_t end = hard[h + 1];
+
+        size_t clusterMisses = 0;
+        for (uint32_t t = begin; t < end; ++t)
+            clusterMisses += triMisses[t];
+        float limit = (float)clusterMisses / (end - begin) * OVERDRAW_ACMR_THRESHOLD;
+
+        // Splitting restarts the cache, so only split once the running ACMR has settled under the limit
+        clusterStarts.push_back(begin);
+        size_t misses = 0;
+        uint32_t start = begin;
+        for (uint32_t t = begin; t < end; ++t)
+        {
+            misses += triMisses[t];
+            if (t + 1 < end && t + 1 - start >= 8 && (float)misses / (t + 1 - start) <= limit)
+            {
+                clusterStarts.push_back(t + 1);
+                start = t + 1;
+                misses = 0;
+            }
+        }
+    }
+}
+
+static void sortClustersForOverdraw(std::vector<uint32_t>& indices, const std::vector<uint32_t>& clusterStarts, const BakedVertex* vertices)
+{
+    const size_t triCount = indices.size() / 3;
+    const size_t clusterCount = clusterStarts.size();
+
+    // Area-weighted centroid and normal per cluster, plus the whole submesh's centroid
+    std::vector<float> sortKey(clusterCount);
+    std::vector<float> centroids(clusterCount * 3, 0.0f);
+    std::vector<float> normals(clusterCount * 3, 0.0f);
+    float meshCentroid[3] = { 0.0f, 0.0f, 0.0f };
+    float meshArea = 0.0f;
+
+    for (size_t c = 0; c < clusterCount; ++c)
+    {
+        size_t end = (c + 1 < clusterCount) ? clusterStarts[c + 1] : triCount;
+        float area = 0.0f;
+        for (size_t t = clusterStarts[c]; t < end; ++t)
+        {
+            const float* p0 = vertices[indices[t * 3 + 0]].position;
+            const float* p1 = vertices[indices[t * 3 + 1]].position;
+            const float* p2 = vertices[indices[t * 3 + 2]].position;
+
+            float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+            float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+            float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+            float a = 0.5f * std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+            for (int k = 0; k < 3; ++k)
+            {
+                centroids[c * 3 + k] += (p0[k] + p1[k] + p2[k]) / 3.0f * a;
+                normals[c * 3 + k] += n[k];
+            }
+            area += a;
+        }
+
+        for (int k = 0; k < 3; ++k)
+        {
+            meshCentroid[k] += centroids[c * 3 + k];
+            if (area > 0.0f) centroids[c * 3 + k] /= area;
+        }
+        meshArea += area;
+    }
+
+    if (meshArea > 0.0f)
+    {
+        for (int k = 0; k < 3; ++k)
+            meshCentroid[k] /= meshArea;
+    }
+
+    // Clusters facing away from the centre are on the outside and likely to occlude the rest
+    for (size_t c = 0; c < clusterCount; ++c)
+    {
+        float* n = &normals[c * 3];
+        float len = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        float key = 0.0f;
+        if (len > 0.0f)
+        {
+            for (int k = 0; k < 3; ++k)
+                key += (centroids[c * 3 + k] - meshCentroid[k]) * n[k] / len;
+        }
+        sortKey[c] = key;
+    }
+
+    std::vector<uint32_t> order(clusterCount);
+    for (size_t c = 0; c < clusterCount; ++c)
+        order[c] = (uint32_t)c;
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+        {
+            return sortKey[a] > sortKey[b];
+        });
+
+    std::vector<uint32_t> sorted;
+    sorted.reserve(indices.size());
+    for (uint32_t c : order)
+    {
+        size_t end = (c + 1 < clusterCount) ? clusterStarts[c + 1] : triCount;
+        sorted.insert(sorted.end(), indices.begin() + clusterStarts[c] * 3, indices.begin() + end * 3);
+    }
+    indices.swap(sorted);
+}
+
+// Renumbers vertices in first-use order and permutes the vertex array to match
+static void optimizeVertexFetch(uint32_t* indices, size_t indexCount, BakedVertex* vertices, size_t vertexCount)
+{
+    const uint32_t UNUSED = 0xffffffffu;
+    std::vector<uint32_t> remap(vertexCount, UNUSED);
+    uint32_t next = 0;
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        uint32_t& r = remap[indices[i]];
+        if (r == UNUSED)
+            r = next++;
+        indices[i] = r;
+    }
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        if (remap[v] == UNUSED)
+            remap[v] = next++;
+    }
+
+    std::vector<BakedVertex> reordered(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v)
+        reordered[remap[v]] = vertices[v];
+    std::copy(reordered.begin(), reordered.end(), vertices);
+}
+
+void optimizeSubmesh(uint32_t* indices, size_t indexCount, BakedVertex* vertices, size_t vertexCount)
+{
+    if (indexCount < 3 || vertexCount == 0)
+        return;
+
+    std::vector<uint32_t> ordered;
+    tipsify(ordered, indices, indexCount, vertexCount, VERTEX_CACHE_SIZE);
+
+    std::vector<uint32_t> clusterStarts;
+    buildClusters(clusterStarts, ordered.data(), ordered.size(), vertexCount, VERTEX_CACHE_SIZE);
+    sortClustersForOverdraw(ordered, clusterStarts, vertices);
+
+    std::copy(ordered.begin(), ordered.end(), indices);
+    optimizeVertexFetch(indices, indexCount, vertices, vertexCount);
+}
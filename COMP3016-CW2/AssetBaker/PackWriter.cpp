@@ -0,0 +1,191 @@
+#include "PackWriter.h"
+#include "PackFormat.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include <sys/stat.h>
+
+struct PackMember
+{
+    std::string source;
+    std::string key;
+    std::vector<unsigned char> bytes;
+    PackEntry entry;
+};
+
+static bool readWholeFile(const char* path, std::vector<unsigned char>& out)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f)
+        return false;
+
+    bool ok = fseek(f, 0, SEEK_END) == 0;
+    long size = ok ? ftell(f) : -1;
+    ok = ok && size >= 0 && fseek(f, 0, SEEK_SET) == 0;
+    if (ok)
+    {
+        out.resize((size_t)size);
+        ok = size == 0 || fread(out.data(), 1, out.size(), f) == out.size();
+    }
+    fclose(f);
+    return ok;
+}
+
+// Same member list as last time and nothing touched since
+static bool packIsUpToDate(const char* path, const std::vector<std::string>& files)
+{
+    struct stat pack;
+    if (stat(path, &pack) != 0)
+        return false;
+
+    PackHeader hdr;
+    FILE* f = fopen(path, "rb");
+    if (!f)
+        return false;
+    bool read = fread(&hdr, sizeof(hdr), 1, f) == 1;
+    fclose(f);
+
+    std::vector<std::string> keys;
+    for (const std::string& file : files)
+        keys.push_back(normalizePackPath(file));
+    if (!read || memcmp(hdr.magic, PACK_FORMAT_MAGIC, sizeof(hdr.magic)) != 0 ||
+        hdr.version != PACK_FORMAT_VERSION || hdr.memberHash != hashPackMembers(keys))
+        return false;
+
+    for (const std::string& file : files)
+    {
+        struct stat member;
+        if (stat(file.c_str(), &member) != 0 || member.st_mtime > pack.st_mtime)
+            return false;
+    }
+    return true;
+}
+
+static bool writeZeros(FILE* f, uint64_t count)
+{
+    static const unsigned char zeros[PACK_FORMAT_ALIGN] = {};
+    while (count > 0)
+    {
+        size_t n = (size_t)std::min<uint64_t>(count, sizeof(zeros));
+        if (fwrite(zeros, 1, n, f) != n)
+            return false;
+        count -= n;
+    }
+    return true;
+}
+
+// Pads up to offset (which must not be behind the current position)
+static bool writeAt(FILE* f, uint64_t& pos, uint64_t offset, const void* data, size_t bytes)
+{
+    if (!writeZeros(f, offset - pos))
+        return false;
+    if (bytes > 0 && fwrite(data, 1, bytes, f) != bytes)
+        return false;
+    pos = offset + bytes;
+    return true;
+}
+
+bool writePack(const char* path, const std::vector<std::string>& files, bool force)
+{
+    if (!force && packIsUpToDate(path, files))
+    {
+        std::cout << path << " is up to date\n";
+        return true;
+    }
+
+    // Same key twice (e.g. a texture shared by two models) is only stored once
+    std::vector<PackMember> members;
+    for (const std::string& file : files)
+    {
+        std::string key = normalizePackPath(file);
+        bool seen = false;
+        for (const PackMember& m : members)
+            seen = seen || m.key == key;
+        if (seen)
+            continue;
+
+        PackMember m;
+        m.source = file;
+        m.key = key;
+        if (!readWholeFile(file.c_str(), m.bytes))
+        {
+            std::cerr << "Can't read " << file << " for " << path << "\n";
+            return false;
+        }
+        members.push_back(std::move(m));
+    }
+
+    std::sort(members.begin(), members.end(), [](const PackMember& a, const PackMember& b)
+        {
+            return hashPackPath(a.key) < hashPackPath(b.key);
+        });
+
+    std::vector<std::string> keys;
+    for (const PackMember& m : members)
+        keys.push_back(m.key);
+
+    PackHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, PACK_FORMAT_MAGIC, sizeof(hdr.magic));
+    hdr.version = PACK_FORMAT_VERSION;
+    hdr.entryCount = (uint32_t)members.size();
+    hdr.memberHash = hashPackMembers(keys);
+    hdr.entryOffset = alignPackOffset(sizeof(PackHeader));
+    hdr.stringOffset = alignPackOffset(hdr.entryOffset + members.size() * sizeof(PackEntry));
+
+    std::string strings;
+    for (PackMember& m : members)
+    {
+        memset(&m.entry, 0, sizeof(m.entry));
+        m.entry.pathHash = hashPackPath(m.key);
+        m.entry.pathOffset = (uint32_t)strings.size();
+        m.entry.pathLength = (uint32_t)m.key.size();
+        m.entry.size = m.bytes.size();
+        strings += m.key;
+    }
+
+    uint64_t offset = alignPackOffset(hdr.stringOffset + strings.size());
+    for (PackMember& m : members)
+    {
+        m.entry.offset = offset;
+        offset = alignPackOffset(offset + m.bytes.size());
+    }
+    hdr.fileSize = offset;
+
+    // Write to a temp file and rename, so a failed build never leaves a truncated pack behind
+    std::string tmpPath = std::string(path) + ".tmp";
+    FILE* f = fopen(tmpPath.c_str(), "wb");
+    if (!f)
+    {
+        std::cerr << "Can't write " << tmpPath << "\n";
+        return false;
+    }
+
+    uint64_t pos = 0;
+    bool ok = writeAt(f, pos, 0, &hdr, sizeof(hdr));
+    for (size_t i = 0; ok && i < members.size(); ++i)
+        ok = writeAt(f, pos, hdr.entryOffset + i * sizeof(PackEntry), &members[i].entry, sizeof(PackEntry));
+    ok = ok && writeAt(f, pos, hdr.stringOffset, strings.data(), strings.size());
+    for (size_t i = 0; ok && i < members.size(); ++i)
+        ok = writeAt(f, pos, members[i].entry.offset, members[i].bytes.data(), members[i].bytes.size());
+    ok = ok && writeZeros(f, hdr.fileSize - pos);
+    ok = (fclose(f) == 0) && ok;
+
+    if (ok)
+    {
+        remove(path);
+        ok = rename(tmpPath.c_str(), path) == 0;
+    }
+    if (!ok)
+    {
+        remove(tmpPath.c_str());
+        std::cerr << "Failed writing " << path << "\n";
+        return false;
+    }
+
+    std::cout << "Packed " << members.size() << " files into " << path << " (" << hdr.fileSize / 1024 << " KB)\n";
+    return true;
+}
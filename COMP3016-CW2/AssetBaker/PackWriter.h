@@ -0,0 +1,10 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Writes the given files into one asset pack (see PackFormat.h)
+// Each file is keyed by its path as given, normalized, which is what the
+// runtime asks for. Skipped when the pack holds the same member list and is
+// newer than every member.
+bool writePack(const char* path, const std::vector<std::string>& files, bool force);
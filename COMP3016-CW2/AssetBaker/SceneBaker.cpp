@@ -0,0 +1,332 @@
+#include "SceneBaker.h"
+#include "SceneFormat.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Spawn circle rejection: a point inside it is redrawn at most this many times
+static const int SCATTER_RETRIES = 6;
+
+struct SceneSource
+{
+    SceneHeader header;
+    std::vector<SceneProp> props;
+    std::vector<float> renderScales;                // by prop
+    std::vector<std::vector<SceneInstance>> instances;
+    std::vector<SceneScatter> scatters;
+};
+
+static int findProp(const SceneSource& scene, const std::string& name)
+{
+    for (size_t i = 0; i < scene.props.size(); ++i)
+        if (name == scene.props[i].name)
+            return (int)i;
+    return -1;
+}
+
+static bool copyName(char* dst, size_t capacity, const std::string& src)
+{
+    if (src.empty() || src.size() >= capacity)
+        return false;
+    memset(dst, 0, capacity);
+    memcpy(dst, src.c_str(), src.size());
+    return true;
+}
+
+// Each poisson layer gets its own seed, or layers baked under one seed line would
+// pick the same random numbers in every tile and cell and come out correlated
+static uint32_t layerSeed(uint32_t seed, uint32_t layer)
+{
+    uint32_t h = seed ^ (layer + 1u) * 0x9E3779B9u;
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+    return h;
+}
+
+// Same placement the game used to do at startup: x, z (redrawn near the spawn), rotation, scale
+static void scatterProp(SceneSource& scene, std::mt19937& rng, int prop, int count, float minScale, float maxScale)
+{
+    const SceneHeader& hdr = scene.header;
+    float limit = hdr.terrainSize * hdr.terrainSpacing * 0.5f - 2.0f;
+    std::uniform_real_distribution<float> distXZ(-limit, limit);
+    std::uniform_real_distribution<float> distRot(0.0f, 6.2831853f);
+    std::uniform_real_distribution<float> distScale(minScale, maxScale);
+
+    auto farFromSpawn = [&](float x, float z)
+        {
+            float dx = x - hdr.spawn[0];
+            float dz = z - hdr.spawn[1];
+            return sqrtf(dx * dx + dz * dz) > hdr.spawnClearRadius;
+        };
+
+    std::vector<SceneInstance>& out = scene.instances[prop];
+    out.reserve(out.size() + (size_t)count);
+    for (int i = 0; i < count; ++i)
+    {
+        float x = distXZ(rng);
+        float z = distXZ(rng);
+        for (int r = 0; r < SCATTER_RETRIES && !farFromSpawn(x, z); ++r)
+        {
+            x = distXZ(rng);
+            z = distXZ(rng);
+        }
+
+        SceneInstance inst;
+        inst.position[0] = x;
+        inst.position[1] = 0.0f;
+        inst.position[2] = z;
+        inst.rotY = distRot(rng);
+        inst.scale = scene.renderScales[prop] * distScale(rng);
+        out.push_back(inst);
+    }
+}
+
+static bool parseScene(const char* path, SceneSource& scene)
+{
+    std::ifstream in(path);
+    if (!in)
+    {
+        std::cerr << "Can't read " << path << "\n";
+        return false;
+    }
+
+    // Defaults match the original hard-coded scene
+    SceneHeader& hdr = scene.header;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.terrainSize = 100;
+    hdr.terrainSpacing = 1.0f;
+    hdr.heightScale = 1.5f;
+    std::mt19937 rng(0u);
+    unsigned seed = 0;
+
+    std::string line;
+    int lineNo = 0;
+    int errors = 0;
+    while (std::getline(in, line))
+    {
+        ++lineNo;
+        size_t hash = line.find('#');
+        if (hash != std::string::npos)
+            line.erase(hash);
+
+        std::istringstream args(line);
+        std::string cmd;
+        if (!(args >> cmd))
+            continue;
+
+        bool ok = true;
+        const char* problem = "bad arguments";
+        if (cmd == "terrain")
+        {
+            ok = (args >> hdr.terrainSize >> hdr.terrainSpacing >> hdr.heightScale) &&
+                hdr.terrainSize > 0 && hdr.terrainSpacing > 0.0f;
+        }
+        else if (cmd == "spawn")
+        {
+            ok = (bool)(args >> hdr.spawn[0] >> hdr.spawn[1] >> hdr.spawnClearRadius);
+        }
+        else if (cmd == "seed")
+        {
+            ok = (bool)(args >> seed);
+            rng.seed(seed);
+        }
+        else if (cmd == "prop")
+        {
+            std::string name, mesh;
+            float renderScale = 1.0f;
+            SceneProp prop;
+            memset(&prop, 0, sizeof(prop));
+            ok = (args >> name >> mesh >> renderScale >> prop.collisionRadius) && renderScale > 0.0f;
+            if (ok && findProp(scene, name) >= 0)
+            {
+                ok = false;
+                problem = "prop already defined";
+            }
+            else if (ok && (!copyName(prop.name, SCENE_NAME_MAX, name) || !copyName(prop.meshPath, SCENE_PATH_MAX, mesh)))
+            {
+                ok = false;
+                problem = "name or mesh path too long";
+            }
+            if (ok)
+            {
+                scene.props.push_back(prop);
+                scene.renderScales.push_back(renderScale);
+                scene.instances.emplace_back();
+            }
+        }
+        else if (cmd == "poisson")
+        {
+            std::string name;
+            SceneScatter layer;
+            memset(&layer, 0, sizeof(layer));
+            layer.minHeight = -FLT_MAX;
+            layer.maxHeight = FLT_MAX;
+            ok = (args >> name >> layer.radius >> layer.density >> layer.minScale >> layer.maxScale) &&
+                layer.radius > 0.0f && layer.density > 0.0f && layer.density <= 1.0f && layer.minScale <= layer.maxScale;
+
+            // Optional masks
+            std::string option;
+            while (ok && (args >> option))
+            {
+                if (option == "slope")
+                    ok = (args >> layer.maxSlope) && layer.maxSlope > 0.0f;
+                else if (option == "height")
+                    ok = (args >> layer.minHeight >> layer.maxHeight) && layer.minHeight <= layer.maxHeight;
+                else
+                    ok = false;
+            }
+
+            int prop = ok ? findProp(scene, name) : -1;
+            if (ok && prop < 0)
+            {
+                ok = false;
+                problem = "unknown prop";
+            }
+            if (ok)
+            {
+                layer.prop = (uint32_t)prop;
+                layer.seed = layerSeed(seed, (uint32_t)scene.scatters.size());
+                layer.minScale *= scene.renderScales[prop];
+                layer.maxScale *= scene.renderScales[prop];
+                scene.scatters.push_back(layer);
+            }
+        }
+        else if (cmd == "scatter" || cmd == "instance")
+        {
+            std::string name;
+            ok = (bool)(args >> name);
+            int prop = ok ? findProp(scene, name) : -1;
+            if (ok && prop < 0)
+            {
+                ok = false;
+                problem = "unknown prop";
+            }
+            else if (ok && cmd == "scatter")
+            {
+                int count = 0;
+                float minScale = 1.0f, maxScale = 1.0f;
+                ok = (args >> count >> minScale >> maxScale) && count >= 0 && minScale <= maxScale;
+                if (ok)
+                    scatterProp(scene, rng, prop, count, minScale, maxScale);
+            }
+            else if (ok)
+            {
+                SceneInstance inst;
+                float degrees = 0.0f;
+                ok = (bool)(args >> inst.position[0] >> inst.position[1] >> inst.position[2] >> degrees >> inst.scale);
+                inst.rotY = degrees * 0.017453293f;
+                inst.scale *= scene.renderScales[prop];
+                if (ok)
+                    scene.instances[prop].push_back(inst);
+            }
+        }
+        else
+        {
+            ok = false;
+            problem = "unknown directive";
+        }
+
+        std::string extra;
+        if (ok && (args >> extra))
+        {
+            ok = false;
+            problem = "trailing arguments";
+        }
+        if (!ok)
+        {
+            std::cerr << path << "(" << lineNo << "): " << problem << ": " << cmd << "\n";
+            ++errors;
+        }
+    }
+    return errors == 0;
+}
+
+static bool writePadded(FILE* f, const void* data, size_t bytes, uint64_t& offset)
+{
+    static const unsigned char zeros[SCENE_FORMAT_ALIGN] = {};
+
+    if (bytes > 0 && fwrite(data, 1, bytes, f) != bytes)
+        return false;
+    offset += bytes;
+
+    size_t pad = (size_t)(alignSceneOffset(offset) - offset);
+    if (pad > 0 && fwrite(zeros, 1, pad, f) != pad)
+        return false;
+    offset += pad;
+    return true;
+}
+
+bool bakeScene(const char* input, const char* output)
+{
+    SceneSource scene;
+    if (!parseScene(input, scene))
+        return false;
+
+    // Each prop's instances become one contiguous range of the instance block
+    SceneHeader& hdr = scene.header;
+    memcpy(hdr.magic, SCENE_FORMAT_MAGIC, sizeof(hdr.magic));
+    hdr.version = SCENE_FORMAT_VERSION;
+    hdr.propCount = (uint32_t)scene.props.size();
+    hdr.scatterCount = (uint32_t)scene.scatters.size();
+    for (size_t i = 0; i < scene.props.size(); ++i)
+    {
+        scene.props[i].firstInstance = hdr.instanceCount;
+        scene.props[i].instanceCount = scene.instances[i].size();
+        hdr.instanceCount += scene.instances[i].size();
+    }
+    hdr.propOffset = alignSceneOffset(sizeof(SceneHeader));
+    hdr.scatterOffset = alignSceneOffset(hdr.propOffset + scene.props.size() * sizeof(SceneProp));
+    hdr.instanceOffset = alignSceneOffset(hdr.scatterOffset + scene.scatters.size() * sizeof(SceneScatter));
+    hdr.fileSize = alignSceneOffset(hdr.instanceOffset + hdr.instanceCount * sizeof(SceneInstance));
+
+    // Write to a temp file and rename, so a failed bake never leaves a truncated .scene behind
+    std::string tmpPath = std::string(output) + ".tmp";
+    FILE* f = fopen(tmpPath.c_str(), "wb");
+    if (!f)
+    {
+        std::cerr << "Can't write " << tmpPath << "\n";
+        return false;
+    }
+
+    // Instances go out unpadded back to back; only the end of the block is aligned
+    uint64_t offset = 0;
+    bool ok = writePadded(f, &hdr, sizeof(hdr), offset) &&
+        writePadded(f, scene.props.data(), scene.props.size() * sizeof(SceneProp), offset) &&
+        writePadded(f, scene.scatters.data(), scene.scatters.size() * sizeof(SceneScatter), offset);
+    for (size_t i = 0; ok && i < scene.instances.size(); ++i)
+    {
+        size_t bytes = scene.instances[i].size() * sizeof(SceneInstance);
+        ok = bytes == 0 || fwrite(scene.instances[i].data(), 1, bytes, f) == bytes;
+        offset += bytes;
+    }
+    ok = ok && writePadded(f, nullptr, 0, offset);
+    ok = (fclose(f) == 0) && ok && offset == hdr.fileSize;
+
+    if (ok)
+    {
+        remove(output);
+        ok = rename(tmpPath.c_str(), output) == 0;
+    }
+    if (!ok)
+    {
+        remove(tmpPath.c_str());
+        std::cerr << "Failed writing " << output << "\n";
+        return false;
+    }
+
+    std::cout << "Baked " << input << " -> " << output << ": " << scene.props.size() << " props, "
+        << hdr.instanceCount << " instances, " << scene.scatters.size() << " scatter layers, terrain " << hdr.terrainSize << "x" << hdr.terrainSize << "\n";
+    return true;
+}
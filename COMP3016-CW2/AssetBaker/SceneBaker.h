@@ -0,0 +1,22 @@
+#pragma once
+
+// Compiles a text scene (.scn) into the binary .scene the runtime maps (see SceneFormat.h)
+//
+// One directive per line, '#' starts a comment:
+//   terrain <size> <spacing> <heightScale>          quads per side, world units per quad, hill height
+//   spawn <x> <z> <clearRadius>                     player start; scatter keeps clearRadius around it
+//   seed <n>                                        generator for the scatter lines that follow
+//   prop <name> <mesh> <renderScale> <collisionRadius>
+//   scatter <prop> <count> <minScale> <maxScale>    uniform over the terrain, minus the spawn circle
+//   poisson <prop> <radius> <density> <minScale> <maxScale> [slope <max>] [height <min> <max>]
+//   instance <prop> <x> <y> <z> <rotYDegrees> <scale>
+//
+// y is the height above the terrain surface. Scales are relative to the prop's
+// renderScale. Scatter draws from one generator shared by every scatter line,
+// in file order, so a scene file always bakes to the same instances.
+// poisson lines aren't expanded here: they're stored as Poisson-disk layers (see
+// Scatter.h) seeded from the current seed mixed with the layer's index, and the
+// game generates them at load.
+// slope is the steepest ground (rise over run) and height the ground height range
+// the layer may grow on.
+bool bakeScene(const char* input, const char* output);
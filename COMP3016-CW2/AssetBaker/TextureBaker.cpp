@@ -0,0 +1,342 @@
+#include "TextureBaker.h"
+#include "BlockCompress.h"
+#include "DdsFormat.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+// Kaiser-windowed sinc, same parameters NVTT uses for its default mip filter
+static const float KAISER_WIDTH = 3.0f;
+static const float KAISER_ALPHA = 4.0f;
+
+// Matches the pow(2.2) the scene shader applies to albedo
+static const float ALBEDO_GAMMA = 2.2f;
+
+// Matches the discard threshold in the scene shader
+static const float ALPHA_TEST_CUTOFF = 0.1f;
+
+struct FloatImage
+{
+    int width = 0;
+    int height = 0;
+    std::vector<float> texels;  // RGBA
+};
+
+static float besselI0(float x)
+{
+    float sum = 1.0f;
+    float term = 1.0f;
+    float halfX = x * 0.5f;
+    for (int k = 1; k < 32; ++k)
+    {
+        term *= (halfX / k) * (halfX / k);
+        sum += term;
+        if (term < sum * 1e-8f)
+            break;
+    }
+    return sum;
+}
+
+static float sinc(float x)
+{
+    if (std::fabs(x) < 1e-5f)
+        return 1.0f;
+    float px = 3.14159265f * x;
+    return std::sin(px) / px;
+}
+
+static float kaiserWeight(float x)
+{
+    float t = x / KAISER_WIDTH;
+    if (t <= -1.0f || t >= 1.0f)
+        return 0.0f;
+    return sinc(x) * besselI0(KAISER_ALPHA * std::sqrt(1.0f - t * t)) / besselI0(KAISER_ALPHA);
+}
+
+// One axis of a separable 2:1 (or n:1 for odd sizes) reduction, x is in destination texels
+// Addressing wraps because every texture in the scene is sampled with GL_REPEAT
+static void resampleAxis(const FloatImage& src, FloatImage& dst, bool horizontal)
+{
+    int srcLen = horizontal ? src.width : src.height;
+    int dstLen = horizontal ? dst.width : dst.height;
+    int lines = horizontal ? src.height : src.width;
+    float ratio = (float)srcLen / (float)dstLen;
+    float radius = KAISER_WIDTH * ratio;
+
+    for (int d = 0; d < dstLen; ++d)
+    {
+        float center = (d + 0.5f) * ratio - 0.5f;
+        int first = (int)std::ceil(center - radius);
+        int last = (int)std::floor(center + radius);
+
+        std::vector<float> weights;
+        float total = 0.0f;
+        for (int s = first; s <= last; ++s)
+        {
+            float w = kaiserWeight((s - center) / ratio);
+            weights.push_back(w);
+            total += w;
+        }
+
+        for (int line = 0; line < lines; ++line)
+        {
+            float acc[4] = {};
+            for (int s = first; s <= last; ++s)
+            {
+                int wrapped = ((s % srcLen) + srcLen) % srcLen;
+                int sx = horizontal ? wrapped : line;
+                int sy = horizontal ? line : wrapped;
+                const float* texel = &src.texels[((size_t)sy * src.width + sx) * 4];
+                float w = weights[s - first];
+                for (int c = 0; c < 4; ++c)
+                    acc[c] += texel[c] * w;
+            }
+
+            int dx = horizontal ? d : line;
+            int dy = horizontal ? line : d;
+            float* out = &dst.texels[((size_t)dy * dst.width + dx) * 4];
+            for (int c = 0; c < 4; ++c)
+                out[c] = acc[c] / total;
+        }
+    }
+}
+
+static FloatImage downsample(const FloatImage& src)
+{
+    FloatImage tmp;
+    tmp.width = std::max(1, src.width / 2);
+    tmp.height = src.height;
+    tmp.texels.resize((size_t)tmp.width * tmp.height * 4);
+    resampleAxis(src, tmp, true);
+
+    FloatImage dst;
+    dst.width = tmp.width;
+    dst.height = std::max(1, src.height / 2);
+    dst.texels.resize((size_t)dst.width * dst.height * 4);
+    resampleAxis(tmp, dst, false);
+    return dst;
+}
+
+// Fraction of texels that survive an alpha test at the given reference
+static float alphaCoverage(const FloatImage& img, float alphaRef)
+{
+    size_t kept = 0;
+    for (size_t i = 3; i < img.texels.size(); i += 4)
+        if (img.texels[i] >= alphaRef)
+            ++kept;
+    return (float)kept / (float)(img.texels.size() / 4);
+}
+
+// Filtering blurs alpha towards its mean, so foliage thins out (or bloats) down the chain.
+// Find the reference at which this level has the wanted coverage, then scale alpha so that reference lands on the cutoff.
+static float coverageAlphaScale(const FloatImage& img, float coverage)
+{
+    float lo = 0.0f;
+    float hi = 1.0f;
+    for (int i = 0; i < 16; ++i)
+    {
+        float ref = 0.5f * (lo + hi);
+        if (alphaCoverage(img, ref) > coverage)
+            lo = ref;
+        else
+            hi = ref;
+    }
+    // hi never keeps more than the wanted coverage, and texels at or above it are exactly the ones that pass after scaling
+    return ALPHA_TEST_CUTOFF / std::max(hi, 1e-4f);
+}
+
+static void toLinear(FloatImage& img, TextureUsage usage)
+{
+    for (size_t i = 0; i < img.texels.size(); i += 4)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            float v = img.texels[i + c];
+            img.texels[i + c] = (usage == TEXTURE_NORMAL) ? v * 2.0f - 1.0f : std::pow(v, ALBEDO_GAMMA);
+        }
+    }
+}
+
+// Back to 8-bit storage encoding; normals are renormalised first since filtering shortens them
+static void toStorage(const FloatImage& img, TextureUsage usage, float alphaScale, std::vector<uint8_t>& out)
+{
+    out.resize(img.texels.size());
+    for (size_t i = 0; i < img.texels.size(); i += 4)
+    {
+        float v[4] = { img.texels[i], img.texels[i + 1], img.texels[i + 2], img.texels[i + 3] };
+        if (usage == TEXTURE_NORMAL)
+        {
+            float len = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+            for (int c = 0; c < 3; ++c)
+                v[c] = (len > 1e-6f ? v[c] / len : (c == 2 ? 1.0f : 0.0f)) * 0.5f + 0.5f;
+        }
+        else
+        {
+            for (int c = 0; c < 3; ++c)
+                v[c] = std::pow(std::max(v[c], 0.0f), 1.0f / ALBEDO_GAMMA);
+            v[3] *= alphaScale;
+        }
+
+        for (int c = 0; c < 4; ++c)
+            out[i + c] = (uint8_t)std::lround(std::max(0.0f, std::min(1.0f, v[c])) * 255.0f);
+    }
+}
+
+// Encodes one level; edge blocks of non-multiple-of-4 levels repeat the last row/column
+static void encodeLevel(const std::vector<uint8_t>& rgba, int width, int height, uint32_t fourCC, std::vector<uint8_t>& out)
+{
+    int blocksX = (width + 3) / 4;
+    int blocksY = (height + 3) / 4;
+    uint32_t blockBytes = ddsBlockBytes(fourCC);
+    size_t start = out.size();
+    out.resize(start + (size_t)blocksX * blocksY * blockBytes);
+
+    for (int by = 0; by < blocksY; ++by)
+    {
+        for (int bx = 0; bx < blocksX; ++bx)
+        {
+            uint8_t block[16 * 4];
+            for (int y = 0; y < 4; ++y)
+            {
+                for (int x = 0; x < 4; ++x)
+                {
+                    int sx = std::min(bx * 4 + x, width - 1);
+                    int sy = std::min(by * 4 + y, height - 1);
+                    memcpy(&block[(y * 4 + x) * 4], &rgba[((size_t)sy * width + sx) * 4], 4);
+                }
+            }
+
+            uint8_t* dst = &out[start + ((size_t)by * blocksX + bx) * blockBytes];
+            if (fourCC == FOURCC_BC1)
+            {
+                encodeBC1(block, dst);
+            }
+            else if (fourCC == FOURCC_BC3)
+            {
+                encodeBC3(block, dst);
+            }
+            else
+            {
+                uint8_t rg[16 * 2];
+                for (int i = 0; i < 16; ++i)
+                {
+                    rg[i * 2 + 0] = block[i * 4 + 0];
+                    rg[i * 2 + 1] = block[i * 4 + 1];
+                }
+                encodeBC5(rg, dst);
+            }
+        }
+    }
+}
+
+static bool writeDds(const char* path, int width, int height, int mipCount, uint32_t fourCC, const std::vector<uint8_t>& data)
+{
+    DdsHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.size = sizeof(DdsHeader);
+    hdr.flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE;
+    hdr.height = (uint32_t)height;
+    hdr.width = (uint32_t)width;
+    hdr.pitchOrLinearSize = ddsLevelBytes(fourCC, (uint32_t)width, (uint32_t)height);
+    hdr.mipMapCount = (uint32_t)mipCount;
+    hdr.pixelFormat.size = sizeof(DdsPixelFormat);
+    hdr.pixelFormat.flags = DDPF_FOURCC;
+    hdr.pixelFormat.fourCC = fourCC;
+    hdr.caps = DDSCAPS_TEXTURE | DDSCAPS_MIPMAP | DDSCAPS_COMPLEX;
+
+    // Same temp + rename dance as the mesh writer
+    std::string tmpPath = std::string(path) + ".tmp";
+    FILE* f = fopen(tmpPath.c_str(), "wb");
+    if (!f)
+    {
+        std::cerr << "Can't write " << tmpPath << "\n";
+        return false;
+    }
+
+    bool ok = fwrite(&DDS_MAGIC, sizeof(DDS_MAGIC), 1, f) == 1 &&
+        fwrite(&hdr, sizeof(hdr), 1, f) == 1 &&
+        fwrite(data.data(), 1, data.size(), f) == data.size();
+    ok = (fclose(f) == 0) && ok;
+
+    if (ok)
+    {
+        remove(path);
+        ok = rename(tmpPath.c_str(), path) == 0;
+    }
+    if (!ok)
+    {
+        remove(tmpPath.c_str());
+        std::cerr << "Failed writing " << path << "\n";
+    }
+    return ok;
+}
+
+bool bakeTexture(const char* input, const char* output, TextureUsage usage)
+{
+    // Same orientation the runtime used with stb_image, so UVs don't change
+    stbi_set_flip_vertically_on_load(true);
+
+    int width, height, channels;
+    unsigned char* pixels = stbi_load(input, &width, &height, &channels, 4);
+    if (!pixels)
+    {
+        std::cerr << "Failed to load texture: " << input << " (" << stbi_failure_reason() << ")\n";
+        return false;
+    }
+
+    bool hasAlpha = false;
+    FloatImage level;
+    level.width = width;
+    level.height = height;
+    level.texels.resize((size_t)width * height * 4);
+    for (size_t i = 0; i < level.texels.size(); ++i)
+    {
+        level.texels[i] = pixels[i] / 255.0f;
+        if ((i & 3) == 3 && pixels[i] != 255)
+            hasAlpha = true;
+    }
+    stbi_image_free(pixels);
+
+    uint32_t fourCC = FOURCC_BC5;
+    if (usage == TEXTURE_ALBEDO)
+        fourCC = hasAlpha ? FOURCC_BC3 : FOURCC_BC1;
+
+    // Full chain down to 1x1, each level filtered from the one above in linear space.
+    // The alpha scale only touches what's stored, so every level is filtered from unscaled alpha.
+    toLinear(level, usage);
+    bool alphaTested = usage == TEXTURE_ALBEDO && hasAlpha;
+    float baseCoverage = alphaTested ? alphaCoverage(level, ALPHA_TEST_CUTOFF) : 1.0f;
+
+    std::vector<uint8_t> data;
+    std::vector<uint8_t> storage;
+    int mipCount = 0;
+    for (;;)
+    {
+        float alphaScale = (alphaTested && mipCount > 0) ? coverageAlphaScale(level, baseCoverage) : 1.0f;
+        toStorage(level, usage, alphaScale, storage);
+        encodeLevel(storage, level.width, level.height, fourCC, data);
+        ++mipCount;
+
+        if (level.width == 1 && level.height == 1)
+            break;
+        level = downsample(level);
+    }
+
+    if (!writeDds(output, width, height, mipCount, fourCC, data))
+        return false;
+
+    // Uncompressed RGBA8 + glGenerateMipmap is what the runtime used to allocate
+    size_t rawBytes = (size_t)width * height * 4 * 4 / 3;
+    const char* format = fourCC == FOURCC_BC1 ? "BC1" : (fourCC == FOURCC_BC3 ? "BC3" : "BC5");
+    std::cout << "Baked " << input << " -> " << output << ": " << width << "x" << height
+        << " " << format << ", " << mipCount << " mips, "
+        << data.size() / 1024 << " KB (was ~" << rawBytes / 1024 << " KB as RGBA8)\n";
+    return true;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+// How a texture is sampled decides its encoding
+//   albedo: BC1, or BC3 when any texel is translucent; mips filtered in linear space, alpha rescaled per mip
+//           so alpha-tested foliage keeps the base level's coverage
+//   normal: BC5 (XY only, Z rebuilt in the shader); mips renormalised
+enum TextureUsage
+{
+    TEXTURE_ALBEDO,
+    TEXTURE_NORMAL
+};
+
+// Decodes input with stb_image, builds a Kaiser-filtered mip chain and writes a DDS
+bool bakeTexture(const char* input, const char* output, TextureUsage usage);
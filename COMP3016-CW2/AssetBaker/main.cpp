@@ -0,0 +1,496 @@
+// AssetBaker: offline conversion of source assets into the runtime's baked formats
+//
+// Models: the Assimp import + post-processing runs once at build time, each
+// submesh is reordered for the vertex cache, overdraw and vertex fetch (see
+// MeshOptimizer.h) and the result is written as a .mesh the game only has to
+// map and upload. Diffuse textures the model references are baked alongside it.
+// Textures: block-compressed DDS with a precomputed mip chain (see TextureBaker.h).
+// Scenes: text .scn layouts compiled to the binary .scene (see SceneBaker.h).
+//
+// Pack: everything the runtime loads from this run's outputs, bundled into one
+// file it maps at startup (see PackFormat.h).
+//
+// usage: AssetBaker [--force] [--normal] <input> <output> [<input> <output> ...]
+//                   [--pack <pack> [--include <file> ...]]
+// .obj inputs are baked as models, .scn inputs as scenes, anything else as an
+// albedo texture, or as a normal map when --normal precedes the pair. Outputs newer than their inputs
+// are skipped unless --force is given. --pack collects the outputs, the textures
+// the models reference and any --include files (e.g. audio) into <pack>.
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <cfloat>
+#include <algorithm>
+
+#include <sys/stat.h>
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
+#include "MeshFormat.h"
+#include "TextureBaker.h"
+#include "DdsFormat.h"
+#include "PackWriter.h"
+#include "MeshOptimizer.h"
+#include "SceneBaker.h"
+
+// Baked data before it's written out
+struct BakedModel
+{
+    std::vector<BakedVertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<BakedSubmesh> submeshes;
+    std::vector<BakedMaterial> materials;
+    float boundsMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+    float boundsMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+};
+
+static bool isUpToDate(const char* input, const char* output)
+{
+    struct stat in, out;
+    if (stat(input, &in) != 0 || stat(output, &out) != 0)
+        return false;
+    return out.st_mtime >= in.st_mtime;
+}
+
+static std::string getDirectory(const std::string& filepath)
+{
+    size_t slash = filepath.find_last_of("/\\");
+    if (slash == std::string::npos) return ".";
+    return filepath.substr(0, slash);
+}
+
+static bool hasExtension(const char* path, const char* ext)
+{
+    size_t len = strlen(path);
+    size_t extLen = strlen(ext);
+    if (len < extLen) return false;
+    for (size_t i = 0; i < extLen; ++i)
+    {
+        char c = path[len - extLen + i];
+        if (c >= 'A' && c <= 'Z') c = (char)(c - 'A' + 'a');
+        if (c != ext[i]) return false;
+    }
+    return true;
+}
+
+static bool bakeTextureIfStale(const std::string& input, const std::string& output, TextureUsage usage, bool force)
+{
+    if (!force && isUpToDate(input.c_str(), output.c_str()))
+    {
+        std::cout << output << " is up to date\n";
+        return true;
+    }
+    return bakeTexture(input.c_str(), output.c_str(), usage);
+}
+
+static void growBounds(float* bmin, float* bmax, const float* p)
+{
+    for (int k = 0; k < 3; ++k)
+    {
+        bmin[k] = std::min(bmin[k], p[k]);
+        bmax[k] = std::max(bmax[k], p[k]);
+    }
+}
+
+static bool importModel(const char* path, BakedModel& out)
+{
+    // Same import pipeline the runtime used to run on every launch, minus
+    // ImproveCacheLocality: optimizeModel does the triangle ordering now
+    Assimp::Importer importer;
+    const aiScene* scene = importer.ReadFile(
+        path,
+        aiProcess_Triangulate |
+        aiProcess_GenSmoothNormals |
+        aiProcess_JoinIdenticalVertices |
+        aiProcess_OptimizeMeshes |
+        aiProcess_FlipUVs
+    );
+
+    if (!scene || !scene->mRootNode || scene->mNumMeshes == 0)
+    {
+        std::cerr << "ASSIMP failed to load model: " << path
+            << " (" << importer.GetErrorString() << ")\n";
+        return false;
+    }
+
+    // Materials
+    for (unsigned int i = 0; i < scene->mNumMaterials; ++i)
+    {
+        const aiMaterial* mat = scene->mMaterials[i];
+
+        BakedMaterial bm;
+        memset(&bm, 0, sizeof(bm));
+        bm.diffuseColor[0] = bm.diffuseColor[1] = bm.diffuseColor[2] = bm.diffuseColor[3] = 1.0f;
+
+        aiColor4D color;
+        if (aiGetMaterialColor(mat, AI_MATKEY_COLOR_DIFFUSE, &color) == AI_SUCCESS)
+        {
+            bm.diffuseColor[0] = color.r;
+            bm.diffuseColor[1] = color.g;
+            bm.diffuseColor[2] = color.b;
+            bm.diffuseColor[3] = color.a;
+        }
+
+        aiString texPath;
+        if (mat->GetTextureCount(aiTextureType_DIFFUSE) > 0 &&
+            mat->GetTexture(aiTextureType_DIFFUSE, 0, &texPath) == AI_SUCCESS)
+        {
+            if (texPath.length >= MESH_MATERIAL_PATH_MAX)
+            {
+                std::cerr << "Texture path too long in " << path << ": " << texPath.C_Str() << "\n";
+                return false;
+            }
+            memcpy(bm.diffusePath, texPath.C_Str(), texPath.length);
+        }
+
+        out.materials.push_back(bm);
+    }
+
+    // All submeshes share one vertex/index blob, indices are rebased as they're appended
+    size_t totalVertices = 0;
+    size_t totalIndices = 0;
+    for (unsigned int m = 0; m < scene->mNumMeshes; ++m)
+    {
+        totalVertices += scene->mMeshes[m]->mNumVertices;
+        totalIndices += (size_t)scene->mMeshes[m]->mNumFaces * 3;
+    }
+    out.vertices.reserve(totalVertices);
+    out.indices.reserve(totalIndices);
+
+    for (unsigned int m = 0; m < scene->mNumMeshes; ++m)
+    {
+        const aiMesh* aMesh = scene->mMeshes[m];
+
+        BakedSubmesh sub;
+        memset(&sub, 0, sizeof(sub));
+        sub.firstIndex = (uint32_t)out.indices.size();
+        sub.firstVertex = (uint32_t)out.vertices.size();
+        sub.vertexCount = aMesh->mNumVertices;
+        sub.materialIndex = (aMesh->mMaterialIndex < scene->mNumMaterials) ? (int32_t)aMesh->mMaterialIndex : -1;
+        for (int k = 0; k < 3; ++k)
+        {
+            sub.boundsMin[k] = FLT_MAX;
+            sub.boundsMax[k] = -FLT_MAX;
+        }
+
+        for (unsigned int i = 0; i < aMesh->mNumVertices; ++i)
+        {
+            const aiVector3D& pos = aMesh->mVertices[i];
+
+            aiVector3D norm(0, 1, 0);
+            if (aMesh->HasNormals()) norm = aMesh->mNormals[i];
+
+            aiVector3D uv(0, 0, 0);
+            if (aMesh->HasTextureCoords(0)) uv = aMesh->mTextureCoords[0][i];
+
+            BakedVertex v;
+            v.position[0] = pos.x; v.position[1] = pos.y; v.position[2] = pos.z;
+            v.normal[0] = norm.x;  v.normal[1] = norm.y;  v.normal[2] = norm.z;
+            v.uv[0] = uv.x;        v.uv[1] = uv.y;
+            out.vertices.push_back(v);
+
+            growBounds(sub.boundsMin, sub.boundsMax, v.position);
+        }
+
+        for (unsigned int f = 0; f < aMesh->mNumFaces; ++f)
+        {
+            const aiFace& face = aMesh->mFaces[f];
+            if (face.mNumIndices != 3) continue;
+            out.indices.push_back(sub.firstVertex + face.mIndices[0]);
+            out.indices.push_back(sub.firstVertex + face.mIndices[1]);
+            out.indices.push_back(sub.firstVertex + face.mIndices[2]);
+        }
+
+        sub.indexCount = (uint32_t)out.indices.size() - sub.firstIndex;
+        if (sub.indexCount == 0)
+            continue;
+
+        growBounds(out.boundsMin, out.boundsMax, sub.boundsMin);
+        growBounds(out.boundsMin, out.boundsMax, sub.boundsMax);
+        out.submeshes.push_back(sub);
+    }
+
+    if (out.submeshes.empty())
+    {
+        std::cerr << "No triangles in " << path << "\n";
+        return false;
+    }
+    return true;
+}
+
+// Optimizes every submesh in place, before/after accumulate the cache stats over the whole model
+static void optimizeModel(BakedModel& model, VertexCacheStats& before, VertexCacheStats& after)
+{
+    std::vector<uint32_t> local;
+    for (const BakedSubmesh& sub : model.submeshes)
+    {
+        uint32_t* indices = model.indices.data() + sub.firstIndex;
+        BakedVertex* vertices = model.vertices.data() + sub.firstVertex;
+
+        // The optimizer works on submesh-local indices
+        local.assign(indices, indices + sub.indexCount);
+        for (uint32_t& i : local)
+            i -= sub.firstVertex;
+
+        VertexCacheStats b = simulateVertexCache(local.data(), local.size(), sub.vertexCount, VERTEX_CACHE_SIZE);
+        optimizeSubmesh(local.data(), local.size(), vertices, sub.vertexCount);
+        VertexCacheStats a = simulateVertexCache(local.data(), local.size(), sub.vertexCount, VERTEX_CACHE_SIZE);
+
+        before.misses += b.misses; before.triangles += b.triangles; before.vertices += b.vertices;
+        after.misses += a.misses; after.triangles += a.triangles; after.vertices += a.vertices;
+
+        for (size_t i = 0; i < local.size(); ++i)
+            indices[i] = local[i] + sub.firstVertex;
+    }
+}
+
+static bool writePadded(FILE* f, const void* data, size_t bytes, uint64_t& offset)
+{
+    static const unsigned char zeros[MESH_FORMAT_ALIGN] = {};
+
+    if (bytes > 0 && fwrite(data, 1, bytes, f) != bytes)
+        return false;
+    offset += bytes;
+
+    size_t pad = (size_t)(alignMeshOffset(offset) - offset);
+    if (pad > 0 && fwrite(zeros, 1, pad, f) != pad)
+        return false;
+    offset += pad;
+    return true;
+}
+
+static bool writeModel(const char* path, const BakedModel& model)
+{
+    BakedMeshHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, MESH_FORMAT_MAGIC, sizeof(hdr.magic));
+    hdr.version = MESH_FORMAT_VERSION;
+    hdr.vertexStride = sizeof(BakedVertex);
+    hdr.vertexCount = (uint32_t)model.vertices.size();
+    hdr.indexCount = (uint32_t)model.indices.size();
+    hdr.submeshCount = (uint32_t)model.submeshes.size();
+    hdr.materialCount = (uint32_t)model.materials.size();
+    memcpy(hdr.boundsMin, model.boundsMin, sizeof(hdr.boundsMin));
+    memcpy(hdr.boundsMax, model.boundsMax, sizeof(hdr.boundsMax));
+
+    // Lay the blocks out up front so the header can be written first
+    hdr.submeshOffset = alignMeshOffset(sizeof(BakedMeshHeader));
+    hdr.materialOffset = alignMeshOffset(hdr.submeshOffset + model.submeshes.size() * sizeof(BakedSubmesh));
+    hdr.vertexOffset = alignMeshOffset(hdr.materialOffset + model.materials.size() * sizeof(BakedMaterial));
+    hdr.indexOffset = alignMeshOffset(hdr.vertexOffset + model.vertices.size() * sizeof(BakedVertex));
+    hdr.fileSize = alignMeshOffset(hdr.indexOffset + model.indices.size() * sizeof(uint32_t));
+
+    // Write to a temp file and rename, so a failed bake never leaves a truncated .mesh behind
+    std::string tmpPath = std::string(path) + ".tmp";
+    FILE* f = fopen(tmpPath.c_str(), "wb");
+    if (!f)
+    {
+        std::cerr << "Can't write " << tmpPath << "\n";
+        return false;
+    }
+
+    uint64_t offset = 0;
+    bool ok = writePadded(f, &hdr, sizeof(hdr), offset) &&
+        writePadded(f, model.submeshes.data(), model.submeshes.size() * sizeof(BakedSubmesh), offset) &&
+        writePadded(f, model.materials.data(), model.materials.size() * sizeof(BakedMaterial), offset) &&
+        writePadded(f, model.vertices.data(), model.vertices.size() * sizeof(BakedVertex), offset) &&
+        writePadded(f, model.indices.data(), model.indices.size() * sizeof(uint32_t), offset);
+    ok = (fclose(f) == 0) && ok && offset == hdr.fileSize;
+
+    if (ok)
+    {
+        remove(path);
+        ok = rename(tmpPath.c_str(), path) == 0;
+    }
+    if (!ok)
+    {
+        remove(tmpPath.c_str());
+        std::cerr << "Failed writing " << path << "\n";
+    }
+    return ok;
+}
+
+static bool fileExists(const std::string& path)
+{
+    struct stat st;
+    return stat(path.c_str(), &st) == 0;
+}
+
+// Model textures are optional at runtime (it falls back to the source image), so a missing one only warns
+// Whichever file the runtime will end up loading is added to packFiles.
+static void bakeModelTextures(const char* modelPath, const std::vector<BakedMaterial>& materials, bool force,
+    std::vector<std::string>& packFiles)
+{
+    std::string dir = getDirectory(modelPath);
+    for (const BakedMaterial& mat : materials)
+    {
+        if (mat.diffusePath[0] == '\0')
+            continue;
+
+        std::string source = dir + "/" + mat.diffusePath;
+        std::string baked = bakedTexturePath(source);
+        if (bakeTextureIfStale(source, baked, TEXTURE_ALBEDO, force))
+        {
+            packFiles.push_back(baked);
+            continue;
+        }
+
+        std::cerr << "Warning: " << modelPath << " references " << mat.diffusePath << " which could not be baked\n";
+        if (fileExists(source))
+            packFiles.push_back(source);
+    }
+}
+
+// Material table of an already baked model, so its textures can be checked without re-importing
+static bool readBakedMaterials(const char* path, std::vector<BakedMaterial>& materials)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f)
+        return false;
+
+    BakedMeshHeader hdr;
+    bool ok = fread(&hdr, sizeof(hdr), 1, f) == 1 &&
+        memcmp(hdr.magic, MESH_FORMAT_MAGIC, sizeof(hdr.magic)) == 0 &&
+        hdr.version == MESH_FORMAT_VERSION &&
+        hdr.materialCount < 4096;
+    if (ok)
+    {
+        materials.resize(hdr.materialCount);
+        ok = fseek(f, (long)hdr.materialOffset, SEEK_SET) == 0 &&
+            fread(materials.data(), sizeof(BakedMaterial), materials.size(), f) == materials.size();
+    }
+    fclose(f);
+    return ok;
+}
+
+struct BakeJob
+{
+    const char* input;
+    const char* output;
+    TextureUsage usage;
+};
+
+int main(int argc, char** argv)
+{
+    bool force = false;
+    bool nextIsNormal = false;
+    const char* packPath = nullptr;
+    std::vector<std::string> packFiles;
+    std::vector<const char*> pending;
+    std::vector<BakeJob> jobs;
+    bool badArgs = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--force") == 0)
+        {
+            force = true;
+            continue;
+        }
+        if (strcmp(argv[i], "--pack") == 0 || strcmp(argv[i], "--include") == 0)
+        {
+            if (i + 1 >= argc)
+            {
+                badArgs = true;
+                break;
+            }
+            if (argv[i][2] == 'p') packPath = argv[++i];
+            else packFiles.push_back(argv[++i]);
+            continue;
+        }
+        if (strcmp(argv[i], "--normal") == 0)
+        {
+            nextIsNormal = true;
+            continue;
+        }
+
+        pending.push_back(argv[i]);
+        if (pending.size() == 2)
+        {
+            jobs.push_back({ pending[0], pending[1], nextIsNormal ? TEXTURE_NORMAL : TEXTURE_ALBEDO });
+            pending.clear();
+            nextIsNormal = false;
+        }
+    }
+
+    if (badArgs || jobs.empty() || !pending.empty() || (!packPath && !packFiles.empty()))
+    {
+        std::cerr << "usage: AssetBaker [--force] [--normal] <input> <output> [<input> <output> ...]\n"
+            "                   [--pack <pack> [--include <file> ...]]\n";
+        return 2;
+    }
+
+    int failures = 0;
+    for (const BakeJob& job : jobs)
+    {
+        if (hasExtension(job.input, ".scn"))
+        {
+            if (!force && isUpToDate(job.input, job.output))
+                std::cout << job.output << " is up to date\n";
+            else if (!bakeScene(job.input, job.output))
+            {
+                ++failures;
+                continue;
+            }
+            packFiles.push_back(job.output);
+            continue;
+        }
+
+        if (!hasExtension(job.input, ".obj"))
+        {
+            if (!bakeTextureIfStale(job.input, job.output, job.usage, force))
+                ++failures;
+            else
+                packFiles.push_back(job.output);
+            continue;
+        }
+
+        std::vector<BakedMaterial> bakedMaterials;
+        if (!force && isUpToDate(job.input, job.output) && readBakedMaterials(job.output, bakedMaterials))
+        {
+            std::cout << job.output << " is up to date\n";
+            packFiles.push_back(job.output);
+            bakeModelTextures(job.input, bakedMaterials, force, packFiles);
+            continue;
+        }
+
+        BakedModel model;
+        VertexCacheStats cacheBefore;
+        VertexCacheStats cacheAfter;
+        if (!importModel(job.input, model))
+        {
+            ++failures;
+            continue;
+        }
+
+        optimizeModel(model, cacheBefore, cacheAfter);
+        if (!writeModel(job.output, model))
+        {
+            ++failures;
+            continue;
+        }
+
+        std::cout << "Baked " << job.input << " -> " << job.output << ": "
+            << model.vertices.size() << " verts, "
+            << model.indices.size() / 3 << " tris, "
+            << model.submeshes.size() << " submeshes, "
+            << model.materials.size() << " materials\n"
+            << "  vertex cache (" << VERTEX_CACHE_SIZE << " entries): ACMR " << std::fixed << std::setprecision(3)
+            << cacheBefore.acmr() << " -> " << cacheAfter.acmr() << ", ATVR "
+            << cacheBefore.atvr() << " -> " << cacheAfter.atvr() << "\n" << std::defaultfloat << std::setprecision(6);
+
+        packFiles.push_back(job.output);
+        bakeModelTextures(job.input, model.materials, force, packFiles);
+    }
+
+    // A pack missing something would silently fall back to loose files, so only build it from a clean bake
+    if (packPath && failures == 0 && !writePack(packPath, packFiles, force))
+        ++failures;
+
+    return failures == 0 ? 0 : 1;
+}
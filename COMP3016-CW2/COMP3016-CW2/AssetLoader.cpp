@@ -0,0 +1,328 @@
+#include "AssetLoader.h"
+#include "StartupTrace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+static double nowMs()
+{
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+static void decodeAsset(AssetLoader& loader, AssetSlot& slot)
+{
+    TRACE_SCOPE(slot.path.c_str(), "decode");
+    double start = nowMs();
+    bool ok = false;
+
+    if (slot.kind == ASSET_TEXTURE)
+    {
+        ok = loadTextureData(slot.textureData, slot.path.c_str());
+        if (ok && loader.streamer)
+            slot.textureData.firstLevel = mipStreamFirstLevel(slot.textureData);
+    }
+    else
+    {
+        ok = loadModelData(slot.modelData, slot.path);
+        if (ok)
+        {
+            // Kick the textures off now rather than after the model is uploaded
+            uint32_t submeshCount = slot.modelData.header->submeshCount;
+            slot.meshTextures.assign(submeshCount, INVALID_TEXTURE);
+            for (uint32_t i = 0; i < submeshCount; ++i)
+            {
+                std::string texPath = submeshTexturePath(slot.modelData, i);
+                if (!texPath.empty())
+                    slot.meshTextures[i] = requestTexture(loader, texPath, nullptr);
+            }
+        }
+    }
+
+    // Best effort: a full ring just means this one uploads from client memory
+    if (ok && loader.staging)
+    {
+        if (slot.kind == ASSET_TEXTURE) stageTextureData(slot.textureData, *loader.staging);
+        else stageModelData(slot.modelData, *loader.staging);
+    }
+
+    slot.decodeMs = nowMs() - start;
+    slot.state.store(ok ? ASSET_DECODED : ASSET_FAILED, std::memory_order_release);
+}
+
+static void decodeJob(void* data, int index)
+{
+    AssetLoader& loader = *(AssetLoader*)data;
+    AssetSlot& slot = loader.slots[index];
+
+    // Shutting down: fail it without touching the disk
+    if (loader.quit.load())
+        slot.state.store(ASSET_FAILED, std::memory_order_release);
+    else
+        decodeAsset(loader, slot);
+
+    // The decoded ring is as large as the slot table, so this only spins if something is badly wrong
+    while (!loader.decoded.tryPush(index))
+        std::this_thread::yield();
+}
+
+void initAssetLoader(AssetLoader& loader, TextureRegistry& textures, UploadRing* staging, TextureStreamer* streamer, JobSystem& jobs)
+{
+    loader.textures = &textures;
+    loader.staging = (staging && uploadRingEnabled(*staging)) ? staging : nullptr;
+    loader.streamer = streamer;
+    loader.jobs = &jobs;
+}
+
+static AssetHandle enqueueAsset(AssetLoader& loader, AssetKind kind, const std::string& path,
+    TextureHandle textureEntry, const SamplerDesc& sampler, Model* modelTarget)
+{
+    int index = loader.slotCount.fetch_add(1);
+    if (index >= AssetLoader::MAX_ASSETS)
+    {
+        loader.slotCount.fetch_sub(1);
+        std::cerr << "Asset loader is full, dropping " << path << "\n";
+        return INVALID_ASSET;
+    }
+
+    AssetSlot& slot = loader.slots[index];
+    slot.kind = kind;
+    slot.path = path;
+    slot.textureEntry = textureEntry;
+    slot.sampler = sampler;
+    slot.modelTarget = modelTarget;
+    slot.requestMs = nowMs();
+    slot.state.store(ASSET_PENDING, std::memory_order_relaxed);
+
+    loader.outstanding.fetch_add(1);
+    submitJob(*loader.jobs, decodeJob, &loader, index, &loader.decodes, nullptr, JOB_BACKGROUND);
+    return index;
+}
+
+// GL thread: fill target now if the texture is already there (0 if it failed), otherwise once it lands
+static void bindWhenLoaded(AssetLoader& loader, TextureHandle texture, GLuint* target)
+{
+    if (textureLoaded(*loader.textures, texture))
+        *target = textureId(*loader.textures, texture);
+    else
+        loader.waiters.push_back({ target, texture });
+}
+
+TextureHandle requestTexture(AssetLoader& loader, const std::string& path, GLuint* target, const SamplerDesc& sampler)
+{
+    bool isNew = false;
+    TextureHandle texture = acquireTexture(*loader.textures, path, sampler, isNew);
+    if (texture == INVALID_TEXTURE)
+        return INVALID_TEXTURE;
+
+    // Only the first request decodes, everyone else shares its upload. One that can't be queued
+    // is failed on the GL thread (this may be a decode job), and its waiters resolved there.
+    if (isNew && enqueueAsset(loader, ASSET_TEXTURE, path, texture, sampler, nullptr) == INVALID_ASSET)
+    {
+        loader.outstanding.fetch_add(1);
+        while (!loader.dropped.tryPush(texture))
+            std::this_thread::yield();
+    }
+
+    if (target)
+        bindWhenLoaded(loader, texture, target);
+    return texture;
+}
+
+AssetHandle requestModel(AssetLoader& loader, const std::string& path, Model* target)
+{
+    return enqueueAsset(loader, ASSET_MODEL, path, INVALID_TEXTURE, SamplerDesc(), target);
+}
+
+static void resolveWaiters(AssetLoader& loader, TextureHandle texture)
+{
+    GLuint id = textureId(*loader.textures, texture);
+    for (size_t i = 0; i < loader.waiters.size();)
+    {
+        TextureWaiter& w = loader.waiters[i];
+        if (w.texture != texture)
+        {
+            ++i;
+            continue;
+        }
+
+        *w.target = id;
+        w = loader.waiters.back();
+        loader.waiters.pop_back();
+    }
+}
+
+// GL thread: fences the slot's staging block (once its copies are queued) and frees the CPU payload
+static void releasePayload(AssetLoader& loader, AssetSlot& slot)
+{
+    if (loader.staging)
+    {
+        stagingSubmit(*loader.staging, slot.textureData.staging);
+        stagingSubmit(*loader.staging, slot.modelData.staging);
+    }
+    freeTextureData(slot.textureData);
+    freeModelData(slot.modelData);
+}
+
+static size_t uploadAsset(AssetLoader& loader, AssetHandle handle)
+{
+    AssetSlot& slot = loader.slots[handle];
+    size_t bytes = 0;
+    TRACE_SCOPE(slot.path.c_str(), "upload");
+
+    if (slot.state.load(std::memory_order_acquire) == ASSET_FAILED)
+    {
+        releasePayload(loader, slot);
+        if (slot.kind == ASSET_TEXTURE)
+        {
+            setTextureResident(*loader.textures, slot.textureEntry, 0, 0);
+            resolveWaiters(loader, slot.textureEntry);
+        }
+        return 0;
+    }
+
+    bool ok = true;
+    if (slot.kind == ASSET_TEXTURE)
+    {
+        GLuint id = uploadTexture(slot.textureData, slot.sampler);
+        bytes = textureDataGpuBytes(slot.textureData);
+        if (slot.textureData.staging.ptr) loader.batchStaged++;
+
+        // Before the registry sees it: if nothing holds a reference any more it's freed right away
+        if (id != 0 && loader.streamer && slot.textureData.firstLevel > 0)
+            registerStreamedTexture(*loader.streamer, slot.textureEntry, id, slot.textureData);
+        releasePayload(loader, slot);
+
+        ok = id != 0;
+        setTextureResident(*loader.textures, slot.textureEntry, id, bytes);
+        resolveWaiters(loader, slot.textureEntry);
+    }
+    else
+    {
+        Model& model = *slot.modelTarget;
+        ok = uploadModel(model, slot.modelData);
+        if (ok)
+        {
+            bytes = (size_t)slot.modelData.header->vertexCount * sizeof(BakedVertex) +
+                (size_t)slot.modelData.header->indexCount * sizeof(uint32_t);
+        }
+        if (slot.modelData.staging.ptr) loader.batchStaged++;
+        releasePayload(loader, slot);
+
+        // The model's meshes take over the references the decode job acquired
+        for (size_t i = 0; i < slot.meshTextures.size(); ++i)
+        {
+            TextureHandle tex = slot.meshTextures[i];
+            if (i >= model.meshes.size())
+            {
+                releaseTexture(*loader.textures, tex);
+                continue;
+            }
+
+            model.meshes[i].diffuseHandle = tex;
+            if (tex != INVALID_TEXTURE)
+                bindWhenLoaded(loader, tex, &model.meshes[i].diffuseTex);
+        }
+    }
+
+    slot.state.store(ok ? ASSET_READY : ASSET_FAILED, std::memory_order_release);
+    return bytes;
+}
+
+int pumpAssetUploads(AssetLoader& loader, double budgetMs)
+{
+    double start = nowMs();
+    int uploaded = 0;
+
+    // Recycle staging blocks the GPU has finished copying out of
+    if (loader.staging)
+        retireStaging(*loader.staging);
+
+    TextureHandle dropped;
+    while (loader.dropped.tryPop(dropped))
+    {
+        setTextureResident(*loader.textures, dropped, 0, 0);
+        resolveWaiters(loader, dropped);
+        loader.outstanding.fetch_sub(1);
+    }
+
+    AssetHandle handle;
+    while (nowMs() - start < budgetMs && loader.decoded.tryPop(handle))
+    {
+        double uploadStart = nowMs();
+        size_t bytes = uploadAsset(loader, handle);
+
+        AssetSlot& slot = loader.slots[handle];
+        slot.uploadMs = nowMs() - uploadStart;
+        loader.batchUploadMs += slot.uploadMs;
+        if (loader.batchAssets == 0 || slot.requestMs < loader.batchStartMs)
+            loader.batchStartMs = slot.requestMs;
+        loader.batchBytes += bytes;
+        loader.batchAssets++;
+        if (loader.batchSlowest == INVALID_ASSET || slot.decodeMs > loader.slots[loader.batchSlowest].decodeMs)
+            loader.batchSlowest = handle;
+
+        loader.outstanding.fetch_sub(1);
+        uploaded++;
+    }
+
+    // Everything requested so far is resident: report how long it took versus the slowest single asset
+    if (loader.batchAssets > 0 && loader.outstanding.load() == 0)
+    {
+        const AssetSlot& slowest = loader.slots[loader.batchSlowest];
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(1) << "Assets: " << loader.batchAssets << " loaded in "
+            << nowMs() - loader.batchStartMs << " ms (" << loader.batchBytes / (1024.0 * 1024.0) << " MB, "
+            << loader.batchStaged << " staged, " << loader.batchUploadMs << " ms of uploads on the GL thread), slowest decode "
+            << slowest.path << " " << slowest.decodeMs << " ms\n";
+        std::cout << line.str();
+
+        loader.batchStartMs = 0.0;
+        loader.batchAssets = 0;
+        loader.batchStaged = 0;
+        loader.batchBytes = 0;
+        loader.batchUploadMs = 0.0;
+        loader.batchSlowest = INVALID_ASSET;
+    }
+
+    return uploaded;
+}
+
+bool assetsPending(const AssetLoader& loader)
+{
+    return loader.outstanding.load() > 0;
+}
+
+AssetState assetState(const AssetLoader& loader, AssetHandle handle)
+{
+    if (handle < 0 || handle >= loader.slotCount.load())
+        return ASSET_FAILED;
+    return (AssetState)loader.slots[handle].state.load(std::memory_order_acquire);
+}
+
+void destroyAssetLoader(AssetLoader& loader)
+{
+    loader.quit.store(true);
+    waitForCounter(*loader.jobs, loader.decodes);
+
+    // Settle anything still in flight so the registry can free it
+    AssetHandle handle;
+    while (loader.decoded.tryPop(handle))
+    {
+        AssetSlot& slot = loader.slots[handle];
+        releasePayload(loader, slot);
+        if (slot.kind == ASSET_TEXTURE)
+            setTextureResident(*loader.textures, slot.textureEntry, 0, 0);
+        for (TextureHandle tex : slot.meshTextures)
+            releaseTexture(*loader.textures, tex);
+        slot.meshTextures.clear();
+    }
+    TextureHandle dropped;
+    while (loader.dropped.tryPop(dropped))
+        setTextureResident(*loader.textures, dropped, 0, 0);
+    loader.waiters.clear();
+}
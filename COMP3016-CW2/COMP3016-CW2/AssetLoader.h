@@ -0,0 +1,123 @@
+#pragma once
+
+#define NOMINMAX
+#include <GL/glew.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "JobSystem.h"
+#include "LockFreeQueue.h"
+#include "Model.h"
+#include "Texture.h"
+#include "TextureRegistry.h"
+#include "TextureStreaming.h"
+#include "UploadRing.h"
+
+// Asynchronous asset loading
+// Background jobs on the job system do the file I/O, DDS/mesh table parsing
+// and stb_image decodes in parallel. Finished CPU payloads come back through a
+// lock-free queue and the GL thread uploads them in pumpAssetUploads, stopping
+// once the frame's time budget is spent. Textures go through the TextureRegistry,
+// so a path that is already loaded or in flight is shared instead of decoded
+// again. A model's diffuse textures are requested by its decode job as soon as
+// the model's material table has been read, and patched into its meshes as they
+// finish. With an upload ring the jobs also copy each payload into persistently
+// mapped staging memory, so the GL thread only issues GPU-side copies. With a
+// mip streamer, baked textures only get their tail mips loaded here.
+typedef int AssetHandle;
+static const AssetHandle INVALID_ASSET = -1;
+
+enum AssetKind
+{
+    ASSET_TEXTURE,
+    ASSET_MODEL
+};
+
+enum AssetState
+{
+    ASSET_PENDING,      // queued or being decoded
+    ASSET_DECODED,      // CPU payload ready, waiting for upload
+    ASSET_READY,
+    ASSET_FAILED
+};
+
+struct AssetSlot
+{
+    AssetKind kind = ASSET_TEXTURE;
+    std::string path;
+    std::atomic<int> state{ ASSET_PENDING };
+
+    // Textures: registry entry the upload is published to
+    TextureHandle textureEntry = INVALID_TEXTURE;
+    SamplerDesc sampler;
+    TextureData textureData;
+
+    // Models: written on the GL thread when the upload completes
+    Model* modelTarget = nullptr;
+    ModelData modelData;
+    std::vector<TextureHandle> meshTextures;    // one per submesh, INVALID_TEXTURE if untextured
+
+    double requestMs = 0.0;
+    double decodeMs = 0.0;
+    double uploadMs = 0.0;
+};
+
+// A GL texture name to fill in once a texture still in flight is uploaded
+struct TextureWaiter
+{
+    GLuint* target;
+    TextureHandle texture;
+};
+
+struct AssetLoader
+{
+    static const int MAX_ASSETS = 256;
+
+    TextureRegistry* textures = nullptr;
+    UploadRing* staging = nullptr;          // optional
+    TextureStreamer* streamer = nullptr;    // optional
+
+    AssetSlot slots[MAX_ASSETS];
+    std::atomic<int> slotCount{ 0 };
+    std::atomic<int> outstanding{ 0 };      // requested but not yet uploaded or failed
+
+    LockFreeQueue<AssetHandle, MAX_ASSETS> decoded;
+    LockFreeQueue<TextureHandle, TextureRegistry::MAX_TEXTURES> dropped;     // textures that never got a slot
+
+    JobSystem* jobs = nullptr;
+    JobCounter decodes;                     // decode jobs in flight
+    std::atomic<bool> quit{ false };        // remaining decodes fail fast
+
+    // GL thread only
+    std::vector<TextureWaiter> waiters;
+    double batchStartMs = 0.0;
+    int batchAssets = 0;
+    int batchStaged = 0;
+    size_t batchBytes = 0;
+    double batchUploadMs = 0.0;
+    AssetHandle batchSlowest = INVALID_ASSET;
+};
+
+// Decodes run as background jobs on jobs, which must outlive the loader
+// staging may be null (or disabled), uploads then read the decoded data from client memory
+// streamer may be null, textures are then loaded with every mip
+void initAssetLoader(AssetLoader& loader, TextureRegistry& textures, UploadRing* staging, TextureStreamer* streamer, JobSystem& jobs);
+
+// Thread-safe, returns a registry reference the caller releases with releaseTexture
+// target (GL thread callers only, may be null) receives the GL texture once it's uploaded
+TextureHandle requestTexture(AssetLoader& loader, const std::string& path, GLuint* target, const SamplerDesc& sampler = SamplerDesc());
+
+// Thread-safe. target receives the model (meshes hold texture references, see destroyModel)
+AssetHandle requestModel(AssetLoader& loader, const std::string& path, Model* target);
+
+// GL thread: uploads decoded assets until budgetMs has elapsed, returns how many were uploaded
+// Prints a summary each time the loader drains.
+int pumpAssetUploads(AssetLoader& loader, double budgetMs);
+
+bool assetsPending(const AssetLoader& loader);
+AssetState assetState(const AssetLoader& loader, AssetHandle handle);
+
+// Waits for decodes in flight and drops anything not yet uploaded (call before destroying the upload ring)
+void destroyAssetLoader(AssetLoader& loader);
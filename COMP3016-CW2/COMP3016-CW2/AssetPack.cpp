@@ -0,0 +1,178 @@
+#include "AssetPack.h"
+#include "PackFormat.h"
+
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <irrKlang.h>
+
+// Mounted pack
+static MappedFile gPackFile;
+static const PackHeader* gPackHeader = nullptr;
+static const PackEntry* gPackEntries = nullptr;
+static const char* gPackStrings = nullptr;
+
+static bool blockInPack(uint64_t offset, uint64_t count, uint64_t stride, size_t fileSize)
+{
+    return offset <= fileSize && count <= (fileSize - offset) / stride;
+}
+
+bool mountAssetPack(const char* path)
+{
+    unmountAssetPack();
+    if (!openMappedFile(gPackFile, path))
+        return false;
+
+    const PackHeader* hdr = (const PackHeader*)gPackFile.data;
+    size_t size = gPackFile.size;
+    bool ok = size >= sizeof(PackHeader) &&
+        memcmp(hdr->magic, PACK_FORMAT_MAGIC, sizeof(hdr->magic)) == 0 &&
+        hdr->version == PACK_FORMAT_VERSION &&
+        hdr->fileSize == size &&
+        blockInPack(hdr->entryOffset, hdr->entryCount, sizeof(PackEntry), size) &&
+        hdr->stringOffset <= size;
+
+    const PackEntry* entries = ok ? (const PackEntry*)(gPackFile.data + hdr->entryOffset) : nullptr;
+    for (uint32_t i = 0; ok && i < hdr->entryCount; ++i)
+    {
+        const PackEntry& e = entries[i];
+        ok = blockInPack(e.offset, e.size, 1, size) &&
+            blockInPack(hdr->stringOffset + e.pathOffset, e.pathLength, 1, size) &&
+            (i == 0 || entries[i - 1].pathHash <= e.pathHash);
+    }
+
+    if (!ok)
+    {
+        std::cerr << "Asset pack is corrupt or from another version: " << path << " (rebuild it with AssetBaker --pack)\n";
+        closeMappedFile(gPackFile);
+        return false;
+    }
+
+    gPackHeader = hdr;
+    gPackEntries = entries;
+    gPackStrings = (const char*)(gPackFile.data + hdr->stringOffset);
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(1) << "Mounted " << path << ": " << hdr->entryCount << " files, "
+        << size / (1024.0 * 1024.0) << " MB\n";
+    std::cout << line.str();
+    return true;
+}
+
+void unmountAssetPack()
+{
+    closeMappedFile(gPackFile);
+    gPackHeader = nullptr;
+    gPackEntries = nullptr;
+    gPackStrings = nullptr;
+}
+
+static const PackEntry* findPackEntry(const char* path)
+{
+    if (!gPackHeader)
+        return nullptr;
+
+    std::string key = normalizePackPath(path);
+    uint64_t hash = hashPackPath(key);
+
+    // Lower bound on the hash, then walk the (rare) run of equal hashes comparing paths
+    uint32_t lo = 0;
+    uint32_t hi = gPackHeader->entryCount;
+    while (lo < hi)
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (gPackEntries[mid].pathHash < hash) lo = mid + 1;
+        else hi = mid;
+    }
+
+    for (uint32_t i = lo; i < gPackHeader->entryCount && gPackEntries[i].pathHash == hash; ++i)
+    {
+        const PackEntry& e = gPackEntries[i];
+        if (e.pathLength == key.size() && memcmp(gPackStrings + e.pathOffset, key.data(), key.size()) == 0)
+            return &e;
+    }
+    return nullptr;
+}
+
+bool openAssetFile(MappedFile& file, const char* path)
+{
+    const PackEntry* entry = findPackEntry(path);
+    if (!entry)
+        return openMappedFile(file, path);
+
+    closeMappedFile(file);
+    if (entry->size == 0)
+        return false;
+
+    file.data = gPackFile.data + entry->offset;
+    file.size = (size_t)entry->size;
+    file.borrowed = true;
+    return true;
+}
+
+// irrKlang file access (see irrKlang's 04.OverrideFileAccess example)
+class PackFileReader : public irrklang::IFileReader
+{
+public:
+    PackFileReader(const MappedFile& file, const char* name)
+        : mFile(file), mPos(0), mName(name)
+    {
+    }
+
+    ~PackFileReader()
+    {
+        closeMappedFile(mFile);
+    }
+
+    irrklang::ik_s32 read(void* buffer, irrklang::ik_u32 sizeToRead) override
+    {
+        size_t left = mFile.size - mPos;
+        size_t count = sizeToRead < left ? sizeToRead : left;
+        memcpy(buffer, mFile.data + mPos, count);
+        mPos += count;
+        return (irrklang::ik_s32)count;
+    }
+
+    bool seek(irrklang::ik_s32 finalPos, bool relativeMovement) override
+    {
+        long long target = relativeMovement ? (long long)mPos + finalPos : (long long)finalPos;
+        if (target < 0 || target > (long long)mFile.size)
+            return false;
+        mPos = (size_t)target;
+        return true;
+    }
+
+    irrklang::ik_s32 getSize() override { return (irrklang::ik_s32)mFile.size; }
+    irrklang::ik_s32 getPos() override { return (irrklang::ik_s32)mPos; }
+    const irrklang::ik_c8* getFileName() override { return mName.c_str(); }
+
+private:
+    MappedFile mFile;
+    size_t mPos;
+    std::string mName;
+};
+
+class PackFileFactory : public irrklang::IFileFactory
+{
+public:
+    irrklang::IFileReader* createFileReader(const irrklang::ik_c8* filename) override
+    {
+        MappedFile file;
+        if (!openAssetFile(file, filename))
+            return nullptr;
+        return new PackFileReader(file, filename);
+    }
+};
+
+void installPackFileFactory(irrklang::ISoundEngine* engine)
+{
+    if (!engine)
+        return;
+
+    // The engine holds its own reference from here on
+    PackFileFactory* factory = new PackFileFactory();
+    engine->addFileFactory(factory);
+    factory->drop();
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "MappedFile.h"
+
+namespace irrklang { class ISoundEngine; }
+
+// Asset file access
+// The pack AssetBaker writes (index + aligned blobs, see PackFormat.h) is
+// mapped once at startup. Opening an asset is then a binary search of the
+// mapped index and a view into the mapping: no per-file open, seek or read.
+// Paths that aren't in the pack (or when no pack is mounted) fall back to
+// mapping the loose file, so the unpacked assets/ folder keeps working.
+bool mountAssetPack(const char* path);
+
+// After everything that reads assets (loader threads, sound engine) has shut down
+void unmountAssetPack();
+
+// Thread-safe once mounted. Close with closeMappedFile as usual
+bool openAssetFile(MappedFile& file, const char* path);
+
+// Routes irrKlang's file access through openAssetFile (sounds play straight from the pack)
+void installPackFileFactory(irrklang::ISoundEngine* engine);
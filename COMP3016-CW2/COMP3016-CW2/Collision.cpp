@@ -0,0 +1,423 @@
+#include "Collision.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+static void cellOf(const CollisionGrid& grid, glm::vec2 p, int& cx, int& cz)
+{
+    cx = (int)floorf(p.x * grid.invCellSize);
+    cz = (int)floorf(p.y * grid.invCellSize);
+}
+
+static uint32_t cellBucket(const CollisionGrid& grid, int cx, int cz)
+{
+    uint32_t h = ((uint32_t)cx * 73856093u) ^ ((uint32_t)cz * 19349663u);
+    return h & grid.bucketMask;
+}
+
+void buildCollisionGrid(CollisionGrid& grid, const std::vector<CollisionCircle>& circles, float cellSize)
+{
+    if (cellSize <= 0.0f)
+    {
+        // A prop then covers at most 2x2 cells, and a player-sized query about as many
+        float maxRadius = 0.0f;
+        for (const CollisionCircle& c : circles)
+            maxRadius = std::max(maxRadius, c.radius);
+        cellSize = (maxRadius > 0.0f) ? 2.0f * maxRadius : 1.0f;
+    }
+    grid.cellSize = cellSize;
+    grid.invCellSize = 1.0f / cellSize;
+
+    // Every (cell, circle) pair the circles produce
+    size_t inserts = 0;
+    for (const CollisionCircle& c : circles)
+    {
+        int x0, z0, x1, z1;
+        cellOf(grid, c.center - glm::vec2(c.radius), x0, z0);
+        cellOf(grid, c.center + glm::vec2(c.radius), x1, z1);
+        inserts += (size_t)(x1 - x0 + 1) * (size_t)(z1 - z0 + 1);
+    }
+
+    // Around two buckets per insert keeps unrelated cells from sharing a bucket
+    uint32_t bucketCount = 16;
+    while (bucketCount < inserts * 2 && bucketCount < (1u << 30))
+        bucketCount <<= 1;
+    grid.bucketMask = bucketCount - 1;
+
+    // Counting sort into buckets: count, prefix sum, scatter
+    grid.bucketStart.assign((size_t)bucketCount + 1, 0);
+    for (const CollisionCircle& c : circles)
+    {
+        int x0, z0, x1, z1;
+        cellOf(grid, c.center - glm::vec2(c.radius), x0, z0);
+        cellOf(grid, c.center + glm::vec2(c.radius), x1, z1);
+        for (int z = z0; z <= z1; ++z)
+            for (int x = x0; x <= x1; ++x)
+                ++grid.bucketStart[cellBucket(grid, x, z) + 1];
+    }
+    for (uint32_t b = 0; b < bucketCount; ++b)
+        grid.bucketStart[b + 1] += grid.bucketStart[b];
+
+    grid.items.resize(inserts);
+    std::vector<uint32_t> cursor(grid.bucketStart.begin(), grid.bucketStart.end() - 1);
+    for (const CollisionCircle& c : circles)
+    {
+        int x0, z0, x1, z1;
+        cellOf(grid, c.center - glm::vec2(c.radius), x0, z0);
+        cellOf(grid, c.center + glm::vec2(c.radius), x1, z1);
+        for (int z = z0; z <= z1; ++z)
+            for (int x = x0; x <= x1; ++x)
+                grid.items[cursor[cellBucket(grid, x, z)]++] = c;
+    }
+
+    uint32_t idCount = 0;
+    for (const CollisionCircle& c : circles)
+        idCount = std::max(idCount, c.id + 1);
+    grid.visited.assign(idCount, 0);
+    grid.queryStamp = 0;
+}
+
+// Same push as the original per-prop loop: out along the centre line, or +X when coincident
+static void pushOut(glm::vec2& p, float radius, const CollisionCircle& c)
+{
+    glm::vec2 d = p - c.center;
+    float dist2 = glm::dot(d, d);
+    float minR = radius + c.radius;
+
+    if (dist2 < (minR * minR) && dist2 > 0.000001f)
+    {
+        float dist = sqrtf(dist2);
+        glm::vec2 n = d / dist;
+        float penetration = (minR - dist);
+        p += n * penetration;
+    }
+    else if (dist2 <= 0.000001f)
+    {
+        p += glm::vec2(minR, 0.0f);
+    }
+}
+
+int resolveCircleCollisions(CollisionGrid& grid, glm::vec2& p, float radius)
+{
+    if (grid.items.empty())
+        return 0;
+
+    int tests = 0;
+    std::vector<const CollisionCircle*>& candidates = grid.candidates;
+
+    for (int iter = 0; iter < 2; ++iter)
+    {
+        // Restart the stamps before the counter wraps
+        if (++grid.queryStamp == 0)
+        {
+            std::fill(grid.visited.begin(), grid.visited.end(), 0u);
+            grid.queryStamp = 1;
+        }
+
+        int x0, z0, x1, z1;
+        cellOf(grid, p - glm::vec2(radius), x0, z0);
+        cellOf(grid, p + glm::vec2(radius), x1, z1);
+
+        candidates.clear();
+        for (int z = z0; z <= z1; ++z)
+        {
+            for (int x = x0; x <= x1; ++x)
+            {
+                uint32_t b = cellBucket(grid, x, z);
+                for (uint32_t i = grid.bucketStart[b]; i < grid.bucketStart[b + 1]; ++i)
+                {
+                    const CollisionCircle& c = grid.items[i];
+                    if (grid.visited[c.id] == grid.queryStamp)
+                        continue;
+                    grid.visited[c.id] = grid.queryStamp;
+                    candidates.push_back(&c);
+                }
+            }
+        }
+
+        // Input order, so pushes resolve exactly as the brute-force loop would
+        std::sort(candidates.begin(), candidates.end(),
+            [](const CollisionCircle* a, const CollisionCircle* b) { return a->id < b->id; });
+        for (const CollisionCircle* c : candidates)
+            pushOut(p, radius, *c);
+        tests += (int)candidates.size();
+    }
+
+    return tests;
+}
+
+// Earliest t in [0, 1] at which p + t * d comes within minR of c, or -1
+// Already overlapping and not moving apart counts as a hit at 0
+static float timeOfImpact(glm::vec2 p, glm::vec2 d, glm::vec2 c, float minR)
+{
+    glm::vec2 m = p - c;
+    float cq = glm::dot(m, m) - minR * minR;
+    float b = glm::dot(m, d);
+    if (cq <= 0.0f)
+        return (b < 0.0f) ? 0.0f : -1.0f;
+
+    float a = glm::dot(d, d);
+    if (b >= 0.0f || a <= 0.0f)
+        return -1.0f;
+
+    float disc = b * b - a * cq;
+    if (disc < 0.0f)
+        return -1.0f;
+
+    float t = (-b - sqrtf(disc)) / a;
+    return (t <= 1.0f) ? std::max(t, 0.0f) : -1.0f;
+}
+
+int sweepCircle(CollisionGrid& grid, glm::vec2& p, glm::vec2 delta, float radius)
+{
+    // Stop this far short of contact so the next sweep doesn't start touching
+    const float SKIN = 0.001f;
+
+    if (grid.items.empty())
+    {
+        p += delta;
+        return 0;
+    }
+
+    int contacts = 0;
+    std::vector<const CollisionCircle*>& candidates = grid.candidates;
+
+    while (contacts < SWEEP_MAX_CONTACTS)
+    {
+        float moveLen = glm::length(delta);
+        if (moveLen <= 1e-6f)
+            return contacts;
+
+        if (++grid.queryStamp == 0)
+        {
+            std::fill(grid.visited.begin(), grid.visited.end(), 0u);
+            grid.queryStamp = 1;
+        }
+
+        // Broadphase: every cell under the swept circle's bounding box
+        glm::vec2 lo = glm::min(p, p + delta) - glm::vec2(radius);
+        glm::vec2 hi = glm::max(p, p + delta) + glm::vec2(radius);
+        int x0, z0, x1, z1;
+        cellOf(grid, lo, x0, z0);
+        cellOf(grid, hi, x1, z1);
+
+        candidates.clear();
+        for (int z = z0; z <= z1; ++z)
+        {
+            for (int x = x0; x <= x1; ++x)
+            {
+                uint32_t b = cellBucket(grid, x, z);
+                for (uint32_t i = grid.bucketStart[b]; i < grid.bucketStart[b + 1]; ++i)
+                {
+                    const CollisionCircle& c = grid.items[i];
+                    if (grid.visited[c.id] == grid.queryStamp)
+                        continue;
+                    grid.visited[c.id] = grid.queryStamp;
+                    candidates.push_back(&c);
+                }
+            }
+        }
+
+        // Earliest contact; ties go to the lower id so the result doesn't depend on bucket order
+        const CollisionCircle* hit = nullptr;
+        float hitT = 2.0f;
+        for (const CollisionCircle* c : candidates)
+        {
+            float t = timeOfImpact(p, delta, c->center, radius + c->radius);
+            if (t < 0.0f)
+                continue;
+            if (t < hitT || (t == hitT && c->id < hit->id))
+            {
+                hit = c;
+                hitT = t;
+            }
+        }
+
+        if (!hit)
+        {
+            p += delta;
+            return contacts;
+        }
+
+        // Advance to the contact, then slide the remaining move along it
+        float t = std::max(hitT - SKIN / moveLen, 0.0f);
+        p += delta * t;
+
+        glm::vec2 n = p - hit->center;
+        float nLen = glm::length(n);
+        n = (nLen > 1e-6f) ? n / nLen : glm::vec2(1.0f, 0.0f);
+
+        delta *= (1.0f - t);
+        float into = glm::dot(delta, n);
+        if (into < 0.0f)
+            delta -= n * into;
+
+        ++contacts;
+    }
+
+    return contacts;
+}
+
+int resolveCircleCollisionsBruteForce(const std::vector<CollisionCircle>& circles, glm::vec2& p, float radius)
+{
+    for (int iter = 0; iter < 2; ++iter)
+        for (const CollisionCircle& c : circles)
+            pushOut(p, radius, c);
+    return 2 * (int)circles.size();
+}
+
+// Benchmark
+void runCollisionBenchmark()
+{
+    using Clock = std::chrono::steady_clock;
+
+    // The scene: 30 trees + 45 rocks scattered over 100 x 100 m, player radius 0.45
+    const float density = 75.0f / (100.0f * 100.0f);
+    const float playerRadius = 0.45f;
+    const int counts[] = { 75, 1000, 10000, 100000, 1000000 };
+    const int GRID_QUERIES = 200000;
+    const double BRUTE_TESTS = 2e8;     // caps the brute-force run at ~a second
+
+    std::ios_base::fmtflags flags = std::cout.flags();
+    std::streamsize precision = std::cout.precision();
+    std::cout << std::fixed;
+
+    std::cout << "Collision broadphase benchmark (" << std::setprecision(4) << density << " props/m^2, player radius "
+        << std::setprecision(2) << playerRadius << ")\n";
+    std::cout << "Scattered queries land anywhere in the world (cold cache); walk queries follow a player\n";
+    std::cout << std::setw(10) << "props" << std::setw(11) << "world m" << std::setw(11) << "build ms" << std::setw(11) << "grid MB"
+        << std::setw(13) << "scatter ns/q" << std::setw(13) << "walk ns/q" << std::setw(11) << "tests/q"
+        << std::setw(15) << "brute ns/q" << std::setw(11) << "mismatches" << "\n";
+
+    for (int count : counts)
+    {
+        float half = 0.5f * sqrtf((float)count / density);
+
+        std::mt19937 rng(1337u + (unsigned)count);
+        std::uniform_real_distribution<float> distXZ(-half, half);
+        std::uniform_real_distribution<float> distTreeS(0.7f, 1.2f);
+        std::uniform_real_distribution<float> distRockS(0.4f, 0.9f);
+
+        std::vector<CollisionCircle> circles((size_t)count);
+        for (int i = 0; i < count; ++i)
+        {
+            CollisionCircle& c = circles[(size_t)i];
+            c.center = glm::vec2(distXZ(rng), distXZ(rng));
+            c.radius = (i % 5 < 2) ? 0.55f * 2.0f * distTreeS(rng) : 0.60f * distRockS(rng);
+            c.id = (uint32_t)i;
+        }
+
+        std::vector<glm::vec2> queries((size_t)GRID_QUERIES);
+        for (glm::vec2& q : queries)
+            q = glm::vec2(distXZ(rng), distXZ(rng));
+
+        auto t0 = Clock::now();
+        CollisionGrid grid;
+        buildCollisionGrid(grid, circles);
+        double buildMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        double gridMB = (grid.bucketStart.size() * sizeof(uint32_t) + grid.items.size() * sizeof(CollisionCircle)
+            + grid.visited.size() * sizeof(uint32_t)) / (1024.0 * 1024.0);
+
+        std::vector<glm::vec2> gridResult(queries);
+        long long tests = 0;
+        t0 = Clock::now();
+        for (glm::vec2& p : gridResult)
+            tests += resolveCircleCollisions(grid, p, playerRadius);
+        double gridNs = std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / GRID_QUERIES;
+
+        // A running player: 10 m/s in 120 Hz steps, turning now and then
+        glm::vec2 walker(0.0f);
+        float heading = 0.0f;
+        std::uniform_real_distribution<float> distTurn(-0.3f, 0.3f);
+        t0 = Clock::now();
+        for (int i = 0; i < GRID_QUERIES; ++i)
+        {
+            heading += distTurn(rng);
+            walker += glm::vec2(cosf(heading), sinf(heading)) * (10.0f / 120.0f);
+            walker = glm::clamp(walker, glm::vec2(-half), glm::vec2(half));
+            resolveCircleCollisions(grid, walker, playerRadius);
+        }
+        double walkNs = std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / GRID_QUERIES;
+
+        int bruteQueries = (int)std::min((double)GRID_QUERIES, std::max(BRUTE_TESTS / (2.0 * count), 1.0));
+        std::vector<glm::vec2> bruteResult(queries.begin(), queries.begin() + bruteQueries);
+        t0 = Clock::now();
+        for (glm::vec2& p : bruteResult)
+            resolveCircleCollisionsBruteForce(circles, p, playerRadius);
+        double bruteNs = std::chrono::duration<double, std::nano>(Clock::now() - t0).count() / bruteQueries;
+
+        // Same circles pushed in the same order, so the positions must match bit for bit
+        int mismatches = 0;
+        for (int i = 0; i < bruteQueries; ++i)
+            if (gridResult[(size_t)i] != bruteResult[(size_t)i])
+                ++mismatches;
+
+        std::cout << std::setw(10) << count << std::setprecision(0) << std::setw(11) << 2.0f * half
+            << std::setprecision(2) << std::setw(11) << buildMs << std::setw(11) << gridMB
+            << std::setprecision(1) << std::setw(13) << gridNs << std::setw(13) << walkNs
+            << std::setprecision(2) << std::setw(11) << (double)tests / GRID_QUERIES
+            << std::setprecision(1) << std::setw(15) << bruteNs << std::setw(11) << mismatches << "\n";
+    }
+
+    // Tunnelling: run (10 m/s) straight at a thin trunk from random offsets with growing steps
+    // An approach tunnels if any step's path passes through the trunk itself
+    std::cout << "\nRunning at a 0.2 m trunk, 1000 approaches per step size\n";
+    std::cout << std::setw(10) << "step s" << std::setw(17) << "discrete tunnel" << std::setw(17) << "swept tunnel" << "\n";
+
+    std::vector<CollisionCircle> trunk(1);
+    trunk[0].center = glm::vec2(0.0f);
+    trunk[0].radius = 0.1f;
+    CollisionGrid trunkGrid;
+    buildCollisionGrid(trunkGrid, trunk);
+
+    std::mt19937 rng(7u);
+    std::uniform_real_distribution<float> distOffset(-0.5f, 0.5f);
+    const float steps[] = { 1.0f / 120.0f, 1.0f / 30.0f, 0.1f, 0.25f, 1.0f };
+    for (float step : steps)
+    {
+        int discreteTunnels = 0;
+        int sweptTunnels = 0;
+        for (int i = 0; i < 1000; ++i)
+        {
+            // Aimed so the player circle always overlaps the trunk somewhere on the way
+            glm::vec2 start(-3.0f, distOffset(rng));
+            glm::vec2 velocity(10.0f, 0.0f);
+
+            auto passesThrough = [&](glm::vec2 from, glm::vec2 to)
+                {
+                    glm::vec2 d = to - from;
+                    float len2 = glm::dot(d, d);
+                    float t = (len2 > 0.0f) ? glm::clamp(glm::dot(trunk[0].center - from, d) / len2, 0.0f, 1.0f) : 0.0f;
+                    return glm::length(from + d * t - trunk[0].center) < trunk[0].radius;
+                };
+
+            glm::vec2 a = start;
+            glm::vec2 b = start;
+            bool aTunnelled = false;
+            bool bTunnelled = false;
+            for (float t = 0.0f; t < 0.6f; t += step)
+            {
+                glm::vec2 from = a;
+                a += velocity * step;
+                resolveCircleCollisions(trunkGrid, a, playerRadius);
+                aTunnelled |= passesThrough(from, a);
+
+                from = b;
+                sweepCircle(trunkGrid, b, velocity * step, playerRadius);
+                resolveCircleCollisions(trunkGrid, b, playerRadius);
+                bTunnelled |= passesThrough(from, b);
+            }
+            discreteTunnels += aTunnelled ? 1 : 0;
+            sweptTunnels += bTunnelled ? 1 : 0;
+        }
+        std::cout << std::setprecision(4) << std::setw(10) << step << std::setw(17) << discreteTunnels
+            << std::setw(17) << sweptTunnels << "\n";
+    }
+
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Minimal DDS container for the block-compressed textures AssetBaker writes
+// Only the legacy FourCC header is used (DXT1 = BC1, DXT5 = BC3, ATI2 = BC5),
+// so the files also open in any standard DDS viewer. Mips follow the header
+// largest first, each level tightly packed in 4x4 blocks.
+static const uint32_t DDS_MAGIC = 0x20534444;        // "DDS "
+
+static const uint32_t DDSD_CAPS = 0x1;
+static const uint32_t DDSD_HEIGHT = 0x2;
+static const uint32_t DDSD_WIDTH = 0x4;
+static const uint32_t DDSD_PIXELFORMAT = 0x1000;
+static const uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+static const uint32_t DDSD_LINEARSIZE = 0x80000;
+
+static const uint32_t DDPF_FOURCC = 0x4;
+
+static const uint32_t DDSCAPS_COMPLEX = 0x8;
+static const uint32_t DDSCAPS_TEXTURE = 0x1000;
+static const uint32_t DDSCAPS_MIPMAP = 0x400000;
+
+inline constexpr uint32_t ddsFourCC(char a, char b, char c, char d)
+{
+    return (uint32_t)(uint8_t)a | ((uint32_t)(uint8_t)b << 8) | ((uint32_t)(uint8_t)c << 16) | ((uint32_t)(uint8_t)d << 24);
+}
+
+static const uint32_t FOURCC_BC1 = ddsFourCC('D', 'X', 'T', '1');
+static const uint32_t FOURCC_BC3 = ddsFourCC('D', 'X', 'T', '5');
+static const uint32_t FOURCC_BC5 = ddsFourCC('A', 'T', 'I', '2');
+
+struct DdsPixelFormat
+{
+    uint32_t size;
+    uint32_t flags;
+    uint32_t fourCC;
+    uint32_t rgbBitCount;
+    uint32_t rBitMask;
+    uint32_t gBitMask;
+    uint32_t bBitMask;
+    uint32_t aBitMask;
+};
+
+struct DdsHeader
+{
+    uint32_t size;
+    uint32_t flags;
+    uint32_t height;
+    uint32_t width;
+    uint32_t pitchOrLinearSize;
+    uint32_t depth;
+    uint32_t mipMapCount;
+    uint32_t reserved1[11];
+    DdsPixelFormat pixelFormat;
+    uint32_t caps;
+    uint32_t caps2;
+    uint32_t caps3;
+    uint32_t caps4;
+    uint32_t reserved2;
+};
+
+static_assert(sizeof(DdsPixelFormat) == 32, "DdsPixelFormat layout changed");
+static_assert(sizeof(DdsHeader) == 124, "DdsHeader layout changed");
+
+// Bytes per 4x4 block (BC1 = 8, BC3/BC5 = 16)
+inline uint32_t ddsBlockBytes(uint32_t fourCC)
+{
+    return fourCC == FOURCC_BC1 ? 8u : 16u;
+}
+
+inline uint32_t ddsLevelBytes(uint32_t fourCC, uint32_t width, uint32_t height)
+{
+    return ((width + 3) / 4) * ((height + 3) / 4) * ddsBlockBytes(fourCC);
+}
+
+// Where the runtime looks for the baked copy of a source image (same path, .dds extension)
+inline std::string bakedTexturePath(const std::string& sourcePath)
+{
+    size_t slash = sourcePath.find_last_of("/\\");
+    size_t dot = sourcePath.find_last_of('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        return sourcePath + ".dds";
+    return sourcePath.substr(0, dot) + ".dds";
+}
@@ -0,0 +1,38 @@
+#include "DynamicResolution.h"
+
+#include <algorithm>
+#include <cmath>
+
+float updateDynamicResolution(DynamicResolution& drs, double gpuMs, double fixedMs, int sample)
+{
+    if (!drs.enabled)
+    {
+        drs.scale = drs.maxScale;
+        return drs.scale;
+    }
+
+    if (sample == drs.lastSample || gpuMs <= 0.0)
+        return drs.scale;
+    drs.lastSample = sample;
+
+    // Light smoothing so single spikes don't make the image pump
+    if (drs.smoothedMs <= 0.0f)
+        drs.smoothedMs = (float)gpuMs;
+    else
+        drs.smoothedMs += ((float)gpuMs - drs.smoothedMs) * 0.25f;
+
+    float scalableMs = std::max(drs.smoothedMs - (float)fixedMs, 0.05f);
+    float scalableBudget = std::max(drs.budgetMs - (float)fixedMs, 0.05f);
+
+    // Pixel cost ~ scale^2, so the scale that would hit the budget is sqrt of the ratio
+    float target = drs.scale * sqrtf(scalableBudget / scalableMs);
+    target = std::max(drs.minScale, std::min(drs.maxScale, target));
+
+    // Drop quickly when over budget, recover slowly, ignore tiny changes
+    float rate = (target < drs.scale) ? 0.5f : 0.05f;
+    float next = drs.scale + (target - drs.scale) * rate;
+    if (fabsf(next - drs.scale) > 0.005f)
+        drs.scale = next;
+
+    return drs.scale;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+// Dynamic resolution controller
+// Fed with measured GPU time each time new query results arrive, it steers the
+// scene render scale so the frame fits inside budgetMs. Scene cost is treated as
+// proportional to pixel count (scale^2); fixed-cost passes at native resolution
+// are passed separately so they are not "scaled away".
+struct DynamicResolution
+{
+    bool enabled = true;
+    float budgetMs = 14.0f;     // leaves headroom under a 60 Hz vsync interval
+    float minScale = 0.5f;
+    float maxScale = 1.0f;
+
+    float scale = 1.0f;
+    float smoothedMs = 0.0f;
+    int lastSample = -1;
+};
+
+// gpuMs: total GPU frame time, fixedMs: part of it that does not scale with resolution
+// sample: id of the measurement so the same reading is not applied twice
+float updateDynamicResolution(DynamicResolution& drs, double gpuMs, double fixedMs, int sample);
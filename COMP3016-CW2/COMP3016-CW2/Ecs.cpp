@@ -0,0 +1,359 @@
+#include "Ecs.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+
+// Component registry
+static std::mutex gComponentMutex;
+static ComponentType gComponentTypes[MAX_COMPONENT_TYPES];
+static int gComponentTypeCount = 0;
+
+int registerComponentType(const char* name, size_t size, size_t align)
+{
+    // Columns are plain byte vectors, aligned for anything new can return
+    assert(align <= alignof(std::max_align_t));
+    (void)align;
+
+    std::lock_guard<std::mutex> lock(gComponentMutex);
+    assert(gComponentTypeCount < MAX_COMPONENT_TYPES);
+    gComponentTypes[gComponentTypeCount].name = name;
+    gComponentTypes[gComponentTypeCount].size = size;
+    return gComponentTypeCount++;
+}
+
+const ComponentType& componentType(int id)
+{
+    return gComponentTypes[id];
+}
+
+// Archetypes
+static int findArchetype(World& world, ComponentMask mask)
+{
+    for (size_t i = 0; i < world.archetypes.size(); ++i)
+        if (world.archetypes[i].mask == mask)
+            return (int)i;
+
+    Archetype a;
+    a.mask = mask;
+    for (int t = 0; t < MAX_COMPONENT_TYPES; ++t)
+    {
+        a.column[t] = -1;
+        if (mask & (ComponentMask(1) << t))
+        {
+            a.column[t] = (int)a.types.size();
+            a.types.push_back(t);
+        }
+    }
+    a.columns.resize(a.types.size());
+    world.archetypes.push_back(std::move(a));
+    return (int)world.archetypes.size() - 1;
+}
+
+// Appends a zeroed row for e, returns its index
+static uint32_t appendRow(Archetype& a, Entity e)
+{
+    uint32_t row = (uint32_t)a.entities.size();
+    a.entities.push_back(e);
+    for (size_t c = 0; c < a.types.size(); ++c)
+        a.columns[c].resize(a.columns[c].size() + componentType(a.types[c]).size, 0);
+    return row;
+}
+
+// Swap-removes a row, fixing the record of the entity moved into its place
+static void removeRow(World& world, Archetype& a, uint32_t row)
+{
+    uint32_t last = (uint32_t)a.entities.size() - 1;
+    if (row != last)
+    {
+        Entity moved = a.entities[last];
+        a.entities[row] = moved;
+        for (size_t c = 0; c < a.types.size(); ++c)
+        {
+            size_t size = componentType(a.types[c]).size;
+            memcpy(a.columns[c].data() + row * size, a.columns[c].data() + last * size, size);
+        }
+        world.records[moved.index].row = row;
+    }
+
+    a.entities.pop_back();
+    for (size_t c = 0; c < a.types.size(); ++c)
+        a.columns[c].resize(a.columns[c].size() - componentType(a.types[c]).size);
+}
+
+int createEntities(World& world, ComponentMask mask, size_t count, uint32_t& firstRow)
+{
+    int archetype = findArchetype(world, mask);
+    Archetype& a = world.archetypes[archetype];
+    firstRow = (uint32_t)a.entities.size();
+
+    // One resize per column for the whole batch, the new rows come out zeroed
+    a.entities.resize(firstRow + count);
+    for (size_t c = 0; c < a.types.size(); ++c)
+        a.columns[c].resize(a.columns[c].size() + count * componentType(a.types[c]).size, 0);
+
+    size_t reused = std::min(count, world.freeIndices.size());
+    world.records.reserve(world.records.size() + (count - reused));
+    for (size_t i = 0; i < count; ++i)
+    {
+        Entity e;
+        if (!world.freeIndices.empty())
+        {
+            e.index = world.freeIndices.back();
+            world.freeIndices.pop_back();
+        }
+        else
+        {
+            e.index = (uint32_t)world.records.size();
+            world.records.emplace_back();
+        }
+
+        EntityRecord& record = world.records[e.index];
+        e.generation = record.generation;
+        record.archetype = archetype;
+        record.row = firstRow + (uint32_t)i;
+        a.entities[record.row] = e;
+    }
+
+    world.liveCount += count;
+    return archetype;
+}
+
+Entity createEntity(World& world, ComponentMask mask)
+{
+    uint32_t row = 0;
+    int archetype = createEntities(world, mask, 1, row);
+    return world.archetypes[archetype].entities[row];
+}
+
+bool entityAlive(const World& world, Entity e)
+{
+    return e.index < world.records.size()
+        && world.records[e.index].archetype >= 0
+        && world.records[e.index].generation == e.generation;
+}
+
+void destroyEntity(World& world, Entity e)
+{
+    if (!entityAlive(world, e))
+        return;
+
+    EntityRecord& record = world.records[e.index];
+    removeRow(world, world.archetypes[record.archetype], record.row);
+
+    // Bumping the generation invalidates handles still pointing at this slot
+    record.archetype = -1;
+    record.generation++;
+    world.freeIndices.push_back(e.index);
+    world.liveCount--;
+}
+
+ComponentMask entityComponents(const World& world, Entity e)
+{
+    if (!entityAlive(world, e))
+        return 0;
+    return world.archetypes[world.records[e.index].archetype].mask;
+}
+
+void setEntityComponents(World& world, Entity e, ComponentMask mask)
+{
+    if (!entityAlive(world, e))
+        return;
+
+    EntityRecord& record = world.records[e.index];
+    int from = record.archetype;
+    if (world.archetypes[from].mask == mask)
+        return;
+
+    // findArchetype may grow the vector, so look archetypes up by index from here on
+    int to = findArchetype(world, mask);
+    uint32_t oldRow = record.row;
+    uint32_t newRow = appendRow(world.archetypes[to], e);
+
+    Archetype& src = world.archetypes[from];
+    Archetype& dst = world.archetypes[to];
+    for (size_t c = 0; c < dst.types.size(); ++c)
+    {
+        int type = dst.types[c];
+        int srcColumn = src.column[type];
+        if (srcColumn < 0)
+            continue;
+        size_t size = componentType(type).size;
+        memcpy(dst.columns[c].data() + newRow * size, src.columns[srcColumn].data() + oldRow * size, size);
+    }
+
+    removeRow(world, src, oldRow);
+    record.archetype = to;
+    record.row = newRow;
+}
+
+size_t setArchetypeComponents(World& world, ComponentMask from, ComponentMask to)
+{
+    int src = -1;
+    for (size_t i = 0; i < world.archetypes.size() && src < 0; ++i)
+        if (world.archetypes[i].mask == from)
+            src = (int)i;
+    if (src < 0 || from == to || world.archetypes[src].entities.empty())
+        return 0;
+
+    // findArchetype may grow the vector, so take references after it
+    int dst = findArchetype(world, to);
+    Archetype& s = world.archetypes[src];
+    Archetype& d = world.archetypes[dst];
+    size_t count = s.entities.size();
+    uint32_t base = (uint32_t)d.entities.size();
+
+    d.entities.insert(d.entities.end(), s.entities.begin(), s.entities.end());
+    for (size_t c = 0; c < d.types.size(); ++c)
+    {
+        int type = d.types[c];
+        size_t size = componentType(type).size;
+        size_t offset = d.columns[c].size();
+        d.columns[c].resize(offset + count * size, 0);
+        if (s.column[type] >= 0)
+            memcpy(d.columns[c].data() + offset, s.columns[s.column[type]].data(), count * size);
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        EntityRecord& record = world.records[s.entities[i].index];
+        record.archetype = dst;
+        record.row = base + (uint32_t)i;
+    }
+
+    s.entities.clear();
+    for (std::vector<unsigned char>& column : s.columns)
+        column.clear();
+    return count;
+}
+
+void* archetypeColumn(Archetype& archetype, int type)
+{
+    int column = archetype.column[type];
+    return (column >= 0) ? archetype.columns[column].data() : nullptr;
+}
+
+void* componentData(World& world, Entity e, int type)
+{
+    if (!entityAlive(world, e))
+        return nullptr;
+
+    const EntityRecord& record = world.records[e.index];
+    Archetype& a = world.archetypes[record.archetype];
+    unsigned char* column = (unsigned char*)archetypeColumn(a, type);
+    return column ? column + record.row * componentType(type).size : nullptr;
+}
+
+void reportWorld(const World& world)
+{
+    std::cout << "ECS: " << world.liveCount << " entities in " << world.archetypes.size() << " archetypes\n";
+    for (const Archetype& a : world.archetypes)
+    {
+        size_t rowBytes = sizeof(Entity);
+        for (int t : a.types)
+            rowBytes += componentType(t).size;
+
+        std::cout << "  " << std::setw(6) << a.entities.size() << " x " << std::setw(4) << rowBytes << " bytes:";
+        for (int t : a.types)
+            std::cout << " " << componentType(t).name;
+        std::cout << "\n";
+    }
+}
+
+// Systems
+void addSystem(SystemSchedule& schedule, const char* name, ComponentMask reads, ComponentMask writes,
+    SystemFn run, void* context, bool mainThread)
+{
+    System s;
+    s.name = name;
+    s.reads = reads;
+    s.writes = writes;
+    s.run = run;
+    s.context = context;
+    s.mainThread = mainThread;
+    schedule.systems.push_back(s);
+}
+
+static bool systemsConflict(const System& a, const System& b)
+{
+    return (a.writes & (b.reads | b.writes)) != 0 || (b.writes & a.reads) != 0;
+}
+
+void buildSchedule(SystemSchedule& schedule)
+{
+    schedule.batches.clear();
+    for (size_t i = 0; i < schedule.systems.size(); ++i)
+    {
+        System& s = schedule.systems[i];
+        s.batch = 0;
+        for (size_t j = 0; j < i; ++j)
+            if (systemsConflict(s, schedule.systems[j]))
+                s.batch = std::max(s.batch, schedule.systems[j].batch + 1);
+
+        if ((int)schedule.batches.size() <= s.batch)
+            schedule.batches.resize(s.batch + 1);
+        schedule.batches[s.batch].push_back((int)i);
+    }
+}
+
+static void runSystem(System& s, World& world)
+{
+    auto start = std::chrono::steady_clock::now();
+    s.run(world, s.context);
+    s.lastMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void systemJob(void* data, int index)
+{
+    SystemSchedule& schedule = *(SystemSchedule*)data;
+    runSystem(schedule.systems[index], *schedule.world);
+}
+
+void runSchedule(SystemSchedule& schedule, World& world)
+{
+    if (!world.jobs)
+    {
+        for (const std::vector<int>& batch : schedule.batches)
+            for (int index : batch)
+                runSystem(schedule.systems[index], world);
+        return;
+    }
+
+    // One counter per batch; batch b's systems are parked on batch b-1's until it drains
+    schedule.world = &world;
+    std::vector<JobCounter> done(schedule.batches.size());
+    for (size_t b = 0; b < schedule.batches.size(); ++b)
+    {
+        JobCounter* after = b ? &done[b - 1] : nullptr;
+        for (int index : schedule.batches[b])
+        {
+            int flags = schedule.systems[index].mainThread ? JOB_MAIN_THREAD : 0;
+            submitJob(*world.jobs, systemJob, &schedule, index, &done[b], after, flags);
+        }
+    }
+
+    if (!done.empty())
+        waitForCounter(*world.jobs, done.back());
+    schedule.world = nullptr;
+}
+
+void printSchedule(const SystemSchedule& schedule)
+{
+    std::cout << "ECS schedule:";
+    for (size_t b = 0; b < schedule.batches.size(); ++b)
+    {
+        std::cout << (b ? " ->" : "") << " [";
+        for (size_t i = 0; i < schedule.batches[b].size(); ++i)
+        {
+            const System& s = schedule.systems[schedule.batches[b][i]];
+            std::cout << (i ? ", " : "") << s.name << (s.mainThread ? " (main)" : "");
+        }
+        std::cout << "]";
+    }
+    std::cout << "\n";
+}
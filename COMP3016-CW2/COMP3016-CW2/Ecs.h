@@ -0,0 +1,200 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+
+#include "JobSystem.h"
+
+// Archetype entity-component store
+// Entities with the same set of components share an archetype, which keeps one
+// contiguous array per component type (and one of entity ids), row i of every
+// array belonging to the same entity. Queries walk the archetypes whose set
+// includes the requested types and hand out raw column pointers, so systems
+// stream through tightly packed data and never touch components they didn't
+// ask for. Adding or removing components moves the entity's row to another
+// archetype; such structural changes must not happen while systems run.
+//
+// Components are plain data (moved with memcpy, zero-filled when created).
+
+typedef uint64_t ComponentMask;
+static const int MAX_COMPONENT_TYPES = 64;
+
+struct Entity
+{
+    uint32_t index = 0xFFFFFFFFu;
+    uint32_t generation = 0;
+};
+
+inline bool operator==(Entity a, Entity b) { return a.index == b.index && a.generation == b.generation; }
+inline bool operator!=(Entity a, Entity b) { return !(a == b); }
+
+struct ComponentType
+{
+    const char* name = nullptr;
+    size_t size = 0;
+};
+
+// Process-wide registry; ids are handed out on first use of each type
+int registerComponentType(const char* name, size_t size, size_t align);
+const ComponentType& componentType(int id);
+
+struct Archetype
+{
+    ComponentMask mask = 0;
+    int column[MAX_COMPONENT_TYPES];            // column per component id, -1 when absent
+    std::vector<int> types;                     // component ids in column order
+    std::vector<std::vector<unsigned char>> columns;
+    std::vector<Entity> entities;
+};
+
+struct EntityRecord
+{
+    uint32_t generation = 0;
+    int archetype = -1;                         // -1 when the slot is free
+    uint32_t row = 0;
+};
+
+struct World
+{
+    std::vector<Archetype> archetypes;
+    std::vector<EntityRecord> records;          // by entity index
+    std::vector<uint32_t> freeIndices;
+    size_t liveCount = 0;
+
+    // Systems and the schedule spread their work over this; null runs everything on the caller
+    JobSystem* jobs = nullptr;
+};
+
+Entity createEntity(World& world, ComponentMask mask);
+
+// Bulk spawn: count entities with zeroed components, without per-entity allocations
+// They take rows [firstRow, firstRow + count) of the returned archetype, to be filled through archetypeColumn
+int createEntities(World& world, ComponentMask mask, size_t count, uint32_t& firstRow);
+void destroyEntity(World& world, Entity e);
+bool entityAlive(const World& world, Entity e);
+
+// Moves the entity to the archetype for mask; components it keeps are copied, new ones zeroed
+void setEntityComponents(World& world, Entity e, ComponentMask mask);
+ComponentMask entityComponents(const World& world, Entity e);
+
+// setEntityComponents for every entity in the archetype with mask from, a whole column at a time
+// Returns how many entities moved
+size_t setArchetypeComponents(World& world, ComponentMask from, ComponentMask to);
+
+// Null if the entity is dead or lacks the component
+void* componentData(World& world, Entity e, int type);
+void* archetypeColumn(Archetype& archetype, int type);
+
+// Archetypes with their entity counts and bytes
+void reportWorld(const World& world);
+
+template <typename T>
+int componentId()
+{
+    static_assert(std::is_trivially_copyable<T>::value, "components are moved with memcpy");
+    static const int id = registerComponentType(typeid(T).name(), sizeof(T), alignof(T));
+    return id;
+}
+
+template <typename... Cs>
+ComponentMask componentMask()
+{
+    ComponentMask mask = 0;
+    (void)std::initializer_list<int>{ (mask |= ComponentMask(1) << componentId<std::remove_const_t<Cs>>(), 0)... };
+    return mask;
+}
+
+template <typename T>
+T* getComponent(World& world, Entity e)
+{
+    return (T*)componentData(world, e, componentId<T>());
+}
+
+template <typename... Cs>
+Entity spawnEntity(World& world, const Cs&... values)
+{
+    Entity e = createEntity(world, componentMask<Cs...>());
+    (void)std::initializer_list<int>{ (*getComponent<Cs>(world, e) = values, 0)... };
+    return e;
+}
+
+template <typename T>
+void addComponent(World& world, Entity e, const T& value)
+{
+    setEntityComponents(world, e, entityComponents(world, e) | componentMask<T>());
+    if (T* c = getComponent<T>(world, e))
+        *c = value;
+}
+
+template <typename T>
+void removeComponent(World& world, Entity e)
+{
+    setEntityComponents(world, e, entityComponents(world, e) & ~componentMask<T>());
+}
+
+// f(count, entities, Cs* columns...) once per non-empty archetype holding every Cs
+// (const Cs give const pointers; the access declaration is up to the system)
+template <typename... Cs, typename F>
+void forEachChunk(World& world, F&& f)
+{
+    ComponentMask need = componentMask<Cs...>();
+    for (Archetype& a : world.archetypes)
+    {
+        if ((a.mask & need) != need || a.entities.empty())
+            continue;
+        f(a.entities.size(), (const Entity*)a.entities.data(),
+            (Cs*)archetypeColumn(a, componentId<std::remove_const_t<Cs>>())...);
+    }
+}
+
+// f(Cs&...) for every entity holding every Cs
+template <typename... Cs, typename F>
+void forEachEntity(World& world, F&& f)
+{
+    forEachChunk<Cs...>(world, [&](size_t count, const Entity*, Cs*... columns)
+        {
+            for (size_t i = 0; i < count; ++i)
+                f(columns[i]...);
+        });
+}
+
+// Systems
+// Each system declares the component types it reads and writes. buildSchedule
+// puts every system in the earliest batch after all earlier-registered systems
+// it conflicts with (one writes what the other reads or writes). runSchedule
+// submits every system as a job that waits on the previous batch's counter, so
+// systems in a batch run in parallel and batches run in order, and the caller
+// helps until the last batch is done. Main-thread systems (GL, anything with
+// thread affinity) are main-thread jobs, so the caller must be thread 0 of
+// world.jobs.
+typedef void (*SystemFn)(World& world, void* context);
+
+struct System
+{
+    const char* name = nullptr;
+    ComponentMask reads = 0;
+    ComponentMask writes = 0;
+    SystemFn run = nullptr;
+    void* context = nullptr;
+    bool mainThread = false;
+    int batch = 0;
+    double lastMs = 0.0;
+};
+
+struct SystemSchedule
+{
+    std::vector<System> systems;
+    std::vector<std::vector<int>> batches;
+    World* world = nullptr;             // while runSchedule runs
+};
+
+void addSystem(SystemSchedule& schedule, const char* name, ComponentMask reads, ComponentMask writes,
+    SystemFn run, void* context, bool mainThread = false);
+
+void buildSchedule(SystemSchedule& schedule);
+void runSchedule(SystemSchedule& schedule, World& world);
+void printSchedule(const SystemSchedule& schedule);
@@ -0,0 +1,156 @@
+#include "GpuProfiler.h"
+
+#include <iomanip>
+#include <iostream>
+
+void initGpuProfiler(GpuProfiler& prof, const char* const* stageNames, int stageCount)
+{
+    prof.stageCount = (stageCount < GpuProfiler::MAX_STAGES) ? stageCount : GpuProfiler::MAX_STAGES;
+    for (int s = 0; s < prof.stageCount; ++s)
+        prof.names[s] = stageNames[s];
+
+    for (int f = 0; f < GpuProfiler::LATENCY; ++f)
+        glGenQueries(prof.stageCount, prof.queries[f]);
+}
+
+void gpuProfilerBeginFrame(GpuProfiler& prof)
+{
+    int slot = prof.frame % GpuProfiler::LATENCY;
+
+    // This slot was recorded LATENCY frames ago, its results are normally ready by now.
+    // If any stage is still pending, leave the whole frame for a later pass rather than publish a partial total,
+    // and skip timing this frame so the pending queries aren't reissued.
+    bool any = false;
+    for (int s = 0; s < prof.stageCount; ++s)
+    {
+        if (!prof.issued[slot][s]) continue;
+
+        GLuint available = 0;
+        glGetQueryObjectuiv(prof.queries[slot][s], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+        {
+            prof.recording = false;
+            return;
+        }
+        any = true;
+    }
+    prof.recording = true;
+    if (!any) return;
+
+    double total = 0.0;
+    for (int s = 0; s < prof.stageCount; ++s)
+    {
+        if (!prof.issued[slot][s]) continue;
+
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(prof.queries[slot][s], GL_QUERY_RESULT, &ns);
+        prof.issued[slot][s] = false;
+
+        double ms = (double)ns * 1e-6;
+        prof.lastMs[s] = ms;
+        prof.accumMs[s] += ms;
+        total += ms;
+    }
+
+    prof.lastFrameMs = total;
+    prof.resolvedCount++;
+    prof.accumFrames++;
+}
+
+void gpuProfilerEndFrame(GpuProfiler& prof)
+{
+    prof.frame++;
+}
+
+int addCpuThread(GpuProfiler& prof, const char* name)
+{
+    if (prof.cpuThreadCount >= GpuProfiler::MAX_CPU_THREADS) return -1;
+
+    prof.cpuNames[prof.cpuThreadCount] = name;
+    return prof.cpuThreadCount++;
+}
+
+void recordCpuTime(GpuProfiler& prof, int lane, double ms)
+{
+    if (lane < 0 || lane >= prof.cpuThreadCount) return;
+
+    prof.cpuAccumUs[lane].fetch_add((uint64_t)(ms * 1000.0), std::memory_order_relaxed);
+    prof.cpuAccumCount[lane].fetch_add(1, std::memory_order_relaxed);
+}
+
+void gpuStageBegin(GpuProfiler& prof, int stage)
+{
+    if (!prof.recording || stage < 0 || stage >= prof.stageCount || prof.activeStage >= 0) return;
+
+    int slot = prof.frame % GpuProfiler::LATENCY;
+    glBeginQuery(GL_TIME_ELAPSED, prof.queries[slot][stage]);
+    prof.issued[slot][stage] = true;
+    prof.activeStage = stage;
+}
+
+void gpuStageEnd(GpuProfiler& prof)
+{
+    if (prof.activeStage < 0) return;
+
+    glEndQuery(GL_TIME_ELAPSED);
+    prof.activeStage = -1;
+}
+
+void reportGpuProfiler(GpuProfiler& prof, double now, double intervalSeconds)
+{
+    double elapsed = now - prof.lastReportTime;
+    if (elapsed < intervalSeconds) return;
+    prof.lastReportTime = now;
+
+    std::ios_base::fmtflags flags = std::cout.flags();
+    std::streamsize precision = std::cout.precision();
+    std::cout << std::fixed;
+
+    if (prof.cpuThreadCount > 0)
+    {
+        std::cout << "CPU ms:";
+        for (int t = 0; t < prof.cpuThreadCount; ++t)
+        {
+            uint64_t us = prof.cpuAccumUs[t].exchange(0, std::memory_order_relaxed);
+            uint32_t count = prof.cpuAccumCount[t].exchange(0, std::memory_order_relaxed);
+            double avg = count ? (double)us / count / 1000.0 : 0.0;
+            std::cout << " " << prof.cpuNames[t] << " " << std::setprecision(3) << avg
+                << " (" << std::setprecision(0) << count / elapsed << "/s)"
+                << ((t + 1 < prof.cpuThreadCount) ? " |" : "\n");
+        }
+    }
+
+    if (prof.accumFrames > 0)
+    {
+        double total = 0.0;
+        std::cout << "GPU ms:" << std::setprecision(3);
+        for (int s = 0; s < prof.stageCount; ++s)
+        {
+            double avg = prof.accumMs[s] / prof.accumFrames;
+            total += avg;
+            std::cout << " " << prof.names[s] << " " << avg << " |";
+            prof.accumMs[s] = 0.0;
+        }
+        std::cout << " total " << total << "\n";
+        prof.accumFrames = 0;
+    }
+
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+}
+
+void destroyGpuProfiler(GpuProfiler& prof)
+{
+    for (int f = 0; f < GpuProfiler::LATENCY; ++f)
+        glDeleteQueries(prof.stageCount, prof.queries[f]);
+
+    // The atomics make the struct non-assignable, so reset what init sets up
+    prof.stageCount = 0;
+    prof.cpuThreadCount = 0;
+    for (int f = 0; f < GpuProfiler::LATENCY; ++f)
+        for (int s = 0; s < GpuProfiler::MAX_STAGES; ++s)
+        {
+            prof.queries[f][s] = 0;
+            prof.issued[f][s] = false;
+        }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#define NOMINMAX
+#include <GL/glew.h>
+
+#include <atomic>
+#include <cstdint>
+
+// GPU stage timing with GL_TIME_ELAPSED queries
+// Queries are kept in a small ring so results are read a few frames late and never stall the pipeline.
+// CPU threads (render, simulation) can add their own busy time to the same periodic report.
+struct GpuProfiler
+{
+    static const int MAX_STAGES = 8;
+    static const int LATENCY = 4;
+    static const int MAX_CPU_THREADS = 4;
+
+    const char* names[MAX_STAGES] = {};
+    int stageCount = 0;
+
+    GLuint queries[LATENCY][MAX_STAGES] = {};
+    bool issued[LATENCY][MAX_STAGES] = {};
+    int frame = 0;
+    int activeStage = -1;
+    bool recording = true;      // false when the slot still holds unresolved queries; that frame goes untimed
+
+    // Most recent resolved timings
+    double lastMs[MAX_STAGES] = {};
+    double lastFrameMs = 0.0;
+    int resolvedCount = 0;      // bumps every time a new frame's results arrive
+
+    // Rolling sums for the periodic console report
+    double accumMs[MAX_STAGES] = {};
+    int accumFrames = 0;
+    double lastReportTime = 0.0;
+
+    // CPU lanes, written from their own threads
+    const char* cpuNames[MAX_CPU_THREADS] = {};
+    int cpuThreadCount = 0;
+    std::atomic<uint64_t> cpuAccumUs[MAX_CPU_THREADS] = {};
+    std::atomic<uint32_t> cpuAccumCount[MAX_CPU_THREADS] = {};
+};
+
+void initGpuProfiler(GpuProfiler& prof, const char* const* stageNames, int stageCount);
+
+// Collect results for the oldest frame in the ring, then start recording a new frame
+void gpuProfilerBeginFrame(GpuProfiler& prof);
+void gpuProfilerEndFrame(GpuProfiler& prof);
+
+// GL thread, before the lane's thread starts; returns the lane or -1 when full
+int addCpuThread(GpuProfiler& prof, const char* name);
+
+// Any thread: one unit of work (a frame, a tick) on the given lane
+void recordCpuTime(GpuProfiler& prof, int lane, double ms);
+
+void gpuStageBegin(GpuProfiler& prof, int stage);
+void gpuStageEnd(GpuProfiler& prof);
+
+// Prints average per-stage times (and per-unit CPU times with their rate) every intervalSeconds
+void reportGpuProfiler(GpuProfiler& prof, double now, double intervalSeconds);
+
+void destroyGpuProfiler(GpuProfiler& prof);
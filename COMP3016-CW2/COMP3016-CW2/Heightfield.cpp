@@ -0,0 +1,421 @@
+#include "Heightfield.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+static float heightAt(const Heightfield& hf, int x, int z)
+{
+    return hf.heights[(size_t)z * (hf.size + 1) + x];
+}
+
+void buildHeightfield(Heightfield& hf, int size, float spacing, float (*sample)(float, float))
+{
+    hf.size = std::max(size, 1);
+    hf.spacing = spacing;
+    hf.origin = glm::vec2(-hf.size / 2.0f * spacing);
+
+    int side = hf.size + 1;
+    hf.heights.resize((size_t)side * side);
+    for (int z = 0; z < side; ++z)
+        for (int x = 0; x < side; ++x)
+            hf.heights[(size_t)z * side + x] = sample(hf.origin.x + x * spacing, hf.origin.y + z * spacing);
+
+    // First level straight from the heights: each cell spans 2x2 quads (3x3 samples, fewer at the edge)
+    hf.levels.clear();
+    hf.levels.emplace_back();
+    HeightfieldLevel& first = hf.levels.back();
+    first.dim = (hf.size + 1) / 2;
+    first.ranges.resize((size_t)first.dim * first.dim);
+    for (int cz = 0; cz < first.dim; ++cz)
+    {
+        for (int cx = 0; cx < first.dim; ++cx)
+        {
+            HeightRange r{ heightAt(hf, 2 * cx, 2 * cz), heightAt(hf, 2 * cx, 2 * cz) };
+            for (int z = 2 * cz; z <= std::min(2 * cz + 2, hf.size); ++z)
+            {
+                for (int x = 2 * cx; x <= std::min(2 * cx + 2, hf.size); ++x)
+                {
+                    float h = heightAt(hf, x, z);
+                    r.lo = std::min(r.lo, h);
+                    r.hi = std::max(r.hi, h);
+                }
+            }
+            first.ranges[(size_t)cz * first.dim + cx] = r;
+        }
+    }
+
+    // Then halve until a single cell covers the whole field
+    while (hf.levels.back().dim > 1)
+    {
+        const HeightfieldLevel& fine = hf.levels.back();
+        HeightfieldLevel coarse;
+        coarse.dim = (fine.dim + 1) / 2;
+        coarse.ranges.resize((size_t)coarse.dim * coarse.dim);
+        for (int cz = 0; cz < coarse.dim; ++cz)
+        {
+            for (int cx = 0; cx < coarse.dim; ++cx)
+            {
+                HeightRange r = fine.ranges[(size_t)(2 * cz) * fine.dim + 2 * cx];
+                for (int z = 2 * cz; z < std::min(2 * cz + 2, fine.dim); ++z)
+                {
+                    for (int x = 2 * cx; x < std::min(2 * cx + 2, fine.dim); ++x)
+                    {
+                        const HeightRange& c = fine.ranges[(size_t)z * fine.dim + x];
+                        r.lo = std::min(r.lo, c.lo);
+                        r.hi = std::max(r.hi, c.hi);
+                    }
+                }
+                coarse.ranges[(size_t)cz * coarse.dim + cx] = r;
+            }
+        }
+        hf.levels.push_back(std::move(coarse));
+    }
+}
+
+// Ray setup shared by both walks; zero direction components become tiny so the slabs stay finite
+struct RayInfo
+{
+    glm::vec3 origin;
+    glm::vec3 dir;
+    glm::vec3 invDir;
+};
+
+static RayInfo makeRayInfo(const HeightfieldRay& ray)
+{
+    RayInfo info;
+    info.origin = ray.origin;
+    info.dir = ray.dir;
+    for (int i = 0; i < 3; ++i)
+    {
+        float d = ray.dir[i];
+        if (fabsf(d) < 1e-12f)
+            d = (d < 0.0f) ? -1e-12f : 1e-12f;
+        info.invDir[i] = 1.0f / d;
+    }
+    return info;
+}
+
+// Entry t of the ray into the box if it is entered before tMax
+static bool rayBox(const RayInfo& ray, const glm::vec3& lo, const glm::vec3& hi, float tMax, float& tEnter)
+{
+    glm::vec3 t0 = (lo - ray.origin) * ray.invDir;
+    glm::vec3 t1 = (hi - ray.origin) * ray.invDir;
+    glm::vec3 tNear = glm::min(t0, t1);
+    glm::vec3 tFar = glm::max(t0, t1);
+
+    float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+    float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, tMax));
+    tEnter = enter;
+    return enter <= exit;
+}
+
+// Moller-Trumbore, either side
+static bool rayTriangle(const RayInfo& ray, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, float& t)
+{
+    glm::vec3 e1 = b - a;
+    glm::vec3 e2 = c - a;
+    glm::vec3 p = glm::cross(ray.dir, e2);
+    float det = glm::dot(e1, p);
+    if (fabsf(det) < 1e-20f)
+        return false;
+
+    float invDet = 1.0f / det;
+    glm::vec3 s = ray.origin - a;
+    float u = glm::dot(s, p) * invDet;
+    if (u < 0.0f || u > 1.0f)
+        return false;
+
+    glm::vec3 q = glm::cross(s, e1);
+    float v = glm::dot(ray.dir, q) * invDet;
+    if (v < 0.0f || u + v > 1.0f)
+        return false;
+
+    t = glm::dot(e2, q) * invDet;
+    return t >= 0.0f;
+}
+
+// The two triangles of quad (qx, qz), split the same way as generateTerrain's indices
+static bool rayQuad(const Heightfield& hf, const RayInfo& ray, int qx, int qz, float tMax, HeightfieldHit& hit)
+{
+    float x0 = hf.origin.x + qx * hf.spacing;
+    float z0 = hf.origin.y + qz * hf.spacing;
+    float x1 = x0 + hf.spacing;
+    float z1 = z0 + hf.spacing;
+
+    float h00 = heightAt(hf, qx, qz);
+    float h10 = heightAt(hf, qx + 1, qz);
+    float h01 = heightAt(hf, qx, qz + 1);
+    float h11 = heightAt(hf, qx + 1, qz + 1);
+
+    // Cheap reject on the quad's own height range first
+    float tEnter;
+    glm::vec3 lo(x0, std::min(std::min(h00, h10), std::min(h01, h11)), z0);
+    glm::vec3 hi(x1, std::max(std::max(h00, h10), std::max(h01, h11)), z1);
+    if (!rayBox(ray, lo, hi, tMax, tEnter))
+        return false;
+
+    glm::vec3 p00(x0, h00, z0);
+    glm::vec3 p10(x1, h10, z0);
+    glm::vec3 p01(x0, h01, z1);
+    glm::vec3 p11(x1, h11, z1);
+
+    bool found = false;
+    float best = tMax;
+    float t;
+    if (rayTriangle(ray, p00, p01, p10, t) && t <= best)
+    {
+        best = t;
+        hit.normal = glm::cross(p01 - p00, p10 - p00);
+        found = true;
+    }
+    if (rayTriangle(ray, p10, p01, p11, t) && t <= best)
+    {
+        best = t;
+        hit.normal = glm::cross(p01 - p10, p11 - p10);
+        found = true;
+    }
+
+    if (found)
+    {
+        hit.hit = true;
+        hit.t = best;
+        hit.position = ray.origin + ray.dir * best;
+        hit.normal = glm::normalize(hit.normal);
+    }
+    return found;
+}
+
+bool raycastHeightfield(const Heightfield& hf, const HeightfieldRay& ray, HeightfieldHit& hit)
+{
+    hit.hit = false;
+    if (hf.levels.empty())
+        return false;
+
+    RayInfo info = makeRayInfo(ray);
+
+    // Children are visited nearest first: a ray moving +x meets the low-x half before the
+    // high-x half. Cells along a ray have disjoint t ranges, so the first hit is the closest
+    int nearX = (ray.dir.x >= 0.0f) ? 0 : 1;
+    int nearZ = (ray.dir.z >= 0.0f) ? 0 : 1;
+    const int order[4][2] = {
+        { nearX, nearZ }, { 1 - nearX, nearZ }, { nearX, 1 - nearZ }, { 1 - nearX, 1 - nearZ }
+    };
+
+    struct Node
+    {
+        int level;
+        int x;
+        int z;
+    };
+    Node stack[64];
+    int top = 0;
+    stack[top++] = { (int)hf.levels.size() - 1, 0, 0 };
+
+    while (top > 0)
+    {
+        Node node = stack[--top];
+        const HeightfieldLevel& level = hf.levels[node.level];
+        const HeightRange& range = level.ranges[(size_t)node.z * level.dim + node.x];
+
+        int quads = 2 << node.level;
+        int qx0 = node.x * quads;
+        int qz0 = node.z * quads;
+        int qx1 = std::min(qx0 + quads, hf.size);
+        int qz1 = std::min(qz0 + quads, hf.size);
+
+        float tEnter;
+        glm::vec3 lo(hf.origin.x + qx0 * hf.spacing, range.lo, hf.origin.y + qz0 * hf.spacing);
+        glm::vec3 hi(hf.origin.x + qx1 * hf.spacing, range.hi, hf.origin.y + qz1 * hf.spacing);
+        if (!rayBox(info, lo, hi, ray.maxT, tEnter))
+            continue;
+
+        if (node.level > 0)
+        {
+            // Push far to near so the nearest child is popped next
+            int childDim = hf.levels[node.level - 1].dim;
+            for (int i = 3; i >= 0; --i)
+            {
+                int cx = node.x * 2 + order[i][0];
+                int cz = node.z * 2 + order[i][1];
+                if (cx < childDim && cz < childDim)
+                    stack[top++] = { node.level - 1, cx, cz };
+            }
+        }
+        else
+        {
+            for (int i = 0; i < 4; ++i)
+            {
+                int qx = qx0 + order[i][0];
+                int qz = qz0 + order[i][1];
+                if (qx < qx1 && qz < qz1 && rayQuad(hf, info, qx, qz, ray.maxT, hit))
+                    return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void raycastHeightfieldBatch(const Heightfield& hf, const HeightfieldRay* rays, HeightfieldHit* hits, int count, JobSystem* jobs)
+{
+    // Blocks of rays, so threads don't fight over the chunk counter
+    parallelFor(jobs, count, 1024, [&](int begin, int end)
+        {
+            for (int i = begin; i < end; ++i)
+                raycastHeightfield(hf, rays[i], hits[i]);
+        });
+}
+
+bool raycastHeightfieldLinear(const Heightfield& hf, const HeightfieldRay& ray, HeightfieldHit& hit)
+{
+    hit.hit = false;
+    if (hf.size <= 0)
+        return false;
+
+    RayInfo info = makeRayInfo(ray);
+
+    // Clip to the field's footprint, any height
+    float extent = hf.size * hf.spacing;
+    glm::vec3 lo(hf.origin.x, -1e30f, hf.origin.y);
+    glm::vec3 hi(hf.origin.x + extent, 1e30f, hf.origin.y + extent);
+    float tEnter;
+    if (!rayBox(info, lo, hi, ray.maxT, tEnter))
+        return false;
+
+    glm::vec3 tFar = glm::max((lo - info.origin) * info.invDir, (hi - info.origin) * info.invDir);
+    float tExit = std::min(std::min(tFar.x, tFar.z), ray.maxT);
+
+    // 2D DDA over the quads (Amanatides & Woo)
+    glm::vec3 start = info.origin + info.dir * tEnter;
+    int qx = std::min(std::max((int)floorf((start.x - hf.origin.x) / hf.spacing), 0), hf.size - 1);
+    int qz = std::min(std::max((int)floorf((start.z - hf.origin.y) / hf.spacing), 0), hf.size - 1);
+
+    int stepX = (ray.dir.x >= 0.0f) ? 1 : -1;
+    int stepZ = (ray.dir.z >= 0.0f) ? 1 : -1;
+    float nextX = hf.origin.x + (qx + (stepX > 0 ? 1 : 0)) * hf.spacing;
+    float nextZ = hf.origin.y + (qz + (stepZ > 0 ? 1 : 0)) * hf.spacing;
+    float tMaxX = (nextX - info.origin.x) * info.invDir.x;
+    float tMaxZ = (nextZ - info.origin.z) * info.invDir.z;
+    float tDeltaX = hf.spacing * fabsf(info.invDir.x);
+    float tDeltaZ = hf.spacing * fabsf(info.invDir.z);
+
+    for (;;)
+    {
+        if (rayQuad(hf, info, qx, qz, ray.maxT, hit))
+            return true;
+
+        if (tMaxX < tMaxZ)
+        {
+            if (tMaxX > tExit)
+                return false;
+            qx += stepX;
+            tMaxX += tDeltaX;
+        }
+        else
+        {
+            if (tMaxZ > tExit)
+                return false;
+            qz += stepZ;
+            tMaxZ += tDeltaZ;
+        }
+
+        if (qx < 0 || qz < 0 || qx >= hf.size || qz >= hf.size)
+            return false;
+    }
+}
+
+// Benchmark
+void runHeightfieldBenchmark(float (*sample)(float, float))
+{
+    using Clock = std::chrono::steady_clock;
+
+    const int SIZE = 4096;
+    const int RAYS = 1 << 20;
+    const int LINEAR_RAYS = 1 << 14;    // the linear walk is far slower on long rays
+    JobSystem jobs;
+    initJobSystem(jobs, -1);
+    int threads = jobThreadCount(jobs);
+
+    auto t0 = Clock::now();
+    Heightfield hf;
+    buildHeightfield(hf, SIZE, 1.0f, sample);
+    double buildMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+
+    size_t pyramidBytes = 0;
+    for (const HeightfieldLevel& level : hf.levels)
+        pyramidBytes += level.ranges.size() * sizeof(HeightRange);
+    std::ios_base::fmtflags flags = std::cout.flags();
+    std::streamsize precision = std::cout.precision();
+    std::cout << std::fixed;
+
+    std::cout << "Heightfield ray benchmark: " << SIZE << "^2 quads, built in " << std::setprecision(0) << buildMs
+        << " ms, heights " << std::setprecision(1) << hf.heights.size() * sizeof(float) / (1024.0 * 1024.0)
+        << " MB + pyramid " << pyramidBytes / (1024.0 * 1024.0) << " MB (" << hf.levels.size() << " levels)\n";
+    std::cout << std::left << std::setw(12) << "rays" << std::right << std::setw(11) << "hit %" << std::setw(15) << "pyramid Mr/s"
+        << std::setw(15) << "x threads Mr/s" << std::setw(15) << "linear Mr/s" << std::setw(11) << "mismatch" << "\n";
+
+    std::mt19937 rng(4242u);
+    float half = 0.5f * SIZE * hf.spacing;
+    std::uniform_real_distribution<float> distXZ(-half * 0.95f, half * 0.95f);
+    std::uniform_real_distribution<float> distYaw(0.0f, 6.2831853f);
+
+    for (int set = 0; set < 2; ++set)
+    {
+        // 0: eye-height view rays, mostly grazing (long walks); 1: steep rays from 50 m up
+        std::uniform_real_distribution<float> distPitch(set == 0 ? -0.5f : -1.0f, set == 0 ? 0.05f : -0.7f);
+        std::vector<HeightfieldRay> rays((size_t)RAYS);
+        for (HeightfieldRay& ray : rays)
+        {
+            float x = distXZ(rng);
+            float z = distXZ(rng);
+            float yaw = distYaw(rng);
+            float sinPitch = distPitch(rng);
+            float cosPitch = sqrtf(1.0f - sinPitch * sinPitch);
+            ray.origin = glm::vec3(x, sample(x, z) + (set == 0 ? 1.7f : 50.0f), z);
+            ray.dir = glm::vec3(cosf(yaw) * cosPitch, sinPitch, sinf(yaw) * cosPitch);
+        }
+
+        std::vector<HeightfieldHit> hits((size_t)RAYS);
+        t0 = Clock::now();
+        raycastHeightfieldBatch(hf, rays.data(), hits.data(), RAYS, nullptr);
+        double singleS = std::chrono::duration<double>(Clock::now() - t0).count();
+
+        t0 = Clock::now();
+        raycastHeightfieldBatch(hf, rays.data(), hits.data(), RAYS, &jobs);
+        double multiS = std::chrono::duration<double>(Clock::now() - t0).count();
+
+        int hitCount = 0;
+        for (const HeightfieldHit& h : hits)
+            hitCount += h.hit ? 1 : 0;
+
+        int mismatches = 0;
+        t0 = Clock::now();
+        for (int i = 0; i < LINEAR_RAYS; ++i)
+        {
+            HeightfieldHit ref;
+            raycastHeightfieldLinear(hf, rays[(size_t)i], ref);
+            const HeightfieldHit& h = hits[(size_t)i];
+            if (ref.hit != h.hit || (ref.hit && fabsf(ref.t - h.t) > 1e-3f * std::max(ref.t, 1.0f)))
+                ++mismatches;
+        }
+        double linearS = std::chrono::duration<double>(Clock::now() - t0).count();
+
+        std::ostringstream threadLabel;
+        threadLabel << std::fixed << std::setprecision(2) << RAYS / multiS * 1e-6 << " (" << threads << ")";
+        std::cout << std::left << std::setw(12) << (set == 0 ? "eye-height" : "steep") << std::right
+            << std::setprecision(1) << std::setw(11) << 100.0 * hitCount / RAYS
+            << std::setprecision(2) << std::setw(15) << RAYS / singleS * 1e-6 << std::setw(15) << threadLabel.str()
+            << std::setprecision(3) << std::setw(15) << LINEAR_RAYS / linearS * 1e-6
+            << std::setw(8) << mismatches << "/" << LINEAR_RAYS << "\n";
+    }
+
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+
+    destroyJobSystem(jobs);
+}
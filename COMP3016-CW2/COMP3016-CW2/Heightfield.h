@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "JobSystem.h"
+
+// Ray casting against the terrain heightfield
+// Heights are stored on the same grid the terrain mesh is built from, and each
+// quad is split into the same two triangles, so hits land exactly on the
+// rendered surface. A min/max pyramid over the heights (level k holding the
+// range of 2^(k+1) x 2^(k+1) quads) lets a ray skip any block it passes over or
+// under; blocks it does cross are visited nearest first, so the first triangle
+// hit is the closest one.
+
+struct HeightRange
+{
+    float lo = 0.0f;
+    float hi = 0.0f;
+};
+
+struct HeightfieldLevel
+{
+    int dim = 0;                        // cells per side
+    std::vector<HeightRange> ranges;    // dim * dim, row-major in z
+};
+
+struct Heightfield
+{
+    int size = 0;                       // quads per side
+    float spacing = 1.0f;
+    glm::vec2 origin{ 0.0f };           // world XZ of height sample (0, 0)
+    std::vector<float> heights;         // (size + 1)^2, row-major in z
+
+    // levels[0] covers 2x2 quads per cell; the last level is a single cell.
+    // Single quads aren't stored, their range comes from the four corner heights
+    std::vector<HeightfieldLevel> levels;
+};
+
+struct HeightfieldRay
+{
+    glm::vec3 origin{ 0.0f };
+    glm::vec3 dir{ 0.0f, -1.0f, 0.0f }; // need not be normalised; t is in units of dir
+    float maxT = 1e30f;
+};
+
+struct HeightfieldHit
+{
+    bool hit = false;
+    float t = 0.0f;
+    glm::vec3 position{ 0.0f };
+    glm::vec3 normal{ 0.0f, 1.0f, 0.0f };
+};
+
+// Samples sample(worldX, worldZ) on the terrain grid (size quads of spacing, centred
+// on the origin like generateTerrain) and builds the pyramid
+void buildHeightfield(Heightfield& hf, int size, float spacing, float (*sample)(float, float));
+
+bool raycastHeightfield(const Heightfield& hf, const HeightfieldRay& ray, HeightfieldHit& hit);
+
+// Spreads the rays over jobs (null = all on the caller), caller included
+void raycastHeightfieldBatch(const Heightfield& hf, const HeightfieldRay* rays, HeightfieldHit* hits, int count, JobSystem* jobs);
+
+// Walks every quad under the ray, no pyramid; reference for the benchmark
+bool raycastHeightfieldLinear(const Heightfield& hf, const HeightfieldRay& ray, HeightfieldHit& hit);
+
+// Rays per second on a 4096^2 heightfield of sample(), pyramid vs linear walk
+void runHeightfieldBenchmark(float (*sample)(float, float));
@@ -0,0 +1,310 @@
+#include "JobSystem.h"
+#include "StartupTrace.h"
+
+#include <algorithm>
+#include <cstdio>
+
+// Which system (if any) the calling thread belongs to, and its deque
+static thread_local JobSystem* tJobSystem = nullptr;
+static thread_local int tThreadIndex = -1;
+static thread_local uint32_t tStealSeed = 0;
+
+static int currentThread(const JobSystem& js)
+{
+    return (tJobSystem == &js) ? tThreadIndex : -1;
+}
+
+static void wakeWorker(JobSystem& js)
+{
+    // Sleepers bump sleeping before re-checking queued, so one side always sees the other
+    if (js.sleeping.load() == 0)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(js.sleepMutex);
+    }
+    js.wake.notify_one();
+}
+
+static void runJob(JobSystem& js, Job* job);
+
+// Hands a job whose dependencies are done to whoever may run it
+static void makeRunnable(JobSystem& js, Job* job)
+{
+    if (job->flags & JOB_MAIN_THREAD)
+    {
+        // The main thread drains this while it waits, so a full queue only spins briefly
+        while (!js.mainThread.tryPush(job))
+        {
+            if (currentThread(js) == 0)
+            {
+                runJob(js, job);
+                return;
+            }
+            std::this_thread::yield();
+        }
+        return;
+    }
+
+    int self = currentThread(js);
+    js.queued.fetch_add(1);
+
+    bool pushed;
+    if (job->flags & JOB_BACKGROUND)
+        pushed = js.background.tryPush(job);
+    else if (self >= 0)
+        pushed = js.deques[self]->push(job);
+    else
+        pushed = js.injected.tryPush(job);
+
+    if (!pushed)
+    {
+        // Out of room: run it here rather than drop it
+        js.queued.fetch_sub(1);
+        runJob(js, job);
+        return;
+    }
+    wakeWorker(js);
+}
+
+static void finishJob(JobSystem& js, JobCounter* counter)
+{
+    if (!counter)
+        return;
+
+    // Decrement under the lock: a waiter that sees zero then takes the lock itself,
+    // so it can't free the counter while this is still touching it
+    std::vector<Job*> released;
+    {
+        std::lock_guard<std::mutex> lock(counter->lock);
+        if (counter->pending.fetch_sub(1) == 1)
+            released.swap(counter->dependents);
+    }
+    for (Job* job : released)
+        makeRunnable(js, job);
+}
+
+// Jobs are heap allocated at submit and freed once run; there are only a handful per frame stage
+static void runJob(JobSystem& js, Job* job)
+{
+    JobCounter* counter = job->counter;
+    job->fn(job->data, job->index);
+    delete job;
+    finishJob(js, counter);
+}
+
+// Own deque first (newest, cache-warm), then outside submissions, then the other threads' oldest work
+static Job* findJob(JobSystem& js, int self, bool allowBackground)
+{
+    Job* job = nullptr;
+    if (self >= 0 && js.deques[self]->pop(job))
+    {
+        js.queued.fetch_sub(1);
+        return job;
+    }
+    if (js.injected.tryPop(job))
+    {
+        js.queued.fetch_sub(1);
+        return job;
+    }
+
+    int threads = (int)js.deques.size();
+    tStealSeed = tStealSeed * 1664525u + 1013904223u;
+    int start = (int)((tStealSeed >> 16) % (uint32_t)threads);
+    for (int i = 0; i < threads; ++i)
+    {
+        int victim = (start + i) % threads;
+        if (victim != self && js.deques[victim]->steal(job))
+        {
+            js.queued.fetch_sub(1);
+            return job;
+        }
+    }
+
+    if (allowBackground && js.background.tryPop(job))
+    {
+        js.queued.fetch_sub(1);
+        return job;
+    }
+    return nullptr;
+}
+
+static void workerMain(JobSystem* js, int index)
+{
+    static const char* names[] = { "job worker 1", "job worker 2", "job worker 3", "job worker 4",
+        "job worker 5", "job worker 6", "job worker 7", "job worker 8" };
+    setTraceThreadName(index <= 8 ? names[index - 1] : "job worker");
+
+    tJobSystem = js;
+    tThreadIndex = index;
+    tStealSeed = 0x9E3779B9u * (uint32_t)index;
+
+    int idle = 0;
+    for (;;)
+    {
+        if (Job* job = findJob(*js, index, true))
+        {
+            runJob(*js, job);
+            idle = 0;
+            continue;
+        }
+
+        // Spin a little before sleeping; work tends to arrive in bursts (one per frame stage)
+        if (++idle < 64)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(js->sleepMutex);
+        js->sleeping.fetch_add(1);
+        js->wake.wait(lock, [js]
+            {
+                return js->quit.load() || js->queued.load() > 0;
+            });
+        js->sleeping.fetch_sub(1);
+        if (js->quit.load())
+            return;
+        idle = 0;
+    }
+}
+
+void initJobSystem(JobSystem& js, int workerCount)
+{
+    if (workerCount < 0)
+    {
+        int cores = (int)std::thread::hardware_concurrency();
+        workerCount = std::max(cores - 1, 1);     // background jobs only run on workers
+    }
+
+    js.deques.clear();
+    for (int i = 0; i <= workerCount; ++i)
+        js.deques.emplace_back(new WorkStealingDeque<Job*, JobSystem::DEQUE_CAPACITY>());
+    js.quit.store(false);
+
+    tJobSystem = &js;
+    tThreadIndex = 0;
+    tStealSeed = 0x9E3779B9u;
+
+    js.workers.reserve(workerCount);
+    for (int i = 1; i <= workerCount; ++i)
+        js.workers.emplace_back(workerMain, &js, i);
+}
+
+void destroyJobSystem(JobSystem& js)
+{
+    {
+        std::lock_guard<std::mutex> lock(js.sleepMutex);
+        js.quit.store(true);
+    }
+    js.wake.notify_all();
+
+    for (std::thread& t : js.workers)
+        t.join();
+    js.workers.clear();
+
+    // Anything still queued is dropped (jobs parked on counters are the caller's problem)
+    Job* job = nullptr;
+    for (auto& deque : js.deques)
+        while (deque->pop(job))
+            delete job;
+    while (js.injected.tryPop(job) || js.background.tryPop(job) || js.mainThread.tryPop(job))
+        delete job;
+    js.queued.store(0);
+
+    if (tJobSystem == &js)
+    {
+        tJobSystem = nullptr;
+        tThreadIndex = -1;
+    }
+}
+
+int jobThreadCount(const JobSystem& js)
+{
+    return (int)js.workers.size() + 1;
+}
+
+void submitJob(JobSystem& js, JobFn fn, void* data, int index, JobCounter* counter, JobCounter* after, int flags)
+{
+    Job* job = new Job();
+    job->fn = fn;
+    job->data = data;
+    job->index = index;
+    job->flags = flags;
+    job->counter = counter;
+    if (counter)
+        counter->pending.fetch_add(1);
+
+    // Park it on the dependency; the lock orders this against the release in finishJob
+    if (after)
+    {
+        std::lock_guard<std::mutex> lock(after->lock);
+        if (after->pending.load() > 0)
+        {
+            after->dependents.push_back(job);
+            return;
+        }
+    }
+    makeRunnable(js, job);
+}
+
+void waitForCounter(JobSystem& js, JobCounter& counter)
+{
+    int self = currentThread(js);
+
+    // Background work is left to the workers, unless there are none
+    bool allowBackground = js.workers.empty();
+
+    while (counter.pending.load() > 0)
+    {
+        Job* job = nullptr;
+        if (self == 0 && js.mainThread.tryPop(job))
+        {
+            runJob(js, job);
+            continue;
+        }
+
+        job = findJob(js, self, allowBackground);
+        if (job)
+            runJob(js, job);
+        else
+            std::this_thread::yield();
+    }
+
+    // The last finisher may still hold the lock; the counter must outlive that
+    std::lock_guard<std::mutex> lock(counter.lock);
+}
+
+// Parallel for
+static void parallelForJob(void* data, int)
+{
+    ParallelFor& work = *(ParallelFor*)data;
+    for (;;)
+    {
+        int chunk = work.nextChunk.fetch_add(1, std::memory_order_relaxed);
+        if (chunk >= work.chunks)
+            return;
+        int begin = chunk * work.grain;
+        work.body(work.context, begin, std::min(begin + work.grain, work.count));
+    }
+}
+
+void runParallelFor(JobSystem* js, ParallelFor& work)
+{
+    if (work.count <= 0)
+        return;
+
+    work.grain = std::max(work.grain, 1);
+    work.chunks = (work.count + work.grain - 1) / work.grain;
+    int helpers = js ? std::min(work.chunks, jobThreadCount(*js)) - 1 : 0;
+    if (helpers <= 0)
+    {
+        work.body(work.context, 0, work.count);
+        return;
+    }
+
+    JobCounter done;
+    for (int i = 0; i < helpers; ++i)
+        submitJob(*js, parallelForJob, &work, 0, &done);
+    parallelForJob(&work, 0);
+    waitForCounter(*js, done);
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "LockFreeQueue.h"
+#include "WorkStealingDeque.h"
+
+// Work-stealing job system
+// Every participating thread (the one that created the system is thread 0, the
+// workers are 1..N) owns a Chase-Lev deque: jobs spawned on a thread go to the
+// bottom of its own deque, and idle threads steal from the top of the others.
+// Threads outside the system submit through a shared injection queue.
+//
+// Jobs report to a JobCounter; waitForCounter runs other jobs while it waits,
+// so waiting from inside a job (nested parallelFor) never blocks a core. A job
+// submitted "after" a counter is parked on it and only becomes runnable when
+// the counter drains, which is how job graphs are expressed.
+//
+// Two kinds of job never go to the deques:
+//  - JOB_MAIN_THREAD (GL calls, anything with thread affinity) only runs on
+//    thread 0, and only while it is inside waitForCounter.
+//  - JOB_BACKGROUND (file I/O, decodes) is only picked up by workers with
+//    nothing else to do, never by a thread helping out in waitForCounter, so
+//    a frame waiting on culling can't get stuck behind a texture decode.
+
+typedef void (*JobFn)(void* data, int index);
+
+enum JobFlags
+{
+    JOB_MAIN_THREAD = 1,
+    JOB_BACKGROUND = 2
+};
+
+struct JobCounter;
+
+struct Job
+{
+    JobFn fn = nullptr;
+    void* data = nullptr;
+    int index = 0;
+    int flags = 0;
+    JobCounter* counter = nullptr;      // decremented when the job finishes
+};
+
+struct JobCounter
+{
+    std::atomic<int> pending{ 0 };
+    std::mutex lock;
+    std::vector<Job*> dependents;       // released when pending reaches zero
+
+    JobCounter() = default;
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+};
+
+struct JobSystem
+{
+    static const size_t DEQUE_CAPACITY = 1024;
+
+    std::vector<std::unique_ptr<WorkStealingDeque<Job*, DEQUE_CAPACITY>>> deques;   // by thread
+    LockFreeQueue<Job*, 1024> injected;     // from threads outside the system
+    LockFreeQueue<Job*, 1024> background;
+    LockFreeQueue<Job*, 256> mainThread;
+
+    std::vector<std::thread> workers;
+    std::atomic<int> queued{ 0 };           // runnable jobs a worker could take
+    std::atomic<int> sleeping{ 0 };
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<bool> quit{ false };
+};
+
+// workerCount < 0 picks one per core, leaving one for the calling thread, and never fewer than one
+// 0 runs everything on the caller, background jobs included, but only inside waitForCounter
+// The calling thread becomes thread 0 (the main thread for JOB_MAIN_THREAD jobs)
+void initJobSystem(JobSystem& js, int workerCount);
+
+// Joins the workers; jobs that haven't run are dropped, so wait on what matters first
+void destroyJobSystem(JobSystem& js);
+
+// Workers plus the main thread
+int jobThreadCount(const JobSystem& js);
+
+// Any thread. Runs fn(data, index), counting it on counter (may be null); with after it waits for that counter
+void submitJob(JobSystem& js, JobFn fn, void* data, int index, JobCounter* counter,
+    JobCounter* after = nullptr, int flags = 0);
+
+// Runs jobs until the counter drains; main-thread jobs only run if called on thread 0
+void waitForCounter(JobSystem& js, JobCounter& counter);
+
+// Parallel for
+// The range is cut into chunks of grain items; up to one job per thread pulls
+// chunks off a shared index until none are left, so uneven chunks balance out
+// without one job per chunk. The caller works on it too and returns when it's done.
+struct ParallelFor
+{
+    void (*body)(void* context, int begin, int end) = nullptr;
+    void* context = nullptr;
+    int count = 0;
+    int grain = 1;
+    int chunks = 0;
+    std::atomic<int> nextChunk{ 0 };
+};
+
+void runParallelFor(JobSystem* js, ParallelFor& work);
+
+// body(begin, end) over [0, count); js may be null, which runs it all on the caller
+template <typename F>
+void parallelFor(JobSystem* js, int count, int grain, F&& body)
+{
+    typedef typename std::remove_reference<F>::type Body;
+
+    ParallelFor work;
+    work.body = [](void* context, int begin, int end) { (*(Body*)context)(begin, end); };
+    work.context = (void*)&body;
+    work.count = count;
+    work.grain = grain;
+    runParallelFor(js, work);
+}
@@ -0,0 +1,121 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+bool openMappedFile(MappedFile& file, const char* path)
+{
+    closeMappedFile(file);
+
+    HANDLE fh = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (fh == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(fh, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(fh);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(fh, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping)
+    {
+        CloseHandle(fh);
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view)
+    {
+        CloseHandle(mapping);
+        CloseHandle(fh);
+        return false;
+    }
+
+    file.data = (const unsigned char*)view;
+    file.size = (size_t)size.QuadPart;
+    file.fileHandle = fh;
+    file.mappingHandle = mapping;
+    return true;
+}
+
+void closeMappedFile(MappedFile& file)
+{
+    if (file.borrowed)
+    {
+        file = MappedFile();
+        return;
+    }
+
+    if (file.data) UnmapViewOfFile(file.data);
+    if (file.mappingHandle) CloseHandle((HANDLE)file.mappingHandle);
+    if (file.fileHandle) CloseHandle((HANDLE)file.fileHandle);
+
+    file.data = nullptr;
+    file.size = 0;
+    file.fileHandle = nullptr;
+    file.mappingHandle = nullptr;
+}
+
+#else
+
+bool openMappedFile(MappedFile& file, const char* path)
+{
+    closeMappedFile(file);
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    void* view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (view == MAP_FAILED)
+    {
+        close(fd);
+        return false;
+    }
+
+    // Whole file is about to be uploaded, so ask for it to be read ahead
+    madvise(view, (size_t)st.st_size, MADV_WILLNEED);
+
+    file.data = (const unsigned char*)view;
+    file.size = (size_t)st.st_size;
+    file.fd = fd;
+    return true;
+}
+
+void closeMappedFile(MappedFile& file)
+{
+    if (file.borrowed)
+    {
+        file = MappedFile();
+        return;
+    }
+
+    if (file.data) munmap((void*)file.data, file.size);
+    if (file.fd >= 0) close(file.fd);
+
+    file.data = nullptr;
+    file.size = 0;
+    file.fd = -1;
+}
+
+#endif
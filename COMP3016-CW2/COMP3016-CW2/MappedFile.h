@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+
+// Read-only memory-mapped file (CreateFileMapping on Windows, mmap elsewhere)
+// The mapping stays valid until closeMappedFile, so callers can hand the
+// pointer straight to GL without copying it into a heap buffer first.
+struct MappedFile
+{
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+    bool borrowed = false;      // view into a mapping owned elsewhere (the asset pack), nothing to unmap
+
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#else
+    int fd = -1;
+#endif
+};
+
+bool openMappedFile(MappedFile& file, const char* path);
+void closeMappedFile(MappedFile& file);
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+
+// Baked mesh file (.mesh), written by AssetBaker and memory-mapped by the runtime
+//
+// Layout (all offsets from the start of the file, every block 16-byte aligned):
+//   BakedMeshHeader
+//   BakedSubmesh[submeshCount]
+//   BakedMaterial[materialCount]
+//   vertex blob: vertexCount * BakedVertex, ready for glBufferData
+//   index blob:  indexCount * uint32, already rebased onto the shared vertex blob
+//
+// Everything is little-endian and plain-old-data, so the runtime can point GL
+// straight at the mapped bytes. Bump MESH_FORMAT_VERSION on any layout change
+// (or, as for v2's optimized triangle/vertex order, to force existing bakes to be redone).
+static const char MESH_FORMAT_MAGIC[4] = { 'C', 'W', 'M', 'B' };
+static const uint32_t MESH_FORMAT_VERSION = 2;
+static const uint32_t MESH_FORMAT_ALIGN = 16;
+static const uint32_t MESH_MATERIAL_PATH_MAX = 120;
+
+// Matches the interleaved layout used by the scene shader (location 0/1/2)
+struct BakedVertex
+{
+    float position[3];
+    float normal[3];
+    float uv[2];
+};
+
+struct BakedMeshHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t vertexStride;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t submeshCount;
+    uint32_t materialCount;
+    uint32_t reserved;
+
+    float boundsMin[3];
+    float boundsMax[3];
+
+    uint64_t submeshOffset;
+    uint64_t materialOffset;
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+    uint64_t fileSize;
+};
+
+struct BakedSubmesh
+{
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    uint32_t firstVertex;
+    uint32_t vertexCount;
+    int32_t materialIndex;      // -1 when the source mesh had no material
+    float boundsMin[3];
+    float boundsMax[3];
+    uint32_t reserved[3];
+};
+
+// Texture paths are stored relative to the .mesh file's directory
+struct BakedMaterial
+{
+    char diffusePath[MESH_MATERIAL_PATH_MAX];
+    float diffuseColor[4];
+    float reserved[4];
+};
+
+static_assert(sizeof(BakedVertex) == 32, "BakedVertex layout changed");
+static_assert(sizeof(BakedMeshHeader) == 96, "BakedMeshHeader layout changed");
+static_assert(sizeof(BakedSubmesh) == 56, "BakedSubmesh layout changed");
+static_assert(sizeof(BakedMaterial) == 152, "BakedMaterial layout changed");
+
+inline uint64_t alignMeshOffset(uint64_t offset)
+{
+    return (offset + MESH_FORMAT_ALIGN - 1) & ~(uint64_t)(MESH_FORMAT_ALIGN - 1);
+}
@@ -0,0 +1,203 @@
+#include "Model.h"
+#include "AssetPack.h"
+
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+
+// Path helpers for relative textures
+static std::string getDirectory(const std::string& filepath)
+{
+    size_t slash = filepath.find_last_of("/\\");
+    if (slash == std::string::npos) return ".";
+    return filepath.substr(0, slash);
+}
+
+static std::string joinPath(const std::string& a, const std::string& b)
+{
+    if (a.empty()) return b;
+    char last = a.back();
+    if (last == '/' || last == '\\') return a + b;
+    return a + "/" + b;
+}
+
+static bool blockInFile(uint64_t offset, uint64_t count, uint64_t stride, size_t fileSize)
+{
+    return offset <= fileSize && count <= (fileSize - offset) / stride;
+}
+
+// An index past the vertex blob would have the GPU read outside the buffer
+static bool indicesInRange(const uint32_t* indices, uint32_t count, uint32_t vertexCount)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (indices[i] >= vertexCount)
+            return false;
+    }
+    return true;
+}
+
+// Loads a .mesh produced by AssetBaker: the file is mapped and the only
+// per-file work is validating the tables and the indices, the blobs go to GL untouched
+bool loadModelData(ModelData& data, const std::string& path)
+{
+    if (!openAssetFile(data.file, path.c_str()))
+    {
+        std::cerr << "Failed to open baked mesh: " << path << " (run AssetBaker)\n";
+        return false;
+    }
+
+    const MappedFile& file = data.file;
+    const BakedMeshHeader* hdr = (const BakedMeshHeader*)file.data;
+    bool ok = file.size >= sizeof(BakedMeshHeader) &&
+        memcmp(hdr->magic, MESH_FORMAT_MAGIC, sizeof(hdr->magic)) == 0 &&
+        hdr->version == MESH_FORMAT_VERSION &&
+        hdr->vertexStride == sizeof(BakedVertex) &&
+        hdr->fileSize == file.size &&
+        blockInFile(hdr->submeshOffset, hdr->submeshCount, sizeof(BakedSubmesh), file.size) &&
+        blockInFile(hdr->materialOffset, hdr->materialCount, sizeof(BakedMaterial), file.size) &&
+        blockInFile(hdr->vertexOffset, hdr->vertexCount, sizeof(BakedVertex), file.size) &&
+        hdr->indexOffset % alignof(uint32_t) == 0 &&
+        blockInFile(hdr->indexOffset, hdr->indexCount, sizeof(uint32_t), file.size) &&
+        indicesInRange((const uint32_t*)(file.data + hdr->indexOffset), hdr->indexCount, hdr->vertexCount);
+
+    if (!ok)
+    {
+        std::cerr << "Baked mesh is corrupt or from another version: " << path << " (rebake it)\n";
+        freeModelData(data);
+        return false;
+    }
+
+    data.header = hdr;
+    data.submeshes = (const BakedSubmesh*)(file.data + hdr->submeshOffset);
+    data.materials = (const BakedMaterial*)(file.data + hdr->materialOffset);
+    data.directory = getDirectory(path);
+    return true;
+}
+
+std::string submeshTexturePath(const ModelData& data, uint32_t submesh)
+{
+    if (!data.header || submesh >= data.header->submeshCount)
+        return std::string();
+
+    int32_t matIndex = data.submeshes[submesh].materialIndex;
+    if (matIndex < 0 || (uint32_t)matIndex >= data.header->materialCount)
+        return std::string();
+
+    const BakedMaterial& mat = data.materials[matIndex];
+    if (mat.diffusePath[0] == '\0' || !memchr(mat.diffusePath, '\0', MESH_MATERIAL_PATH_MAX))
+        return std::string();
+
+    return joinPath(data.directory, mat.diffusePath);
+}
+
+bool stageModelData(ModelData& data, UploadRing& ring)
+{
+    const BakedMeshHeader* hdr = data.header;
+    if (!hdr)
+        return false;
+
+    size_t vertexBytes = (size_t)hdr->vertexCount * sizeof(BakedVertex);
+    size_t indexBytes = (size_t)hdr->indexCount * sizeof(uint32_t);
+    size_t indexOffset = (size_t)alignMeshOffset(vertexBytes);
+
+    StagingAllocation alloc;
+    if (!stagingAlloc(ring, indexOffset + indexBytes, alloc))
+        return false;
+
+    memcpy(alloc.ptr, data.file.data + hdr->vertexOffset, vertexBytes);
+    memcpy(alloc.ptr + indexOffset, data.file.data + hdr->indexOffset, indexBytes);
+    data.staging = alloc;
+    data.stagedIndexOffset = indexOffset;
+    return true;
+}
+
+bool uploadModel(Model& model, const ModelData& data)
+{
+    const BakedMeshHeader* hdr = data.header;
+    if (!hdr)
+        return false;
+
+    const unsigned char* base = data.file.data;
+    const bool staged = data.staging.ptr != nullptr;
+    const GLsizeiptr vertexBytes = (GLsizeiptr)hdr->vertexCount * sizeof(BakedVertex);
+    const GLsizeiptr indexBytes = (GLsizeiptr)hdr->indexCount * sizeof(uint32_t);
+
+    glGenVertexArrays(1, &model.VAO);
+    glGenBuffers(1, &model.VBO);
+    glGenBuffers(1, &model.EBO);
+
+    glBindVertexArray(model.VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, model.VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertexBytes, staged ? nullptr : base + hdr->vertexOffset, GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, model.EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, staged ? nullptr : base + hdr->indexOffset, GL_STATIC_DRAW);
+
+    if (staged)
+    {
+        // Queued on the GPU, the driver doesn't have to copy anything out of client memory
+        glBindBuffer(GL_COPY_READ_BUFFER, data.staging.buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_ARRAY_BUFFER, (GLintptr)data.staging.offset, 0, vertexBytes);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_ELEMENT_ARRAY_BUFFER, (GLintptr)(data.staging.offset + data.stagedIndexOffset), 0, indexBytes);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    }
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(BakedVertex), (void*)offsetof(BakedVertex, position));
+    glEnableVertexAttribArray(0);
+
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(BakedVertex), (void*)offsetof(BakedVertex, normal));
+    glEnableVertexAttribArray(1);
+
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(BakedVertex), (void*)offsetof(BakedVertex, uv));
+    glEnableVertexAttribArray(2);
+
+    glBindVertexArray(0);
+
+    model.boundsMin = glm::vec3(hdr->boundsMin[0], hdr->boundsMin[1], hdr->boundsMin[2]);
+    model.boundsMax = glm::vec3(hdr->boundsMax[0], hdr->boundsMax[1], hdr->boundsMax[2]);
+
+    model.meshes.resize(hdr->submeshCount);
+    for (uint32_t i = 0; i < hdr->submeshCount; ++i)
+    {
+        const BakedSubmesh& sub = data.submeshes[i];
+        if (sub.firstIndex > hdr->indexCount || sub.indexCount > hdr->indexCount - sub.firstIndex)
+            continue;
+
+        model.meshes[i].indexCount = (GLsizei)sub.indexCount;
+        model.meshes[i].firstIndex = sub.firstIndex;
+    }
+
+    return true;
+}
+
+void freeModelData(ModelData& data)
+{
+    closeMappedFile(data.file);
+    data.header = nullptr;
+    data.submeshes = nullptr;
+    data.materials = nullptr;
+    data.directory.clear();
+    data.staging = StagingAllocation();
+    data.stagedIndexOffset = 0;
+}
+
+void destroyModel(Model& model, TextureRegistry& textures)
+{
+    for (Mesh& m : model.meshes)
+    {
+        releaseTexture(textures, m.diffuseHandle);
+        m.diffuseHandle = INVALID_TEXTURE;
+        m.diffuseTex = 0;
+    }
+    model.meshes.clear();
+
+    if (model.VAO != 0)
+    {
+        glDeleteVertexArrays(1, &model.VAO);
+        glDeleteBuffers(1, &model.VBO);
+        glDeleteBuffers(1, &model.EBO);
+        model.VAO = model.VBO = model.EBO = 0;
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#define NOMINMAX
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+#include "MeshFormat.h"
+#include "TextureRegistry.h"
+#include "UploadRing.h"
+
+// Mesh struct (one submesh, drawn out of its model's shared buffers)
+struct Mesh
+{
+    GLsizei indexCount = 0;
+    GLuint firstIndex = 0;
+    GLuint diffuseTex = 0;
+    TextureHandle diffuseHandle = INVALID_TEXTURE;     // registry reference behind diffuseTex
+};
+
+// Baked model: one VAO/VBO/EBO, submeshes are index ranges inside it
+struct Model
+{
+    GLuint VAO = 0;
+    GLuint VBO = 0;
+    GLuint EBO = 0;
+    std::vector<Mesh> meshes;
+    glm::vec3 boundsMin{ 0.0f };
+    glm::vec3 boundsMax{ 0.0f };
+};
+
+// CPU side of a baked model: the mapped .mesh with its tables validated
+// Filled without touching GL, so it can be produced on a loader thread.
+struct ModelData
+{
+    MappedFile file;
+    const BakedMeshHeader* header = nullptr;
+    const BakedSubmesh* submeshes = nullptr;
+    const BakedMaterial* materials = nullptr;
+    std::string directory;
+
+    // Set by stageModelData: vertex blob then index blob, copied into the upload ring
+    StagingAllocation staging;
+    size_t stagedIndexOffset = 0;
+};
+
+// Every index is checked against the vertex count here, uploads trust the blobs
+bool loadModelData(ModelData& data, const std::string& path);
+
+// Full path of a submesh's diffuse texture, empty if it has none
+std::string submeshTexturePath(const ModelData& data, uint32_t submesh);
+
+// Loader thread: copies the vertex and index blobs into the upload ring (the tables stay mapped)
+// False if the ring is disabled or full, the upload then reads the mapping directly.
+bool stageModelData(ModelData& data, UploadRing& ring);
+
+// GL thread: creates the buffers, textures are left to the caller
+// Staged blobs are copied GPU-side with glCopyBufferSubData, otherwise they come straight from the mapping.
+// Meshes keep the submesh order; invalid submeshes get an empty index range.
+bool uploadModel(Model& model, const ModelData& data);
+
+void freeModelData(ModelData& data);
+
+// Drops the meshes' texture references, textures nothing else uses are freed here
+void destroyModel(Model& model, TextureRegistry& textures);
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Asset pack (.pack), written by AssetBaker --pack and mapped whole by the runtime
+//
+// Layout (offsets from the start of the file, every block PACK_FORMAT_ALIGN aligned):
+//   PackHeader
+//   PackEntry[entryCount], sorted by pathHash so lookups are a binary search
+//   path strings (normalized, not null-terminated), for telling hash collisions apart
+//   file blobs, stored verbatim
+//
+// Blob alignment keeps the baked .mesh tables and DDS levels usable in place.
+// Bump PACK_FORMAT_VERSION on any layout change.
+static const char PACK_FORMAT_MAGIC[4] = { 'C', 'W', 'P', 'K' };
+static const uint32_t PACK_FORMAT_VERSION = 2;
+static const uint32_t PACK_FORMAT_ALIGN = 64;
+
+struct PackHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+    uint64_t entryOffset;
+    uint64_t stringOffset;
+    uint64_t fileSize;
+    uint64_t memberHash;        // hashPackMembers of the keys, so the baker notices a changed file list
+};
+
+struct PackEntry
+{
+    uint64_t pathHash;
+    uint64_t offset;
+    uint64_t size;
+    uint32_t pathOffset;        // relative to stringOffset
+    uint32_t pathLength;
+};
+
+static_assert(sizeof(PackHeader) == 48, "PackHeader layout changed");
+static_assert(sizeof(PackEntry) == 32, "PackEntry layout changed");
+
+inline uint64_t alignPackOffset(uint64_t offset)
+{
+    return (offset + PACK_FORMAT_ALIGN - 1) & ~(uint64_t)(PACK_FORMAT_ALIGN - 1);
+}
+
+// Pack paths are relative, '/' separated and lower case on every platform, with
+// "." and ".." segments resolved, so "assets\\Tree.mesh" finds "assets/tree.mesh"
+inline std::string normalizePackPath(const std::string& path)
+{
+    std::vector<std::string> parts;
+    std::string part;
+    for (size_t i = 0; i <= path.size(); ++i)
+    {
+        char c = (i < path.size()) ? path[i] : '/';
+        if (c == '\\') c = '/';
+        if (c >= 'A' && c <= 'Z') c = (char)(c - 'A' + 'a');
+        if (c != '/')
+        {
+            part += c;
+            continue;
+        }
+
+        if (part == "..")
+        {
+            if (!parts.empty() && parts.back() != "..") parts.pop_back();
+            else parts.push_back(part);
+        }
+        else if (!part.empty() && part != ".")
+        {
+            parts.push_back(part);
+        }
+        part.clear();
+    }
+
+    std::string out;
+    for (size_t i = 0; i < parts.size(); ++i)
+    {
+        if (i > 0) out += '/';
+        out += parts[i];
+    }
+    return out;
+}
+
+// FNV-1a over the normalized path
+inline uint64_t hashPackPath(const std::string& normalized)
+{
+    uint64_t h = 14695981039346656037ull;
+    for (char c : normalized)
+    {
+        h ^= (uint8_t)c;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+// The same set of normalized keys hashes the same whatever order it's listed in
+inline uint64_t hashPackMembers(std::vector<std::string> keys)
+{
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    std::string joined;
+    for (const std::string& key : keys)
+    {
+        joined += key;
+        joined += '\n';
+    }
+    return hashPackPath(joined);
+}
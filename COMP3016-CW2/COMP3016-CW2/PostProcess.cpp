@@ -0,0 +1,761 @@
+#include "PostProcess.h"
+#include "Shader.h"
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// 13-tap downsample (Jimenez, "Next Generation Post Processing in Call of Duty")
+// First level also applies a soft threshold and a Karis average to stop fireflies.
+static const char* downsampleFrag = R"(
+#version 330 core
+in vec2 vUV;
+out vec4 FragColor;
+
+uniform sampler2D uSource;
+uniform vec2 uSrcTexel;
+uniform vec2 uSrcUvScale;   // valid source region / allocated size
+uniform vec2 uSrcUvMax;     // keeps taps inside the valid region
+uniform int uPrefilter;
+uniform float uThreshold;
+
+vec3 prefilter(vec3 c)
+{
+    const float knee = 0.5;
+    float brightness = max(c.r, max(c.g, c.b));
+    float soft = clamp(brightness - uThreshold + knee, 0.0, 2.0 * knee);
+    soft = soft * soft / (4.0 * knee + 1e-5);
+    float contrib = max(soft, brightness - uThreshold) / max(brightness, 1e-5);
+    return c * contrib;
+}
+
+float karisWeight(vec3 c)
+{
+    return 1.0 / (1.0 + dot(c, vec3(0.2126, 0.7152, 0.0722)));
+}
+
+vec3 tap(vec2 offset)
+{
+    return texture(uSource, min(vUV * uSrcUvScale + offset * uSrcTexel, uSrcUvMax)).rgb;
+}
+
+void main()
+{
+    vec3 a = tap(vec2(-2.0,  2.0));
+    vec3 b = tap(vec2( 0.0,  2.0));
+    vec3 c = tap(vec2( 2.0,  2.0));
+    vec3 d = tap(vec2(-2.0,  0.0));
+    vec3 e = tap(vec2( 0.0,  0.0));
+    vec3 f = tap(vec2( 2.0,  0.0));
+    vec3 g = tap(vec2(-2.0, -2.0));
+    vec3 h = tap(vec2( 0.0, -2.0));
+    vec3 i = tap(vec2( 2.0, -2.0));
+    vec3 j = tap(vec2(-1.0,  1.0));
+    vec3 k = tap(vec2( 1.0,  1.0));
+    vec3 l = tap(vec2(-1.0, -1.0));
+    vec3 m = tap(vec2( 1.0, -1.0));
+
+    vec3 result;
+    if (uPrefilter != 0)
+    {
+        // Karis average per 2x2 group
+        vec3 g0 = (j + k + l + m) * 0.25;
+        vec3 g1 = (a + b + d + e) * 0.25;
+        vec3 g2 = (b + c + e + f) * 0.25;
+        vec3 g3 = (d + e + g + h) * 0.25;
+        vec3 g4 = (e + f + h + i) * 0.25;
+        float w0 = karisWeight(g0) * 0.5;
+        float w1 = karisWeight(g1) * 0.125;
+        float w2 = karisWeight(g2) * 0.125;
+        float w3 = karisWeight(g3) * 0.125;
+        float w4 = karisWeight(g4) * 0.125;
+        result = (g0 * w0 + g1 * w1 + g2 * w2 + g3 * w3 + g4 * w4) / (w0 + w1 + w2 + w3 + w4);
+        result = prefilter(result);
+    }
+    else
+    {
+        result  = e * 0.125;
+        result += (a + c + g + i) * 0.03125;
+        result += (b + d + f + h) * 0.0625;
+        result += (j + k + l + m) * 0.125;
+    }
+
+    FragColor = vec4(max(result, vec3(0.0)), 1.0);
+}
+)";
+
+// 3x3 tent upsample, additively blended into the next larger level
+static const char* upsampleFrag = R"(
+#version 330 core
+in vec2 vUV;
+out vec4 FragColor;
+
+uniform sampler2D uSource;
+uniform vec2 uSrcTexel;
+uniform vec2 uSrcUvScale;
+uniform vec2 uSrcUvMax;
+
+vec3 tap(vec2 offset)
+{
+    return texture(uSource, min(vUV * uSrcUvScale + offset * uSrcTexel, uSrcUvMax)).rgb;
+}
+
+void main()
+{
+    vec3 result = tap(vec2(0.0, 0.0)) * 4.0;
+    result += (tap(vec2(-1.0, 0.0)) + tap(vec2(1.0, 0.0)) + tap(vec2(0.0, -1.0)) + tap(vec2(0.0, 1.0))) * 2.0;
+    result += tap(vec2(-1.0, -1.0)) + tap(vec2(1.0, -1.0)) + tap(vec2(-1.0, 1.0)) + tap(vec2(1.0, 1.0));
+    FragColor = vec4(result * (1.0 / 16.0), 1.0);
+}
+)";
+
+// Fused final pass: one read of scene + bloom, one write to the backbuffer
+static const char* compositeFrag = R"(
+#version 330 core
+in vec2 vUV;
+out vec4 FragColor;
+
+uniform sampler2D uScene;
+uniform sampler2D uBloom;
+uniform sampler3D uGradeLut;
+
+uniform vec2 uSceneTexel;
+uniform vec2 uSceneUvScale;
+uniform vec2 uSceneUvMax;
+uniform vec2 uBloomUvScale;
+uniform vec2 uBloomUvMax;
+
+uniform float uExposure;
+uniform float uBloomStrength;
+uniform float uVignette;
+uniform float uLutSize;
+uniform float uSharpness;
+
+// Narkowicz ACES fit
+vec3 tonemapACES(vec3 x)
+{
+    return clamp((x * (2.51 * x + 0.03)) / (x * (2.43 * x + 0.59) + 0.14), 0.0, 1.0);
+}
+
+vec3 sceneTap(vec2 uv)
+{
+    return texture(uScene, min(uv, uSceneUvMax)).rgb;
+}
+
+void main()
+{
+    // Bilinear upscale from the render rectangle plus a clamped cross sharpen
+    vec2 suv = vUV * uSceneUvScale;
+    vec3 c = sceneTap(suv);
+    vec3 n = sceneTap(suv + vec2(0.0, uSceneTexel.y));
+    vec3 s = sceneTap(suv - vec2(0.0, uSceneTexel.y));
+    vec3 e = sceneTap(suv + vec2(uSceneTexel.x, 0.0));
+    vec3 w = sceneTap(suv - vec2(uSceneTexel.x, 0.0));
+
+    vec3 mn = min(c, min(min(n, s), min(e, w)));
+    vec3 mx = max(c, max(max(n, s), max(e, w)));
+    vec3 hdr = clamp(c + uSharpness * (c * 4.0 - (n + s + e + w)) * 0.25, mn, mx);
+
+    hdr += texture(uBloom, min(vUV * uBloomUvScale, uBloomUvMax)).rgb * uBloomStrength;
+
+    vec3 color = tonemapACES(hdr * uExposure);
+    color = pow(color, vec3(1.0 / 2.2));
+
+    // Grade in display space, remap so samples land on texel centres
+    vec3 lutUV = color * ((uLutSize - 1.0) / uLutSize) + 0.5 / uLutSize;
+    color = texture(uGradeLut, lutUV).rgb;
+
+    vec2 d = vUV - 0.5;
+    float vig = 1.0 - uVignette * pow(length(d) * 1.41421, 2.5);
+    color *= vig;
+
+    FragColor = vec4(color, 1.0);
+}
+)";
+
+// Temporal AA resolve (upsamples from the render rectangle to full resolution)
+// Neighbourhood variance clipping in YCoCg on range-compressed colour, 5-tap
+// Catmull-Rom history fetch, and a higher current-frame weight under motion.
+static const char* taaFrag = R"(
+#version 330 core
+in vec2 vUV;
+out vec4 FragColor;
+
+uniform sampler2D uCurrent;
+uniform sampler2D uVelocity;
+uniform sampler2D uHistory;
+
+uniform vec2 uCurTexel;
+uniform vec2 uCurUvScale;
+uniform vec2 uCurUvMax;
+uniform vec2 uJitterUv;
+uniform float uHistoryValid;
+uniform vec2 uOutputSize;
+
+vec3 toYCoCg(vec3 c)
+{
+    return vec3(dot(c, vec3(0.25, 0.5, 0.25)), dot(c, vec3(0.5, 0.0, -0.5)), dot(c, vec3(-0.25, 0.5, -0.25)));
+}
+
+vec3 fromYCoCg(vec3 c)
+{
+    return vec3(c.x + c.y - c.z, c.x + c.z, c.x - c.y - c.z);
+}
+
+// Range compression so bright pixels don't dominate the neighbourhood statistics
+vec3 compressHdr(vec3 c)
+{
+    return c / (1.0 + max(c.r, max(c.g, c.b)));
+}
+
+vec3 uncompressHdr(vec3 c)
+{
+    return c / max(1.0 - max(c.r, max(c.g, c.b)), 1e-4);
+}
+
+vec3 currentTap(vec2 uv)
+{
+    return texture(uCurrent, min(uv, uCurUvMax)).rgb;
+}
+
+vec3 sampleHistory(vec2 uv)
+{
+    vec2 samplePos = uv * uOutputSize;
+    vec2 texPos1 = floor(samplePos - 0.5) + 0.5;
+    vec2 f = samplePos - texPos1;
+
+    vec2 w0 = f * (-0.5 + f * (1.0 - 0.5 * f));
+    vec2 w1 = 1.0 + f * f * (-2.5 + 1.5 * f);
+    vec2 w2 = f * (0.5 + f * (2.0 - 1.5 * f));
+    vec2 w3 = f * f * (-0.5 + 0.5 * f);
+
+    vec2 w12 = w1 + w2;
+    vec2 texPos0 = (texPos1 - 1.0) / uOutputSize;
+    vec2 texPos3 = (texPos1 + 2.0) / uOutputSize;
+    vec2 texPos12 = (texPos1 + w2 / w12) / uOutputSize;
+
+    vec3 result = vec3(0.0);
+    result += texture(uHistory, vec2(texPos12.x, texPos0.y)).rgb * w12.x * w0.y;
+    result += texture(uHistory, vec2(texPos0.x, texPos12.y)).rgb * w0.x * w12.y;
+    result += texture(uHistory, texPos12).rgb * w12.x * w12.y;
+    result += texture(uHistory, vec2(texPos3.x, texPos12.y)).rgb * w3.x * w12.y;
+    result += texture(uHistory, vec2(texPos12.x, texPos3.y)).rgb * w12.x * w3.y;
+
+    float wSum = w12.x * w0.y + w0.x * w12.y + w12.x * w12.y + w3.x * w12.y + w12.x * w3.y;
+    return max(result / wSum, vec3(0.0));
+}
+
+vec3 clipToBox(vec3 c, vec3 boxMin, vec3 boxMax)
+{
+    vec3 center = 0.5 * (boxMin + boxMax);
+    vec3 extent = 0.5 * (boxMax - boxMin) + 1e-5;
+    vec3 r = c - center;
+    vec3 a = abs(r / extent);
+    float m = max(a.x, max(a.y, a.z));
+    return (m > 1.0) ? center + r / m : c;
+}
+
+void main()
+{
+    // Geometry that belongs at vUV was rendered shifted by the jitter
+    vec2 cuv = (vUV + uJitterUv) * uCurUvScale;
+
+    vec3 m1 = vec3(0.0);
+    vec3 m2 = vec3(0.0);
+    vec3 center = vec3(0.0);
+    vec2 velocity = vec2(0.0);
+    float bestSpeed = -1.0;
+
+    for (int y = -1; y <= 1; ++y)
+    {
+        for (int x = -1; x <= 1; ++x)
+        {
+            vec2 uv = cuv + vec2(x, y) * uCurTexel;
+            vec3 c = toYCoCg(compressHdr(currentTap(uv)));
+            m1 += c;
+            m2 += c * c;
+            if (x == 0 && y == 0) center = c;
+
+            // Longest velocity in the neighbourhood keeps moving edges from trailing
+            vec2 v = texture(uVelocity, min(uv, uCurUvMax)).rg;
+            float speed = dot(v, v);
+            if (speed > bestSpeed)
+            {
+                bestSpeed = speed;
+                velocity = v;
+            }
+        }
+    }
+
+    vec2 prevUv = vUV - velocity;
+    bool offscreen = any(lessThan(prevUv, vec2(0.0))) || any(greaterThan(prevUv, vec2(1.0)));
+    if (uHistoryValid < 0.5 || offscreen)
+    {
+        FragColor = vec4(uncompressHdr(fromYCoCg(center)), 1.0);
+        return;
+    }
+
+    vec3 mean = m1 / 9.0;
+    vec3 sigma = sqrt(max(m2 / 9.0 - mean * mean, vec3(0.0)));
+    vec3 boxMin = mean - 1.25 * sigma;
+    vec3 boxMax = mean + 1.25 * sigma;
+
+    vec3 history = toYCoCg(compressHdr(sampleHistory(prevUv)));
+    history = clipToBox(history, boxMin, boxMax);
+
+    float pixelSpeed = length(velocity * uOutputSize);
+    float alpha = mix(0.08, 0.25, clamp(pixelSpeed / 16.0, 0.0, 1.0));
+    vec3 result = mix(history, center, alpha);
+
+    FragColor = vec4(uncompressHdr(fromYCoCg(result)), 1.0);
+}
+)";
+
+static GLuint createColorTarget(GLenum internalFormat, int w, int h)
+{
+    GLuint tex = 0;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, w, h, 0, GL_RGBA, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    return tex;
+}
+
+static GLuint createFramebuffer(GLuint colorTex, GLuint depthRb, const char* label)
+{
+    GLuint fbo = 0;
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTex, 0);
+    if (depthRb)
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthRb);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cerr << label << " framebuffer incomplete\n";
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return fbo;
+}
+
+static void releaseTargets(PostProcess& post)
+{
+    if (post.sceneFBO) glDeleteFramebuffers(1, &post.sceneFBO);
+    if (post.sceneColor) glDeleteTextures(1, &post.sceneColor);
+    if (post.sceneVelocity) glDeleteTextures(1, &post.sceneVelocity);
+    if (post.sceneDepth) glDeleteRenderbuffers(1, &post.sceneDepth);
+    post.sceneFBO = post.sceneColor = post.sceneVelocity = post.sceneDepth = 0;
+
+    for (int i = 0; i < 2; ++i)
+    {
+        if (post.historyFBO[i]) glDeleteFramebuffers(1, &post.historyFBO[i]);
+        if (post.historyTex[i]) glDeleteTextures(1, &post.historyTex[i]);
+        post.historyFBO[i] = post.historyTex[i] = 0;
+    }
+    post.historyValid = false;
+
+    for (int i = 0; i < PostProcess::BLOOM_LEVELS; ++i)
+    {
+        if (post.bloomFBO[i]) glDeleteFramebuffers(1, &post.bloomFBO[i]);
+        if (post.bloomTex[i]) glDeleteTextures(1, &post.bloomTex[i]);
+        post.bloomFBO[i] = post.bloomTex[i] = 0;
+    }
+}
+
+static void createTargets(PostProcess& post)
+{
+    post.sceneColor = createColorTarget(GL_RGBA16F, post.width, post.height);
+
+    glGenRenderbuffers(1, &post.sceneDepth);
+    glBindRenderbuffer(GL_RENDERBUFFER, post.sceneDepth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, post.width, post.height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    post.sceneFBO = createFramebuffer(post.sceneColor, post.sceneDepth, "Scene");
+
+    // Velocity as a second colour attachment of the scene pass
+    post.sceneVelocity = createColorTarget(GL_RG16F, post.width, post.height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, post.sceneFBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, post.sceneVelocity, 0);
+    const GLenum drawBuffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glDrawBuffers(2, drawBuffers);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cerr << "Scene velocity framebuffer incomplete\n";
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    for (int i = 0; i < 2; ++i)
+    {
+        post.historyTex[i] = createColorTarget(GL_RGBA16F, post.width, post.height);
+        post.historyFBO[i] = createFramebuffer(post.historyTex[i], 0, "TAA history");
+    }
+    post.historyValid = false;
+
+    int w = post.width;
+    int h = post.height;
+    for (int i = 0; i < PostProcess::BLOOM_LEVELS; ++i)
+    {
+        w = (w > 1) ? w / 2 : 1;
+        h = (h > 1) ? h / 2 : 1;
+        post.bloomW[i] = w;
+        post.bloomH[i] = h;
+        post.bloomTex[i] = createColorTarget(GL_R11F_G11F_B10F, w, h);
+        post.bloomFBO[i] = createFramebuffer(post.bloomTex[i], 0, "Bloom");
+    }
+}
+
+// Adobe .cube 3D LUT (LUT_3D_SIZE + N^3 rgb rows, red fastest)
+static bool loadCubeLut(const char* path, std::vector<float>& rgb, int& size)
+{
+    FILE* f = fopen(path, "r");
+    if (!f) return false;
+
+    size = 0;
+    rgb.clear();
+
+    char line[256];
+    while (fgets(line, sizeof(line), f))
+    {
+        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') continue;
+
+        int n = 0;
+        if (sscanf(line, "LUT_3D_SIZE %d", &n) == 1)
+        {
+            size = n;
+            rgb.reserve((size_t)n * n * n * 3);
+            continue;
+        }
+
+        float r, g, b;
+        if (size > 0 && sscanf(line, "%f %f %f", &r, &g, &b) == 3)
+        {
+            rgb.push_back(r);
+            rgb.push_back(g);
+            rgb.push_back(b);
+        }
+    }
+    fclose(f);
+
+    return size > 1 && rgb.size() == (size_t)size * size * size * 3;
+}
+
+static void createGradeLut(PostProcess& post, const char* lutPath)
+{
+    std::vector<float> rgb;
+    int size = 0;
+
+    if (!lutPath || !loadCubeLut(lutPath, rgb, size))
+    {
+        // Neutral LUT
+        size = 16;
+        rgb.resize((size_t)size * size * size * 3);
+        for (int b = 0; b < size; ++b)
+            for (int g = 0; g < size; ++g)
+                for (int r = 0; r < size; ++r)
+                {
+                    size_t i = (((size_t)b * size + g) * size + r) * 3;
+                    rgb[i + 0] = r / (float)(size - 1);
+                    rgb[i + 1] = g / (float)(size - 1);
+                    rgb[i + 2] = b / (float)(size - 1);
+                }
+    }
+
+    glGenTextures(1, &post.gradeLut);
+    glBindTexture(GL_TEXTURE_3D, post.gradeLut);
+    glTexImage3D(GL_TEXTURE_3D, 0, GL_RGB16F, size, size, size, 0, GL_RGB, GL_FLOAT, rgb.data());
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_3D, 0);
+
+    post.gradeLutSize = size;
+}
+
+bool initPostProcess(PostProcess& post, int width, int height, const char* lutPath)
+{
+    post.width = (width > 0) ? width : 1;
+    post.height = (height > 0) ? height : 1;
+
+    glGenVertexArrays(1, &post.emptyVAO);
+
+    post.downsampleProgram = createProgram(fullscreenVertSource, downsampleFrag, "Bloom downsample");
+    post.upsampleProgram = createProgram(fullscreenVertSource, upsampleFrag, "Bloom upsample");
+    post.compositeProgram = createProgram(fullscreenVertSource, compositeFrag, "Composite");
+    post.taaProgram = createProgram(fullscreenVertSource, taaFrag, "TAA");
+
+    glUseProgram(post.taaProgram);
+    glUniform1i(glGetUniformLocation(post.taaProgram, "uCurrent"), 0);
+    glUniform1i(glGetUniformLocation(post.taaProgram, "uVelocity"), 1);
+    glUniform1i(glGetUniformLocation(post.taaProgram, "uHistory"), 2);
+    post.taaCurTexelLoc = glGetUniformLocation(post.taaProgram, "uCurTexel");
+    post.taaCurUvScaleLoc = glGetUniformLocation(post.taaProgram, "uCurUvScale");
+    post.taaCurUvMaxLoc = glGetUniformLocation(post.taaProgram, "uCurUvMax");
+    post.taaJitterLoc = glGetUniformLocation(post.taaProgram, "uJitterUv");
+    post.taaHistoryValidLoc = glGetUniformLocation(post.taaProgram, "uHistoryValid");
+    post.taaOutputSizeLoc = glGetUniformLocation(post.taaProgram, "uOutputSize");
+
+    glUseProgram(post.downsampleProgram);
+    glUniform1i(glGetUniformLocation(post.downsampleProgram, "uSource"), 0);
+    post.downSrcTexelLoc = glGetUniformLocation(post.downsampleProgram, "uSrcTexel");
+    post.downSrcUvScaleLoc = glGetUniformLocation(post.downsampleProgram, "uSrcUvScale");
+    post.downSrcUvMaxLoc = glGetUniformLocation(post.downsampleProgram, "uSrcUvMax");
+    post.downPrefilterLoc = glGetUniformLocation(post.downsampleProgram, "uPrefilter");
+    post.downThresholdLoc = glGetUniformLocation(post.downsampleProgram, "uThreshold");
+
+    glUseProgram(post.upsampleProgram);
+    glUniform1i(glGetUniformLocation(post.upsampleProgram, "uSource"), 0);
+    post.upSrcTexelLoc = glGetUniformLocation(post.upsampleProgram, "uSrcTexel");
+    post.upSrcUvScaleLoc = glGetUniformLocation(post.upsampleProgram, "uSrcUvScale");
+    post.upSrcUvMaxLoc = glGetUniformLocation(post.upsampleProgram, "uSrcUvMax");
+
+    glUseProgram(post.compositeProgram);
+    glUniform1i(glGetUniformLocation(post.compositeProgram, "uScene"), 0);
+    glUniform1i(glGetUniformLocation(post.compositeProgram, "uBloom"), 1);
+    glUniform1i(glGetUniformLocation(post.compositeProgram, "uGradeLut"), 2);
+    post.compExposureLoc = glGetUniformLocation(post.compositeProgram, "uExposure");
+    post.compBloomLoc = glGetUniformLocation(post.compositeProgram, "uBloomStrength");
+    post.compVignetteLoc = glGetUniformLocation(post.compositeProgram, "uVignette");
+    post.compLutSizeLoc = glGetUniformLocation(post.compositeProgram, "uLutSize");
+    post.compSceneTexelLoc = glGetUniformLocation(post.compositeProgram, "uSceneTexel");
+    post.compSceneUvScaleLoc = glGetUniformLocation(post.compositeProgram, "uSceneUvScale");
+    post.compSceneUvMaxLoc = glGetUniformLocation(post.compositeProgram, "uSceneUvMax");
+    post.compBloomUvScaleLoc = glGetUniformLocation(post.compositeProgram, "uBloomUvScale");
+    post.compBloomUvMaxLoc = glGetUniformLocation(post.compositeProgram, "uBloomUvMax");
+    post.compSharpnessLoc = glGetUniformLocation(post.compositeProgram, "uSharpness");
+
+    createGradeLut(post, lutPath);
+    createTargets(post);
+    setRenderScale(post, 1.0f);
+    return post.sceneFBO != 0;
+}
+
+void resizePostProcess(PostProcess& post, int width, int height)
+{
+    if (width <= 0 || height <= 0) return;
+    if (width == post.width && height == post.height) return;
+
+    releaseTargets(post);
+    post.width = width;
+    post.height = height;
+    createTargets(post);
+    setRenderScale(post, post.renderScale);
+}
+
+void setRenderScale(PostProcess& post, float scale)
+{
+    scale = (scale < 0.25f) ? 0.25f : ((scale > 1.0f) ? 1.0f : scale);
+    post.renderScale = scale;
+    post.renderWidth = (int)(post.width * scale + 0.5f);
+    post.renderHeight = (int)(post.height * scale + 0.5f);
+    if (post.renderWidth < 1) post.renderWidth = 1;
+    if (post.renderHeight < 1) post.renderHeight = 1;
+
+    int w = post.renderWidth;
+    int h = post.renderHeight;
+    for (int i = 0; i < PostProcess::BLOOM_LEVELS; ++i)
+    {
+        w = (w > 1) ? (w + 1) / 2 : 1;
+        h = (h > 1) ? (h + 1) / 2 : 1;
+        post.bloomValidW[i] = (w < post.bloomW[i]) ? w : post.bloomW[i];
+        post.bloomValidH[i] = (h < post.bloomH[i]) ? h : post.bloomH[i];
+    }
+}
+
+void beginScenePass(const PostProcess& post)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, post.sceneFBO);
+    glViewport(0, 0, post.renderWidth, post.renderHeight);
+}
+
+// uv scale/max uniforms for sampling the valid sub-rectangle of a target
+static void setRegionUniforms(GLint scaleLoc, GLint maxLoc, int validW, int validH, int allocW, int allocH)
+{
+    glUniform2f(scaleLoc, (float)validW / allocW, (float)validH / allocH);
+    glUniform2f(maxLoc, (validW - 0.5f) / allocW, (validH - 0.5f) / allocH);
+}
+
+void renderBloom(const PostProcess& post)
+{
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+    glBindVertexArray(post.emptyVAO);
+    glActiveTexture(GL_TEXTURE0);
+
+    // Downsample: scene -> half -> quarter -> ...
+    glUseProgram(post.downsampleProgram);
+    glUniform1f(post.downThresholdLoc, post.bloomThreshold);
+
+    for (int i = 0; i < PostProcess::BLOOM_LEVELS; ++i)
+    {
+        GLuint src = (i == 0) ? post.sceneColor : post.bloomTex[i - 1];
+        int srcW = (i == 0) ? post.width : post.bloomW[i - 1];
+        int srcH = (i == 0) ? post.height : post.bloomH[i - 1];
+        int srcValidW = (i == 0) ? post.renderWidth : post.bloomValidW[i - 1];
+        int srcValidH = (i == 0) ? post.renderHeight : post.bloomValidH[i - 1];
+
+        glBindFramebuffer(GL_FRAMEBUFFER, post.bloomFBO[i]);
+        glViewport(0, 0, post.bloomValidW[i], post.bloomValidH[i]);
+        glBindTexture(GL_TEXTURE_2D, src);
+        glUniform2f(post.downSrcTexelLoc, 1.0f / srcW, 1.0f / srcH);
+        setRegionUniforms(post.downSrcUvScaleLoc, post.downSrcUvMaxLoc, srcValidW, srcValidH, srcW, srcH);
+        glUniform1i(post.downPrefilterLoc, i == 0 ? 1 : 0);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+
+    // Upsample back to half resolution, accumulating each level into the one above
+    glUseProgram(post.upsampleProgram);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE);
+
+    for (int i = PostProcess::BLOOM_LEVELS - 1; i > 0; --i)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, post.bloomFBO[i - 1]);
+        glViewport(0, 0, post.bloomValidW[i - 1], post.bloomValidH[i - 1]);
+        glBindTexture(GL_TEXTURE_2D, post.bloomTex[i]);
+        glUniform2f(post.upSrcTexelLoc, 1.0f / post.bloomW[i], 1.0f / post.bloomH[i]);
+        setRegionUniforms(post.upSrcUvScaleLoc, post.upSrcUvMaxLoc,
+            post.bloomValidW[i], post.bloomValidH[i], post.bloomW[i], post.bloomH[i]);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glBindVertexArray(0);
+    glEnable(GL_DEPTH_TEST);
+}
+
+static float halton(unsigned index, unsigned base)
+{
+    float f = 1.0f;
+    float r = 0.0f;
+    while (index > 0)
+    {
+        f /= (float)base;
+        r += f * (float)(index % base);
+        index /= base;
+    }
+    return r;
+}
+
+glm::vec2 temporalJitter(const PostProcess& post, unsigned frameIndex)
+{
+    if (!post.taaEnabled) return glm::vec2(0.0f);
+
+    unsigned i = (frameIndex % 8u) + 1u;
+    glm::vec2 pixelOffset(halton(i, 2) - 0.5f, halton(i, 3) - 0.5f);
+
+    // One render-resolution pixel is 2/size in NDC
+    return glm::vec2(pixelOffset.x * 2.0f / post.renderWidth, pixelOffset.y * 2.0f / post.renderHeight);
+}
+
+glm::mat4 jitterProjection(const glm::mat4& proj, const glm::vec2& jitterNdc)
+{
+    // clip.w = -z_view, so subtracting here shifts NDC by +jitter
+    glm::mat4 p = proj;
+    p[2][0] -= jitterNdc.x;
+    p[2][1] -= jitterNdc.y;
+    return p;
+}
+
+void renderTemporalAA(PostProcess& post, const glm::vec2& jitterNdc)
+{
+    if (!post.taaEnabled) return;
+
+    int readIndex = post.historyIndex;
+    int writeIndex = 1 - readIndex;
+
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, post.historyFBO[writeIndex]);
+    glViewport(0, 0, post.width, post.height);
+
+    glUseProgram(post.taaProgram);
+    glUniform2f(post.taaCurTexelLoc, 1.0f / post.width, 1.0f / post.height);
+    setRegionUniforms(post.taaCurUvScaleLoc, post.taaCurUvMaxLoc,
+        post.renderWidth, post.renderHeight, post.width, post.height);
+    glUniform2f(post.taaJitterLoc, jitterNdc.x * 0.5f, jitterNdc.y * 0.5f);
+    glUniform1f(post.taaHistoryValidLoc, post.historyValid ? 1.0f : 0.0f);
+    glUniform2f(post.taaOutputSizeLoc, (float)post.width, (float)post.height);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, post.sceneColor);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, post.sceneVelocity);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_2D, post.historyTex[readIndex]);
+
+    glBindVertexArray(post.emptyVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+
+    glActiveTexture(GL_TEXTURE0);
+    glEnable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
+
+    post.historyIndex = writeIndex;
+    post.historyValid = true;
+}
+
+void resetTemporalHistory(PostProcess& post)
+{
+    post.historyValid = false;
+}
+
+void renderComposite(const PostProcess& post, int fbWidth, int fbHeight)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, fbWidth, fbHeight);
+
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+
+    glUseProgram(post.compositeProgram);
+    glUniform1f(post.compExposureLoc, post.exposure);
+    glUniform1f(post.compBloomLoc, post.bloomStrength);
+    glUniform1f(post.compVignetteLoc, post.vignette);
+    glUniform1f(post.compLutSizeLoc, (float)post.gradeLutSize);
+    glUniform1f(post.compSharpnessLoc, post.sharpness + 0.6f * (1.0f - post.renderScale));
+    glUniform2f(post.compSceneTexelLoc, 1.0f / post.width, 1.0f / post.height);
+
+    // TAA output is already full resolution, otherwise upscale from the render rectangle
+    GLuint sceneSource = post.taaEnabled ? post.historyTex[post.historyIndex] : post.sceneColor;
+    int sourceW = post.taaEnabled ? post.width : post.renderWidth;
+    int sourceH = post.taaEnabled ? post.height : post.renderHeight;
+    setRegionUniforms(post.compSceneUvScaleLoc, post.compSceneUvMaxLoc,
+        sourceW, sourceH, post.width, post.height);
+    setRegionUniforms(post.compBloomUvScaleLoc, post.compBloomUvMaxLoc,
+        post.bloomValidW[0], post.bloomValidH[0], post.bloomW[0], post.bloomH[0]);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, sceneSource);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, post.bloomTex[0]);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_3D, post.gradeLut);
+
+    glBindVertexArray(post.emptyVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+
+    glActiveTexture(GL_TEXTURE0);
+    glEnable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
+}
+
+void destroyPostProcess(PostProcess& post)
+{
+    releaseTargets(post);
+    if (post.gradeLut) glDeleteTextures(1, &post.gradeLut);
+    if (post.downsampleProgram) glDeleteProgram(post.downsampleProgram);
+    if (post.upsampleProgram) glDeleteProgram(post.upsampleProgram);
+    if (post.compositeProgram) glDeleteProgram(post.compositeProgram);
+    if (post.taaProgram) glDeleteProgram(post.taaProgram);
+    if (post.emptyVAO) glDeleteVertexArrays(1, &post.emptyVAO);
+    post = PostProcess{};
+}
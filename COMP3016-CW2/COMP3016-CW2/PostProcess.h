@@ -0,0 +1,116 @@
+#pragma once
+
+#define NOMINMAX
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+// HDR scene target, progressive bloom chain, temporal AA/upsampling and the fused final pass
+// (upscale + sharpen + exposure + bloom + ACES tonemap + 3D LUT grade + vignette in one fullscreen draw)
+//
+// Targets are allocated at the backbuffer size. Dynamic resolution only shrinks the
+// rendered sub-rectangle, so changing the scale never reallocates anything.
+// With TAA on, the jittered low-resolution scene is accumulated into a full-resolution
+// history, which the composite then reads instead of the scene target.
+struct PostProcess
+{
+    static const int BLOOM_LEVELS = 5;
+
+    int width = 0;
+    int height = 0;
+
+    // Region of the scene target actually rendered this frame
+    float renderScale = 1.0f;
+    int renderWidth = 0;
+    int renderHeight = 0;
+
+    // Scene target: RGBA16F colour + RG16F velocity (uv units, current - previous) + 24-bit depth
+    GLuint sceneFBO = 0;
+    GLuint sceneColor = 0;
+    GLuint sceneVelocity = 0;
+    GLuint sceneDepth = 0;
+
+    // TAA history, ping-ponged at backbuffer resolution
+    bool taaEnabled = true;
+    GLuint historyFBO[2] = {};
+    GLuint historyTex[2] = {};
+    int historyIndex = 0;
+    bool historyValid = false;
+
+    // Bloom chain starts at half resolution, R11G11B10F to keep bandwidth down
+    GLuint bloomFBO[BLOOM_LEVELS] = {};
+    GLuint bloomTex[BLOOM_LEVELS] = {};
+    int bloomW[BLOOM_LEVELS] = {};
+    int bloomH[BLOOM_LEVELS] = {};
+    int bloomValidW[BLOOM_LEVELS] = {};
+    int bloomValidH[BLOOM_LEVELS] = {};
+
+    GLuint gradeLut = 0;
+    int gradeLutSize = 0;
+
+    GLuint downsampleProgram = 0;
+    GLuint upsampleProgram = 0;
+    GLuint compositeProgram = 0;
+    GLuint taaProgram = 0;
+    GLuint emptyVAO = 0;
+
+    GLint downSrcTexelLoc = -1;
+    GLint downSrcUvScaleLoc = -1;
+    GLint downSrcUvMaxLoc = -1;
+    GLint downPrefilterLoc = -1;
+    GLint downThresholdLoc = -1;
+    GLint upSrcTexelLoc = -1;
+    GLint upSrcUvScaleLoc = -1;
+    GLint upSrcUvMaxLoc = -1;
+    GLint compSceneTexelLoc = -1;
+    GLint compSceneUvScaleLoc = -1;
+    GLint compSceneUvMaxLoc = -1;
+    GLint compBloomUvScaleLoc = -1;
+    GLint compBloomUvMaxLoc = -1;
+    GLint compSharpnessLoc = -1;
+    GLint compExposureLoc = -1;
+    GLint compBloomLoc = -1;
+    GLint compVignetteLoc = -1;
+    GLint compLutSizeLoc = -1;
+    GLint taaCurTexelLoc = -1;
+    GLint taaCurUvScaleLoc = -1;
+    GLint taaCurUvMaxLoc = -1;
+    GLint taaJitterLoc = -1;
+    GLint taaHistoryValidLoc = -1;
+    GLint taaOutputSizeLoc = -1;
+
+    float exposure = 1.0f;
+    float bloomThreshold = 1.0f;
+    float bloomStrength = 0.15f;
+    float vignette = 0.25f;
+    float sharpness = 0.2f;   // extra sharpening is added as the render scale drops
+};
+
+// lutPath is an optional .cube file, a neutral LUT is used if it can't be read
+bool initPostProcess(PostProcess& post, int width, int height, const char* lutPath);
+void resizePostProcess(PostProcess& post, int width, int height);
+
+// Fraction of the backbuffer resolution (per axis) the scene is rendered at
+void setRenderScale(PostProcess& post, float scale);
+
+// Bind the HDR target (render sub-rectangle) for scene rendering
+void beginScenePass(const PostProcess& post);
+
+void renderBloom(const PostProcess& post);
+
+// Sub-pixel projection jitter (NDC units) for this frame, Halton(2,3) over 8 frames
+glm::vec2 temporalJitter(const PostProcess& post, unsigned frameIndex);
+
+// Apply an NDC jitter to a perspective projection
+glm::mat4 jitterProjection(const glm::mat4& proj, const glm::vec2& jitterNdc);
+
+// Resolve the jittered scene into the history (no-op when TAA is off)
+void renderTemporalAA(PostProcess& post, const glm::vec2& jitterNdc);
+
+// Drop accumulated history (camera cut, TAA toggle)
+void resetTemporalHistory(PostProcess& post);
+
+// Upscales to the backbuffer, anything drawn after this (UI) stays at native resolution
+void renderComposite(const PostProcess& post, int fbWidth, int fbHeight);
+
+void destroyPostProcess(PostProcess& post);
@@ -0,0 +1,393 @@
+#include "Scatter.h"
+#include "StartupTrace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+
+// Tiles are TILE_CELLS^2 cells; each cell gets up to ATTEMPTS candidates
+static const int TILE_CELLS = 32;
+static const int ATTEMPTS = 4;
+// Empty cells hold a point this far out, so distance tests need no emptiness branch
+static const float EMPTY_CELL = 1e18f;
+
+struct ScatterGrid
+{
+    float radius = 0.0f;
+    float cell = 0.0f;
+    int dimX = 0;
+    int dimZ = 0;
+    glm::vec2 origin{ 0.0f };
+    std::vector<glm::vec2> points;      // one slot per cell, (EMPTY_CELL, EMPTY_CELL) when empty
+};
+
+// Per-tile state shared by a phase's jobs (everything here is read-only while they run)
+struct ScatterPass
+{
+    const ScatterArea* area = nullptr;
+    const ScatterLayer* layer = nullptr;
+    ScatterGrid* grid = nullptr;
+    const ScatterGrid* const* earlier = nullptr;    // layers already generated
+    int earlierCount = 0;
+    int tilesX = 0;
+    int tilesZ = 0;
+};
+
+static uint32_t mix32(uint32_t h)
+{
+    h ^= h >> 16;
+    h *= 0x7FEB352Du;
+    h ^= h >> 15;
+    h *= 0x846CA68Bu;
+    h ^= h >> 16;
+    return h;
+}
+
+uint32_t hashScatter(uint32_t seed, uint32_t a, uint32_t b)
+{
+    return mix32(seed ^ mix32(a ^ mix32(b + 0x9E3779B9u)));
+}
+
+static float hashToUnit(uint32_t h)
+{
+    return (h >> 8) * (1.0f / 16777216.0f);
+}
+
+// Small and fast: every tile owns one, seeded from its coordinates
+struct ScatterRng
+{
+    uint32_t state;
+
+    float next()
+    {
+        state = state * 1664525u + 1013904223u;
+        return hashToUnit(mix32(state));
+    }
+};
+
+// Against a layer generated earlier: any cell within minDist of p
+static bool conflicts(const ScatterGrid& grid, glm::vec2 p, float minDist)
+{
+    glm::vec2 local = (p - grid.origin) / grid.cell;
+    float reach = minDist / grid.cell;
+    int x0 = std::max((int)floorf(local.x - reach), 0);
+    int z0 = std::max((int)floorf(local.y - reach), 0);
+    int x1 = std::min((int)floorf(local.x + reach), grid.dimX - 1);
+    int z1 = std::min((int)floorf(local.y + reach), grid.dimZ - 1);
+
+    float minDist2 = minDist * minDist;
+    for (int z = z0; z <= z1; ++z)
+    {
+        const glm::vec2* row = grid.points.data() + (size_t)z * grid.dimX;
+        for (int x = x0; x <= x1; ++x)
+        {
+            glm::vec2 d = row[x] - p;
+            if (glm::dot(d, d) < minDist2)
+                return true;
+        }
+    }
+    return false;
+}
+
+// Against the layer's own grid, for a candidate in cell (cx, cz): with radius/sqrt(2)
+// cells only the 5x5 block around it can be in reach, minus its corners, which are
+// exactly radius away at best
+static bool conflictsOwn(const ScatterGrid& grid, int cx, int cz, glm::vec2 p)
+{
+    float r2 = grid.radius * grid.radius;
+    int z0 = std::max(cz - 2, 0);
+    int z1 = std::min(cz + 2, grid.dimZ - 1);
+    for (int z = z0; z <= z1; ++z)
+    {
+        int edge = (z == cz - 2 || z == cz + 2) ? 1 : 2;
+        int x0 = std::max(cx - edge, 0);
+        int x1 = std::min(cx + edge, grid.dimX - 1);
+        const glm::vec2* row = grid.points.data() + (size_t)z * grid.dimX;
+        for (int x = x0; x <= x1; ++x)
+        {
+            glm::vec2 d = row[x] - p;
+            if (glm::dot(d, d) < r2)
+                return true;
+        }
+    }
+    return false;
+}
+
+// Density masks: keepout circle, ground height range and slope
+static bool groundAllows(const ScatterArea& area, const ScatterLayer& layer, glm::vec2 p)
+{
+    if (area.keepoutRadius > 0.0f && glm::distance(p, area.keepoutCenter) <= area.keepoutRadius)
+        return false;
+    bool heightLimited = layer.minHeight > -FLT_MAX || layer.maxHeight < FLT_MAX;
+    if (!area.height || (!heightLimited && layer.maxSlope <= 0.0f))
+        return true;
+
+    float h = area.height(p.x, p.y);
+    if (h < layer.minHeight || h > layer.maxHeight)
+        return false;
+    if (layer.maxSlope > 0.0f)
+    {
+        const float e = 0.5f;
+        float dx = area.height(p.x + e, p.y) - area.height(p.x - e, p.y);
+        float dz = area.height(p.x, p.y + e) - area.height(p.x, p.y - e);
+        if (dx * dx + dz * dz > layer.maxSlope * layer.maxSlope * (4.0f * e * e))
+            return false;
+    }
+    return true;
+}
+
+// Cells wholly inside an earlier layer's reach (a point's exclusion radius minus half
+// this grid's cell diagonal still covers the cell centre) get no candidates at all.
+// Stamping the earlier points onto the tile is far cheaper than looking them up per cell.
+static void markSwallowedCells(const ScatterGrid& grid, const ScatterGrid& other, glm::vec2 tileMin, int w, int h,
+    bool* swallowed)
+{
+    float inner = 0.5f * other.radius;
+    glm::vec2 tileMax = tileMin + glm::vec2((float)w, (float)h) * grid.cell;
+    glm::vec2 lo = glm::floor((tileMin - inner - other.origin) / other.cell);
+    glm::vec2 hi = glm::floor((tileMax + inner - other.origin) / other.cell);
+    for (int z = std::max((int)lo.y, 0); z <= std::min((int)hi.y, other.dimZ - 1); ++z)
+    {
+        for (int x = std::max((int)lo.x, 0); x <= std::min((int)hi.x, other.dimX - 1); ++x)
+        {
+            glm::vec2 q = other.points[(size_t)z * other.dimX + x];
+            if (q.x == EMPTY_CELL)
+                continue;
+
+            // Cells of this tile whose centres are within inner of q
+            glm::vec2 c0 = glm::ceil((q - inner - tileMin) / grid.cell - 0.5f);
+            glm::vec2 c1 = glm::floor((q + inner - tileMin) / grid.cell - 0.5f);
+            for (int sz = std::max((int)c0.y, 0); sz <= std::min((int)c1.y, h - 1); ++sz)
+            {
+                for (int sx = std::max((int)c0.x, 0); sx <= std::min((int)c1.x, w - 1); ++sx)
+                {
+                    glm::vec2 d = tileMin + (glm::vec2((float)sx, (float)sz) + 0.5f) * grid.cell - q;
+                    if (glm::dot(d, d) < inner * inner)
+                        swallowed[sz * w + sx] = true;
+                }
+            }
+        }
+    }
+}
+
+static void fillTile(const ScatterPass& pass, int tx, int tz)
+{
+    const ScatterArea& area = *pass.area;
+    const ScatterLayer& layer = *pass.layer;
+    ScatterGrid& grid = *pass.grid;
+
+    int cx0 = tx * TILE_CELLS;
+    int cz0 = tz * TILE_CELLS;
+    int w = std::min(TILE_CELLS, grid.dimX - cx0);
+    int h = std::min(TILE_CELLS, grid.dimZ - cz0);
+
+    ScatterRng rng{ hashScatter(layer.seed, (uint32_t)tx, (uint32_t)tz) };
+
+    bool swallowed[TILE_CELLS * TILE_CELLS] = {};
+    glm::vec2 tileMin = grid.origin + glm::vec2((float)cx0, (float)cz0) * grid.cell;
+    for (int j = 0; j < pass.earlierCount; ++j)
+        markSwallowedCells(grid, *pass.earlier[j], tileMin, w, h, swallowed);
+
+    // Visit the tile's cells in a shuffled order
+    uint16_t order[TILE_CELLS * TILE_CELLS];
+    int cellCount = w * h;
+    for (int i = 0; i < cellCount; ++i)
+        order[i] = (uint16_t)i;
+    for (int i = cellCount - 1; i > 0; --i)
+        std::swap(order[i], order[std::min((int)(rng.next() * (i + 1)), i)]);
+
+    for (int i = 0; i < cellCount; ++i)
+    {
+        if (layer.density < 1.0f && rng.next() >= layer.density)
+            continue;
+        if (swallowed[order[i]])
+            continue;
+
+        int cx = cx0 + order[i] % w;
+        int cz = cz0 + order[i] / w;
+        glm::vec2 cellMin = grid.origin + glm::vec2((float)cx, (float)cz) * grid.cell;
+        for (int attempt = 0; attempt < ATTEMPTS; ++attempt)
+        {
+            glm::vec2 p = cellMin + glm::vec2(rng.next(), rng.next()) * grid.cell;
+            if (p.x > area.max.x || p.y > area.max.y || conflictsOwn(grid, cx, cz, p))
+                continue;
+
+            bool blocked = false;
+            for (int j = 0; j < pass.earlierCount && !blocked; ++j)
+                blocked = conflicts(*pass.earlier[j], p, 0.5f * (grid.radius + pass.earlier[j]->radius));
+            if (blocked || !groundAllows(area, layer, p))
+                continue;
+
+            grid.points[(size_t)cz * grid.dimX + cx] = p;
+            break;
+        }
+    }
+}
+
+static void generateLayer(const ScatterPass& pass, JobSystem* jobs)
+{
+    // Same-phase tiles are two apart on each axis
+    for (int phase = 0; phase < 4; ++phase)
+    {
+        int px = phase & 1;
+        int pz = phase >> 1;
+        int columns = (pass.tilesX - px + 1) / 2;
+        int rows = (pass.tilesZ - pz + 1) / 2;
+        parallelFor(jobs, columns * rows, 1, [&](int begin, int end)
+            {
+                for (int i = begin; i < end; ++i)
+                    fillTile(pass, px + 2 * (i % columns), pz + 2 * (i / columns));
+            });
+    }
+}
+
+// Grid order, rows counted and written in parallel; rotation and scale hash off the cell
+static void collectLayer(const ScatterGrid& grid, const ScatterLayer& layer, std::vector<ScatterPoint>& out,
+    JobSystem* jobs)
+{
+    std::vector<size_t> rowStart((size_t)grid.dimZ + 1, 0);
+    parallelFor(jobs, grid.dimZ, 64, [&](int begin, int end)
+        {
+            for (int z = begin; z < end; ++z)
+            {
+                const glm::vec2* row = grid.points.data() + (size_t)z * grid.dimX;
+                size_t count = 0;
+                for (int x = 0; x < grid.dimX; ++x)
+                    count += (row[x].x != EMPTY_CELL) ? 1 : 0;
+                rowStart[(size_t)z + 1] = count;
+            }
+        });
+    std::partial_sum(rowStart.begin(), rowStart.end(), rowStart.begin());
+
+    out.resize(rowStart.back());
+    parallelFor(jobs, grid.dimZ, 64, [&](int begin, int end)
+        {
+            for (int z = begin; z < end; ++z)
+            {
+                const glm::vec2* row = grid.points.data() + (size_t)z * grid.dimX;
+                ScatterPoint* dst = out.data() + rowStart[(size_t)z];
+                for (int x = 0; x < grid.dimX; ++x)
+                {
+                    if (row[x].x == EMPTY_CELL)
+                        continue;
+                    uint32_t h = hashScatter(layer.seed ^ 0x51ED270Bu, (uint32_t)x, (uint32_t)z);
+                    dst->x = row[x].x;
+                    dst->z = row[x].y;
+                    dst->rotY = hashToUnit(h) * 6.2831853f;
+                    dst->scale = layer.minScale + (layer.maxScale - layer.minScale) * hashToUnit(mix32(h));
+                    ++dst;
+                }
+            }
+        });
+}
+
+void scatterPoisson(const ScatterArea& area, const ScatterLayer* layers, int layerCount,
+    std::vector<ScatterPoint>* out, JobSystem* jobs)
+{
+    TRACE_SCOPE("poisson scatter", "scatter");
+
+    // Largest radius first (ties keep their order)
+    std::vector<int> order((size_t)layerCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b)
+        {
+            return layers[a].radius > layers[b].radius;
+        });
+
+    glm::vec2 extent = glm::max(area.max - area.min, glm::vec2(0.0f));
+    std::vector<ScatterGrid> grids((size_t)layerCount);
+    std::vector<const ScatterGrid*> earlier;
+    for (int index : order)
+    {
+        const ScatterLayer& layer = layers[index];
+        out[index].clear();
+        if (layer.radius <= 0.0f || layer.density <= 0.0f || extent.x <= 0.0f || extent.y <= 0.0f)
+            continue;
+
+        ScatterGrid& grid = grids[(size_t)index];
+        grid.radius = layer.radius;
+        grid.cell = layer.radius / sqrtf(2.0f);
+        grid.dimX = std::max((int)ceilf(extent.x / grid.cell), 1);
+        grid.dimZ = std::max((int)ceilf(extent.y / grid.cell), 1);
+        grid.origin = area.min;
+        grid.points.assign((size_t)grid.dimX * grid.dimZ, glm::vec2(EMPTY_CELL));
+
+        ScatterPass pass;
+        pass.area = &area;
+        pass.layer = &layer;
+        pass.grid = &grid;
+        pass.earlier = earlier.data();
+        pass.earlierCount = (int)earlier.size();
+        pass.tilesX = (grid.dimX + TILE_CELLS - 1) / TILE_CELLS;
+        pass.tilesZ = (grid.dimZ + TILE_CELLS - 1) / TILE_CELLS;
+        generateLayer(pass, jobs);
+        collectLayer(grid, layer, out[index], jobs);
+
+        earlier.push_back(&grid);
+    }
+}
+
+void runScatterBenchmark(float (*height)(float x, float z))
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Roughly a million instances: sparse trees, rocks off the steep ground, a dense grass layer
+    const float HALF_EXTENT = 550.0f;
+    ScatterLayer layers[3];
+    layers[0].radius = 4.0f;
+    layers[0].density = 0.3f;
+    layers[0].minScale = 1.4f;
+    layers[0].maxScale = 2.4f;
+    layers[0].seed = 1;
+    layers[1].radius = 2.0f;
+    layers[1].density = 0.3f;
+    layers[1].maxSlope = 0.5f;
+    layers[1].seed = 2;
+    layers[2].radius = 0.6f;
+    layers[2].minScale = 0.5f;
+    layers[2].seed = 3;
+
+    ScatterArea area;
+    area.min = glm::vec2(-HALF_EXTENT);
+    area.max = glm::vec2(HALF_EXTENT);
+    area.height = height;
+    area.keepoutRadius = 6.0f;
+
+    JobSystem jobs;
+    initJobSystem(jobs, -1);
+
+    std::vector<ScatterPoint> out[3];
+    double ms[2] = {};
+    size_t total = 0;
+    bool same = true;
+    for (int run = 0; run < 2; ++run)
+    {
+        std::vector<ScatterPoint> prev[3] = { out[0], out[1], out[2] };
+        auto t0 = Clock::now();
+        scatterPoisson(area, layers, 3, out, run == 0 ? nullptr : &jobs);
+        ms[run] = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+
+        total = out[0].size() + out[1].size() + out[2].size();
+        for (int i = 0; run > 0 && i < 3; ++i)
+            same = same && prev[i].size() == out[i].size() &&
+                std::equal(out[i].begin(), out[i].end(), prev[i].begin(), [](const ScatterPoint& a, const ScatterPoint& b)
+                    {
+                        return a.x == b.x && a.z == b.z && a.rotY == b.rotY && a.scale == b.scale;
+                    });
+    }
+
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(0) << "Poisson scatter benchmark: " << 2.0f * HALF_EXTENT << " x "
+        << 2.0f * HALF_EXTENT << " m, " << total << " instances (" << out[0].size() << " trees, " << out[1].size()
+        << " rocks, " << out[2].size() << " grass)\n";
+    report << std::setprecision(1) << "  1 thread " << ms[0] << " ms (" << total / (ms[0] * 1000.0) << " M/s), "
+        << jobThreadCount(jobs) << " threads " << ms[1] << " ms (" << total / (ms[1] * 1000.0) << " M/s), results "
+        << (same ? "identical" : "DIFFER") << "\n";
+    std::cout << report.str();
+
+    destroyJobSystem(jobs);
+}
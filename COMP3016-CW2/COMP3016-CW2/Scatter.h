@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cfloat>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "JobSystem.h"
+
+// Poisson-disk prop scatter
+// Each layer (one per prop type) is a blue-noise point set: no two of its points
+// are closer than its radius, and a point is at least the mean of the two radii
+// away from every point of the layers generated before it. Layers run largest
+// radius first, so trees claim their space and rocks and grass fill in around them.
+//
+// A layer lives on a grid of radius/sqrt(2) cells, which holds at most one point
+// per cell, so a candidate only has to look at the 5x5 cells around it. Each cell
+// gets a few candidates, tried in a shuffled order so there's no scanline bias.
+// The grid is cut into square tiles that are run in parallel in four phases by
+// (x & 1, z & 1): tiles in the same phase are a whole tile apart, further than any
+// candidate looks, so they never see each other's writes. Every tile draws from
+// its own generator seeded from (layer seed, tile), and the phases run in a fixed
+// order, so the result is the same for any number of threads.
+
+struct ScatterLayer
+{
+    float radius = 1.0f;                // minimum spacing, world units
+    float density = 1.0f;               // fraction of cells tried; thins the set without breaking the spacing
+    float minScale = 1.0f;
+    float maxScale = 1.0f;
+    float maxSlope = 0.0f;              // rise over run; steeper ground stays empty (0 = any slope)
+    float minHeight = -FLT_MAX;         // ground height range the layer grows in
+    float maxHeight = FLT_MAX;
+    uint32_t seed = 0;
+};
+
+struct ScatterArea
+{
+    glm::vec2 min{ 0.0f };
+    glm::vec2 max{ 0.0f };
+    float (*height)(float x, float z) = nullptr;   // ground for the slope and height masks, may be null
+    glm::vec2 keepoutCenter{ 0.0f };    // circle left empty (the player spawn)
+    float keepoutRadius = 0.0f;
+};
+
+struct ScatterPoint
+{
+    float x;
+    float z;
+    float rotY;
+    float scale;
+};
+
+// Derives a seed from a layer seed and two coordinates (tiles here, chunks for the world stream)
+uint32_t hashScatter(uint32_t seed, uint32_t a, uint32_t b);
+
+// Fills out[i] with layer i's points (replacing what was there); jobs may be null
+// Points come out in grid order, the same on every run for the same inputs.
+void scatterPoisson(const ScatterArea& area, const ScatterLayer* layers, int layerCount,
+    std::vector<ScatterPoint>* out, JobSystem* jobs);
+
+// A million-instance vegetation field on height(), one thread versus all of them
+void runScatterBenchmark(float (*height)(float x, float z));
@@ -0,0 +1,123 @@
+#include "Scene.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <vector>
+
+// Entities per job chunk for the per-entity loops below
+static const int SCENE_GRAIN = 512;
+
+void transformSystem(World& world, void*)
+{
+    // Only archetypes holding the tag match, so clean entities are never visited
+    forEachChunk<const Transform, const RenderMesh, const TransformDirty, WorldMatrix, WorldBounds>(world,
+        [&](size_t count, const Entity*, const Transform* transforms, const RenderMesh* meshes,
+            const TransformDirty*, WorldMatrix* matrices, WorldBounds* bounds)
+        {
+            parallelFor(world.jobs, (int)count, SCENE_GRAIN, [&](int begin, int end)
+                {
+                    for (int i = begin; i < end; ++i)
+                    {
+                        const Transform& t = transforms[i];
+                        glm::mat4 model(1.0f);
+                        model = glm::translate(model, t.position);
+                        model = glm::rotate(model, t.rotY, glm::vec3(0.0f, 1.0f, 0.0f));
+                        model = glm::scale(model, glm::vec3(t.scale));
+                        matrices[i].model = model;
+                        matrices[i].normal = glm::transpose(glm::inverse(glm::mat3(model)));
+
+                        const Model* m = meshes[i].model;
+                        glm::vec3 localCenter = m ? 0.5f * (m->boundsMin + m->boundsMax) : glm::vec3(0.0f);
+                        float localRadius = m ? 0.5f * glm::length(m->boundsMax - m->boundsMin) : 0.0f;
+                        bounds[i].center = glm::vec3(model * glm::vec4(localCenter, 1.0f));
+                        bounds[i].radius = localRadius * t.scale;
+                    }
+                });
+        });
+}
+
+void markTransformDirty(World& world, Entity e)
+{
+    if (!getComponent<TransformDirty>(world, e))
+        addComponent(world, e, TransformDirty{});
+}
+
+size_t clearTransformDirty(World& world)
+{
+    // Whole archetypes at a time: after a bulk spawn that's every prop in a handful of column copies
+    ComponentMask tag = componentMask<TransformDirty>();
+    std::vector<ComponentMask> dirty;
+    for (const Archetype& a : world.archetypes)
+        if ((a.mask & tag) && !a.entities.empty())
+            dirty.push_back(a.mask);
+
+    size_t cleaned = 0;
+    for (ComponentMask mask : dirty)
+        cleaned += setArchetypeComponents(world, mask, mask & ~tag);
+    return cleaned;
+}
+
+void setCullFrustum(CullContext& ctx, const glm::mat4& viewProj, const glm::vec3& eye)
+{
+    // Gribb/Hartmann: each plane is the last row plus or minus one of the others
+    glm::mat4 m = glm::transpose(viewProj);
+    ctx.planes[0] = m[3] + m[0];
+    ctx.planes[1] = m[3] - m[0];
+    ctx.planes[2] = m[3] + m[1];
+    ctx.planes[3] = m[3] - m[1];
+    ctx.planes[4] = m[3] + m[2];
+    ctx.planes[5] = m[3] - m[2];
+    for (glm::vec4& p : ctx.planes)
+        p /= glm::length(glm::vec3(p));
+    ctx.eye = eye;
+}
+
+void cullSystem(World& world, void* context)
+{
+    const CullContext& ctx = *(const CullContext*)context;
+
+    forEachChunk<const WorldBounds, Visibility>(world,
+        [&](size_t count, const Entity*, const WorldBounds* bounds, Visibility* visibility)
+        {
+            parallelFor(world.jobs, (int)count, SCENE_GRAIN, [&](int begin, int end)
+                {
+                    for (int i = begin; i < end; ++i)
+                    {
+                        const WorldBounds& b = bounds[i];
+                        bool inside = true;
+                        for (const glm::vec4& p : ctx.planes)
+                        {
+                            if (glm::dot(glm::vec3(p), b.center) + p.w < -b.radius)
+                            {
+                                inside = false;
+                                break;
+                            }
+                        }
+                        visibility[i].visible = inside ? 1u : 0u;
+                        visibility[i].distance = glm::distance(ctx.eye, b.center);
+                    }
+                });
+        });
+}
+
+void collisionBuildSystem(World& world, void* context)
+{
+    CollisionGrid& grid = *(CollisionGrid*)context;
+
+    // Ids follow archetype then row order, so pushes resolve in a stable order
+    std::vector<CollisionCircle> circles;
+    forEachChunk<const Transform, const CircleCollider>(world,
+        [&](size_t count, const Entity*, const Transform* transforms, const CircleCollider* colliders)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                CollisionCircle c;
+                c.center = glm::vec2(transforms[i].position.x, transforms[i].position.z);
+                c.radius = colliders[i].radius * transforms[i].scale;
+                c.id = (uint32_t)circles.size();
+                circles.push_back(c);
+            }
+        });
+
+    buildCollisionGrid(grid, circles);
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "Collision.h"
+#include "Ecs.h"
+#include "Model.h"
+
+// Scene components and the systems that don't need GL
+// Props are entities with Transform + RenderMesh (+ CircleCollider if solid);
+// the transform system derives WorldMatrix and WorldBounds from them, culling
+// turns bounds into Visibility, and the renderer draws whatever is visible.
+// A new prop type is just more entities with these components.
+// WorldMatrix and WorldBounds are a cache: they're only rebuilt for entities
+// tagged TransformDirty, so scenery that never moves costs nothing per frame.
+// Each archetype keeps them in one contiguous column, ready to be copied into
+// an instance buffer as is.
+// The transform and culling systems split each archetype's rows over world.jobs.
+
+struct Transform
+{
+    glm::vec3 position{ 0.0f };
+    float rotY = 0.0f;
+    float scale = 1.0f;                 // includes the model's render scale
+};
+
+struct RenderMesh
+{
+    const Model* model = nullptr;
+};
+
+struct WorldMatrix
+{
+    glm::mat4 model{ 1.0f };
+    glm::mat3 normal{ 1.0f };           // inverse transpose of the model matrix's upper 3x3
+};
+
+struct WorldBounds
+{
+    glm::vec3 center{ 0.0f };
+    float radius = 0.0f;
+};
+
+struct Visibility
+{
+    float distance = 0.0f;              // eye to bounds centre
+    uint32_t visible = 0;
+};
+
+// Tag: Transform (or the mesh) changed since WorldMatrix/WorldBounds were built
+// Spawn with it, or add it with markTransformDirty; clearTransformDirty removes it
+struct TransformDirty
+{
+    uint8_t unused = 0;
+};
+
+// Solid in the XZ plane; radius of the unscaled model, Transform.scale is applied
+struct CircleCollider
+{
+    float radius = 0.0f;
+};
+
+// On the player entity: what the renderer last told the audio system it heard
+struct Flashlight
+{
+    uint32_t on = 0;
+    uint32_t heard = 0;
+};
+
+// Transform system: reads Transform + RenderMesh + TransformDirty, writes WorldMatrix + WorldBounds
+void transformSystem(World& world, void* context);
+
+// Structural changes, so not while systems run
+void markTransformDirty(World& world, Entity e);
+
+// After the systems that consumed the tag have run; returns how many entities were clean again
+size_t clearTransformDirty(World& world);
+
+// Culling system: reads WorldBounds, writes Visibility
+struct CullContext
+{
+    glm::vec4 planes[6];                // from the unjittered view-projection, normals point inwards
+    glm::vec3 eye{ 0.0f };
+};
+
+void setCullFrustum(CullContext& ctx, const glm::mat4& viewProj, const glm::vec3& eye);
+void cullSystem(World& world, void* context);
+
+// Collision build: reads Transform + CircleCollider into a broadphase grid (context)
+// Solid props don't move, so this runs once after placement
+void collisionBuildSystem(World& world, void* context);
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+
+// Baked scene file (.scene), written by AssetBaker from a text .scn and mapped by the runtime
+//
+// Layout (all offsets from the start of the file, every block 16-byte aligned):
+//   SceneHeader
+//   SceneProp[propCount]
+//   SceneScatter[scatterCount]
+//   SceneInstance[instanceCount], grouped by prop (each prop owns one contiguous range)
+//
+// Instances are stored exactly as the loader consumes them, so placing a prop
+// is a straight walk over a mapped array. Scatter records are Poisson-disk layers
+// (see Scatter.h) the loader expands on the job system, which keeps million-instance
+// vegetation down to a few bytes on disk. Bump SCENE_FORMAT_VERSION on any layout change.
+static const char SCENE_FORMAT_MAGIC[4] = { 'C', 'W', 'S', 'C' };
+static const uint32_t SCENE_FORMAT_VERSION = 2;
+static const uint32_t SCENE_FORMAT_ALIGN = 16;
+static const uint32_t SCENE_NAME_MAX = 32;
+static const uint32_t SCENE_PATH_MAX = 120;
+
+struct SceneHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t propCount;
+    int32_t terrainSize;        // quads per side
+
+    float terrainSpacing;
+    float heightScale;
+    float spawn[2];             // player start, x/z
+
+    float spawnClearRadius;     // scatter leaves this much room around the spawn
+    uint32_t scatterCount;
+    uint32_t reserved[2];
+
+    uint64_t propOffset;
+    uint64_t scatterOffset;
+    uint64_t instanceOffset;
+    uint64_t instanceCount;
+    uint64_t fileSize;
+};
+
+// Mesh paths are relative to the working directory, as passed to requestModel
+struct SceneProp
+{
+    char name[SCENE_NAME_MAX];
+    char meshPath[SCENE_PATH_MAX];
+    float collisionRadius;      // of the unscaled model, 0 = not solid
+    uint32_t reserved;
+    uint64_t firstInstance;
+    uint64_t instanceCount;
+};
+
+// One Poisson-disk layer of prop's instances; every record in the file is one layer of the same set
+// Scales are in world units (the prop's render scale is already applied)
+struct SceneScatter
+{
+    uint32_t prop;
+    uint32_t seed;
+    float radius;
+    float density;
+    float minScale;
+    float maxScale;
+    float maxSlope;             // 0 = any slope
+    float minHeight;
+    float maxHeight;
+    uint32_t reserved[3];
+};
+
+// position[1] is the height above the terrain surface, rotY in radians, scale in world units
+struct SceneInstance
+{
+    float position[3];
+    float rotY;
+    float scale;
+};
+
+static_assert(sizeof(SceneHeader) == 88, "SceneHeader layout changed");
+static_assert(sizeof(SceneProp) == 176, "SceneProp layout changed");
+static_assert(sizeof(SceneScatter) == 48, "SceneScatter layout changed");
+static_assert(sizeof(SceneInstance) == 20, "SceneInstance layout changed");
+
+inline uint64_t alignSceneOffset(uint64_t offset)
+{
+    return (offset + SCENE_FORMAT_ALIGN - 1) & ~(uint64_t)(SCENE_FORMAT_ALIGN - 1);
+}
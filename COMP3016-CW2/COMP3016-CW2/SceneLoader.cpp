@@ -0,0 +1,217 @@
+#include "SceneLoader.h"
+#include "AssetPack.h"
+#include "Scene.h"
+#include "StartupTrace.h"
+
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+// Rows per job when filling columns: big enough that a job is mostly streaming memory
+static const int PLACE_GRAIN = 8192;
+
+// The records are read in place, so a section also has to sit on its record type's alignment
+// (the mapping itself starts on a page or a 64-byte pack blob)
+static bool blockInFile(uint64_t offset, uint64_t count, uint64_t stride, uint64_t align, uint64_t fileSize)
+{
+    return offset % align == 0 && offset <= fileSize && count <= (fileSize - offset) / stride;
+}
+
+static bool propValid(const SceneProp& prop, uint64_t instanceCount)
+{
+    return memchr(prop.name, '\0', SCENE_NAME_MAX) && memchr(prop.meshPath, '\0', SCENE_PATH_MAX) &&
+        prop.firstInstance <= instanceCount && prop.instanceCount <= instanceCount - prop.firstInstance &&
+        prop.instanceCount <= (uint64_t)INT_MAX;
+}
+
+static bool scatterValid(const SceneScatter& layer, uint32_t propCount)
+{
+    return layer.prop < propCount && layer.radius > 0.0f && layer.density > 0.0f &&
+        layer.minScale <= layer.maxScale && layer.minHeight <= layer.maxHeight;
+}
+
+bool openSceneFile(SceneFile& scene, const char* path)
+{
+    if (!openAssetFile(scene.file, path))
+    {
+        std::cerr << "Failed to open scene: " << path << " (run AssetBaker)\n";
+        return false;
+    }
+
+    const MappedFile& file = scene.file;
+    const SceneHeader* hdr = (const SceneHeader*)file.data;
+    bool ok = file.size >= sizeof(SceneHeader) &&
+        memcmp(hdr->magic, SCENE_FORMAT_MAGIC, sizeof(hdr->magic)) == 0 &&
+        hdr->version == SCENE_FORMAT_VERSION &&
+        hdr->fileSize == file.size &&
+        hdr->terrainSize > 0 && hdr->terrainSize <= 8192 && hdr->terrainSpacing > 0.0f &&
+        blockInFile(hdr->propOffset, hdr->propCount, sizeof(SceneProp), alignof(SceneProp), file.size) &&
+        blockInFile(hdr->scatterOffset, hdr->scatterCount, sizeof(SceneScatter), alignof(SceneScatter), file.size) &&
+        blockInFile(hdr->instanceOffset, hdr->instanceCount, sizeof(SceneInstance), alignof(SceneInstance), file.size);
+
+    const SceneProp* props = ok ? (const SceneProp*)(file.data + hdr->propOffset) : nullptr;
+    for (uint32_t i = 0; ok && i < hdr->propCount; ++i)
+        ok = propValid(props[i], hdr->instanceCount);
+
+    const SceneScatter* scatters = ok ? (const SceneScatter*)(file.data + hdr->scatterOffset) : nullptr;
+    for (uint32_t i = 0; ok && i < hdr->scatterCount; ++i)
+        ok = scatterValid(scatters[i], hdr->propCount);
+
+    if (!ok)
+    {
+        std::cerr << "Scene is corrupt or from another version: " << path << " (rebake it)\n";
+        closeSceneFile(scene);
+        return false;
+    }
+
+    scene.header = hdr;
+    scene.props = props;
+    scene.scatters = scatters;
+    scene.instances = (const SceneInstance*)(file.data + hdr->instanceOffset);
+    return true;
+}
+
+void closeSceneFile(SceneFile& scene)
+{
+    closeMappedFile(scene.file);
+    scene.header = nullptr;
+    scene.props = nullptr;
+    scene.scatters = nullptr;
+    scene.instances = nullptr;
+}
+
+ScatterLayer sceneScatterLayer(const SceneScatter& src)
+{
+    ScatterLayer layer;
+    layer.radius = src.radius;
+    layer.density = src.density;
+    layer.minScale = src.minScale;
+    layer.maxScale = src.maxScale;
+    layer.maxSlope = src.maxSlope;
+    layer.minHeight = src.minHeight;
+    layer.maxHeight = src.maxHeight;
+    layer.seed = src.seed;
+    return layer;
+}
+
+// Expands the scene's scatter records into points, one vector per record
+static void generateScatter(const SceneFile& scene, World& world, float (*groundHeight)(float x, float z),
+    std::vector<std::vector<ScatterPoint>>& points)
+{
+    const SceneHeader& hdr = *scene.header;
+    points.resize(hdr.scatterCount);
+    if (hdr.scatterCount == 0)
+        return;
+
+    // Same bounds the baker's uniform scatter uses
+    ScatterArea area;
+    float limit = hdr.terrainSize * hdr.terrainSpacing * 0.5f - 2.0f;
+    area.min = glm::vec2(-limit);
+    area.max = glm::vec2(limit);
+    area.height = groundHeight;
+    area.keepoutCenter = glm::vec2(hdr.spawn[0], hdr.spawn[1]);
+    area.keepoutRadius = hdr.spawnClearRadius;
+
+    std::vector<ScatterLayer> layers(hdr.scatterCount);
+    for (uint32_t i = 0; i < hdr.scatterCount; ++i)
+        layers[i] = sceneScatterLayer(scene.scatters[i]);
+    scatterPoisson(area, layers.data(), (int)layers.size(), points.data(), world.jobs);
+}
+
+// One bulk create for the prop's baked instances followed by its scattered points
+static void placeProp(const SceneFile& scene, uint32_t p, const std::vector<std::vector<ScatterPoint>>& points,
+    World& world, const Model* model, float (*groundHeight)(float x, float z), size_t count)
+{
+    const SceneProp& prop = scene.props[p];
+    ComponentMask mask = componentMask<Transform, RenderMesh, TransformDirty, WorldMatrix, WorldBounds, Visibility>();
+    bool solid = prop.collisionRadius > 0.0f;
+    if (solid)
+        mask |= componentMask<CircleCollider>();
+
+    uint32_t firstRow = 0;
+    Archetype& a = world.archetypes[createEntities(world, mask, count, firstRow)];
+    Transform* transforms = (Transform*)archetypeColumn(a, componentId<Transform>()) + firstRow;
+    RenderMesh* meshes = (RenderMesh*)archetypeColumn(a, componentId<RenderMesh>()) + firstRow;
+    CircleCollider* colliders = solid ? (CircleCollider*)archetypeColumn(a, componentId<CircleCollider>()) + firstRow : nullptr;
+
+    // The rest of the row is left zeroed: the transform system fills the caches, culling the visibility
+    auto place = [&](size_t row, float x, float y, float z, float rotY, float scale)
+        {
+            transforms[row].position = glm::vec3(x, groundHeight(x, z) + y, z);
+            transforms[row].rotY = rotY;
+            transforms[row].scale = scale;
+            meshes[row].model = model;
+            if (colliders)
+                colliders[row].radius = prop.collisionRadius;
+        };
+
+    const SceneInstance* instances = scene.instances + prop.firstInstance;
+    parallelFor(world.jobs, (int)prop.instanceCount, PLACE_GRAIN, [&](int begin, int end)
+        {
+            for (int i = begin; i < end; ++i)
+            {
+                const SceneInstance& inst = instances[i];
+                place((size_t)i, inst.position[0], inst.position[1], inst.position[2], inst.rotY, inst.scale);
+            }
+        });
+
+    size_t row = (size_t)prop.instanceCount;
+    for (uint32_t l = 0; l < scene.header->scatterCount; ++l)
+    {
+        if (scene.scatters[l].prop != p)
+            continue;
+
+        const ScatterPoint* pts = points[l].data();
+        size_t base = row;
+        parallelFor(world.jobs, (int)points[l].size(), PLACE_GRAIN, [&](int begin, int end)
+            {
+                for (int i = begin; i < end; ++i)
+                    place(base + (size_t)i, pts[i].x, 0.0f, pts[i].z, pts[i].rotY, pts[i].scale);
+            });
+        row += points[l].size();
+    }
+}
+
+size_t placeSceneProps(const SceneFile& scene, World& world, const Model* const* models,
+    float (*groundHeight)(float x, float z))
+{
+    TRACE_SCOPE("place scene props", "startup");
+    auto start = std::chrono::steady_clock::now();
+
+    // Every layer is generated, even for skipped props, so the others keep their spacing around it
+    std::vector<std::vector<ScatterPoint>> points;
+    generateScatter(scene, world, groundHeight, points);
+    double scatterMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    size_t placed = 0;
+    size_t scattered = 0;
+    for (uint32_t p = 0; p < scene.header->propCount; ++p)
+    {
+        const SceneProp& prop = scene.props[p];
+        size_t propScattered = 0;
+        for (uint32_t l = 0; l < scene.header->scatterCount; ++l)
+            if (scene.scatters[l].prop == p)
+                propScattered += points[l].size();
+
+        size_t count = (size_t)prop.instanceCount + propScattered;
+        if (!models[p] || count == 0 || count > (size_t)INT_MAX)
+            continue;
+
+        placeProp(scene, p, points, world, models[p], groundHeight, count);
+        placed += count;
+        scattered += propScattered;
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(2) << "Scene: placed " << placed << " instances (" << placed - scattered
+        << " baked of " << scene.header->instanceCount << ", " << scattered << " scattered; " << scene.header->propCount
+        << " props) in " << ms << " ms (scatter " << scatterMs << " ms), " << std::setprecision(1)
+        << (ms > 0.0 ? placed / (ms * 1000.0) : 0.0) << " M instances/s\n";
+    std::cout << line.str();
+    return placed;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Ecs.h"
+#include "MappedFile.h"
+#include "Model.h"
+#include "Scatter.h"
+#include "SceneFormat.h"
+
+// Baked scene files (.scene, see SceneFormat.h)
+// The file is mapped (from the asset pack when there is one) and validated
+// once; its tables are then read in place. Placing a prop bulk-creates all its
+// entities in one go and fills their columns straight from the mapped instance
+// array, split over world.jobs, so there is no allocation or parse per instance.
+// Scatter layers are generated at placement (see Scatter.h) and spawned with the
+// prop's baked instances in the same bulk create.
+struct SceneFile
+{
+    MappedFile file;
+    const SceneHeader* header = nullptr;
+    const SceneProp* props = nullptr;
+    const SceneScatter* scatters = nullptr;
+    const SceneInstance* instances = nullptr;
+};
+
+bool openSceneFile(SceneFile& scene, const char* path);
+void closeSceneFile(SceneFile& scene);
+
+// Spawns every instance and scattered point as a dirty prop entity (Transform, RenderMesh, the cached
+// transform components and Visibility, plus CircleCollider when the prop is solid)
+// models holds one entry per prop, a null entry skips that prop's instances.
+// groundHeight(x, z) lifts each instance onto the terrain and drives the scatter masks.
+// Returns how many were placed.
+size_t placeSceneProps(const SceneFile& scene, World& world, const Model* const* models,
+    float (*groundHeight)(float x, float z));
+
+// A scatter record as the layer scatterPoisson takes
+ScatterLayer sceneScatterLayer(const SceneScatter& scatter);
@@ -0,0 +1,56 @@
+#include "Shader.h"
+
+#include <iostream>
+
+const char* fullscreenVertSource = R"(
+#version 330 core
+out vec2 vUV;
+
+void main()
+{
+    vec2 p = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    vUV = p;
+    gl_Position = vec4(p * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+GLuint compileShader(GLenum type, const char* source)
+{
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint success = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success)
+    {
+        char infoLog[512];
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        std::cerr << "Shader compilation failed: " << infoLog << "\n";
+    }
+    return shader;
+}
+
+GLuint createProgram(const char* vertSource, const char* fragSource, const char* label)
+{
+    GLuint vert = compileShader(GL_VERTEX_SHADER, vertSource);
+    GLuint frag = compileShader(GL_FRAGMENT_SHADER, fragSource);
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vert);
+    glAttachShader(program, frag);
+    glLinkProgram(program);
+
+    GLint success = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        char infoLog[512];
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        std::cerr << label << " linking failed: " << infoLog << "\n";
+    }
+
+    glDeleteShader(vert);
+    glDeleteShader(frag);
+    return program;
+}
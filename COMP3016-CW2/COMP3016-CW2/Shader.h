@@ -0,0 +1,11 @@
+#pragma once
+
+#define NOMINMAX
+#include <GL/glew.h>
+
+// Shader helpers shared by the scene, sky and post-process passes
+GLuint compileShader(GLenum type, const char* source);
+GLuint createProgram(const char* vertSource, const char* fragSource, const char* label);
+
+// Fullscreen triangle from gl_VertexID (draw 3 vertices with an empty VAO), outputs vUV
+extern const char* fullscreenVertSource;
@@ -0,0 +1,556 @@
+#include "Sky.h"
+#include "Shader.h"
+
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <glm/gtc/type_ptr.hpp>
+
+// LUT sizes (transmittance is indexed by height + view zenith, multi-scattering by height + sun zenith)
+static const int TRANSMITTANCE_W = 256;
+static const int TRANSMITTANCE_H = 64;
+static const int MULTISCAT_SIZE = 32;
+
+static const uint32_t SKY_CACHE_VERSION = 1;
+
+// Shared atmosphere model (units are km, Earth-like parameters)
+static const char* atmosphereCommon = R"(
+const float PI = 3.14159265;
+const float Rg = 6360.0;
+const float Rt = 6460.0;
+
+const vec3  kRayleighScattering = vec3(5.802, 13.558, 33.1) * 1e-3;
+const float kMieScattering = 3.996e-3;
+const float kMieExtinction = 4.440e-3;
+const vec3  kOzoneAbsorption = vec3(0.650, 1.881, 0.085) * 1e-3;
+const vec3  kGroundAlbedo = vec3(0.3);
+
+// nearest non-negative hit distance, -1 on miss
+float raySphere(vec3 ro, vec3 rd, float radius)
+{
+    float b = dot(ro, rd);
+    float c = dot(ro, ro) - radius * radius;
+    float disc = b * b - c;
+    if (disc < 0.0) return -1.0;
+
+    float s = sqrt(disc);
+    float t0 = -b - s;
+    float t1 = -b + s;
+    if (t0 >= 0.0) return t0;
+    if (t1 >= 0.0) return t1;
+    return -1.0;
+}
+
+void sampleMedium(float r, out vec3 scatR, out float scatM, out vec3 extinction)
+{
+    float h = max(r - Rg, 0.0);
+    float rayleighDensity = exp(-h / 8.0);
+    float mieDensity = exp(-h / 1.2);
+    float ozoneDensity = max(0.0, 1.0 - abs(h - 25.0) / 15.0);
+
+    scatR = kRayleighScattering * rayleighDensity;
+    scatM = kMieScattering * mieDensity;
+    extinction = scatR + vec3(kMieExtinction * mieDensity) + kOzoneAbsorption * ozoneDensity;
+}
+
+void uvToTransmittance(vec2 uv, out float r, out float mu)
+{
+    float H = sqrt(Rt * Rt - Rg * Rg);
+    float rho = H * uv.y;
+    r = sqrt(rho * rho + Rg * Rg);
+
+    float dMin = Rt - r;
+    float dMax = rho + H;
+    float d = dMin + uv.x * (dMax - dMin);
+    mu = (d == 0.0) ? 1.0 : (H * H - rho * rho - d * d) / (2.0 * r * d);
+    mu = clamp(mu, -1.0, 1.0);
+}
+
+vec2 transmittanceToUv(float r, float mu)
+{
+    float H = sqrt(Rt * Rt - Rg * Rg);
+    float rho = sqrt(max(r * r - Rg * Rg, 0.0));
+    float disc = r * r * (mu * mu - 1.0) + Rt * Rt;
+    float d = max(-r * mu + sqrt(max(disc, 0.0)), 0.0);
+
+    float dMin = Rt - r;
+    float dMax = rho + H;
+    return vec2((d - dMin) / (dMax - dMin), rho / H);
+}
+
+float earthShadow(vec3 p, vec3 lightDir)
+{
+    return raySphere(p, lightDir, Rg) > 0.0 ? 0.0 : 1.0;
+}
+)";
+
+static const char* transmittanceFragBody = R"(
+in vec2 vUV;
+out vec4 FragColor;
+
+void main()
+{
+    float r, mu;
+    uvToTransmittance(vUV, r, mu);
+
+    vec3 ro = vec3(0.0, r, 0.0);
+    vec3 rd = vec3(sqrt(max(1.0 - mu * mu, 0.0)), mu, 0.0);
+    float tMax = max(raySphere(ro, rd, Rt), 0.0);
+
+    const int STEPS = 40;
+    float dt = tMax / float(STEPS);
+    vec3 opticalDepth = vec3(0.0);
+
+    for (int i = 0; i < STEPS; ++i)
+    {
+        vec3 p = ro + rd * ((float(i) + 0.5) * dt);
+        vec3 scatR, ext;
+        float scatM;
+        sampleMedium(length(p), scatR, scatM, ext);
+        opticalDepth += ext * dt;
+    }
+
+    FragColor = vec4(exp(-opticalDepth), 1.0);
+}
+)";
+
+static const char* multiScatFragBody = R"(
+in vec2 vUV;
+out vec4 FragColor;
+
+uniform sampler2D uTransmittanceLut;
+
+vec3 sampleTransmittance(float r, float mu)
+{
+    return texture(uTransmittanceLut, transmittanceToUv(r, mu)).rgb;
+}
+
+void main()
+{
+    float muS = clamp(vUV.x, 0.0, 1.0) * 2.0 - 1.0;
+    float r = clamp(Rg + clamp(vUV.y, 0.0, 1.0) * (Rt - Rg), Rg + 0.01, Rt - 0.01);
+
+    vec3 ro = vec3(0.0, r, 0.0);
+    vec3 sunDir = vec3(sqrt(max(1.0 - muS * muS, 0.0)), muS, 0.0);
+
+    const int SQRT_DIRS = 8;
+    const int STEPS = 20;
+    const float uniformPhase = 1.0 / (4.0 * PI);
+
+    vec3 lumTotal = vec3(0.0);
+    vec3 fmsTotal = vec3(0.0);
+
+    for (int i = 0; i < SQRT_DIRS; ++i)
+    {
+        for (int j = 0; j < SQRT_DIRS; ++j)
+        {
+            float cosT = 1.0 - 2.0 * (float(i) + 0.5) / float(SQRT_DIRS);
+            float sinT = sqrt(max(1.0 - cosT * cosT, 0.0));
+            float phi = 2.0 * PI * (float(j) + 0.5) / float(SQRT_DIRS);
+            vec3 rd = vec3(sinT * cos(phi), cosT, sinT * sin(phi));
+
+            float tGround = raySphere(ro, rd, Rg);
+            float tTop = raySphere(ro, rd, Rt);
+            bool hitGround = tGround > 0.0;
+            float tMax = hitGround ? tGround : max(tTop, 0.0);
+            float dt = tMax / float(STEPS);
+
+            vec3 lum = vec3(0.0);
+            vec3 fms = vec3(0.0);
+            vec3 throughput = vec3(1.0);
+
+            for (int s = 0; s < STEPS; ++s)
+            {
+                vec3 p = ro + rd * ((float(s) + 0.5) * dt);
+                float pr = length(p);
+                vec3 up = p / pr;
+
+                vec3 scatR, ext;
+                float scatM;
+                sampleMedium(pr, scatR, scatM, ext);
+                vec3 scat = scatR + vec3(scatM);
+                vec3 stepT = exp(-ext * dt);
+                vec3 safeExt = max(ext, vec3(1e-6));
+
+                vec3 sunT = sampleTransmittance(pr, dot(up, sunDir)) * earthShadow(p, sunDir);
+                vec3 S = scat * uniformPhase * sunT;
+                lum += throughput * (S - S * stepT) / safeExt;
+                fms += throughput * (scat - scat * stepT) / safeExt;
+
+                throughput *= stepT;
+            }
+
+            if (hitGround)
+            {
+                vec3 pg = ro + rd * tGround;
+                float muG = dot(normalize(pg), sunDir);
+                lum += throughput * sampleTransmittance(Rg, muG) * max(muG, 0.0) * kGroundAlbedo / PI;
+            }
+
+            lumTotal += lum;
+            fmsTotal += fms;
+        }
+    }
+
+    float invCount = 1.0 / float(SQRT_DIRS * SQRT_DIRS);
+    vec3 L2 = lumTotal * invCount;
+    vec3 fms = fmsTotal * invCount;
+
+    FragColor = vec4(L2 / (vec3(1.0) - fms), 1.0);
+}
+)";
+
+static const char* skyFragBody = R"(
+in vec2 vUV;
+layout (location = 0) out vec4 FragColor;
+layout (location = 1) out vec2 Velocity;
+
+uniform sampler2D uTransmittanceLut;
+uniform sampler2D uMultiScatLut;
+
+uniform mat4 uInvViewProj;   // inverse of proj * rotation-only view
+uniform mat4 uCurrViewProj;  // unjittered, rotation-only (for velocity)
+uniform mat4 uPrevViewProj;
+uniform vec3 uSunDir;
+uniform float uCamHeight;    // km above ground
+
+const float kSunIlluminance = 40.0;
+const float kMoonIlluminance = 0.6;
+
+const vec3 kSunDiscColor = vec3(1.0, 0.95, 0.75) * 400.0;
+const vec3 kMoonDiscColor = vec3(0.75, 0.85, 1.0) * 2.0;
+const float kSunCosRadius = 0.99813;   // ~3.5 degrees
+const float kMoonCosRadius = 0.99854;  // ~3.1 degrees
+
+// Linear radiance floor so the night sky keeps a faint blue instead of going black
+const vec3 kNightFloor = vec3(0.0008, 0.0021, 0.0135);
+
+vec3 sampleTransmittance(float r, float mu)
+{
+    return texture(uTransmittanceLut, transmittanceToUv(r, mu)).rgb;
+}
+
+vec3 sampleMultiScat(float r, float muS)
+{
+    vec2 uv = vec2(muS * 0.5 + 0.5, (r - Rg) / (Rt - Rg));
+    return texture(uMultiScatLut, uv).rgb;
+}
+
+float rayleighPhase(float c)
+{
+    return 3.0 / (16.0 * PI) * (1.0 + c * c);
+}
+
+float miePhase(float c)
+{
+    const float g = 0.8;
+    float k = 3.0 / (8.0 * PI) * (1.0 - g * g) / (2.0 + g * g);
+    return k * (1.0 + c * c) / pow(1.0 + g * g - 2.0 * g * c, 1.5);
+}
+
+float discMask(float cosAngle, float cosRadius)
+{
+    float soft = (1.0 - cosRadius) * 0.15;
+    return smoothstep(cosRadius - soft, cosRadius + soft, cosAngle);
+}
+
+void main()
+{
+    vec4 farPoint = uInvViewProj * vec4(vUV * 2.0 - 1.0, 1.0, 1.0);
+    vec3 rd = normalize(farPoint.xyz / farPoint.w);
+
+    // The sky is at infinity, so only camera rotation moves it on screen
+    vec4 currClip = uCurrViewProj * vec4(rd, 1.0);
+    vec4 prevClip = uPrevViewProj * vec4(rd, 1.0);
+    Velocity = (prevClip.w > 0.0) ? (currClip.xy / currClip.w - prevClip.xy / prevClip.w) * 0.5 : vec2(0.0);
+
+    vec3 ro = vec3(0.0, Rg + uCamHeight, 0.0);
+    vec3 moonDir = -uSunDir;
+
+    float tGround = raySphere(ro, rd, Rg);
+    float tTop = raySphere(ro, rd, Rt);
+    float tMax = (tGround > 0.0) ? tGround : max(tTop, 0.0);
+
+    float cosSun = dot(rd, uSunDir);
+    float cosMoon = dot(rd, moonDir);
+    float phRSun = rayleighPhase(cosSun);
+    float phMSun = miePhase(cosSun);
+    float phRMoon = rayleighPhase(cosMoon);
+    float phMMoon = miePhase(cosMoon);
+
+    // Fixed step count with quadratic distribution: cost does not depend on time of day
+    const int STEPS = 16;
+    vec3 L = vec3(0.0);
+    vec3 throughput = vec3(1.0);
+    float tPrev = 0.0;
+
+    for (int i = 0; i < STEPS; ++i)
+    {
+        float f = (float(i) + 1.0) / float(STEPS);
+        float tNew = tMax * f * f;
+        float dt = tNew - tPrev;
+        float t = tPrev + 0.3 * dt;
+        tPrev = tNew;
+
+        vec3 p = ro + rd * t;
+        float r = length(p);
+        vec3 up = p / r;
+
+        vec3 scatR, ext;
+        float scatM;
+        sampleMedium(r, scatR, scatM, ext);
+        vec3 scat = scatR + vec3(scatM);
+        vec3 stepT = exp(-ext * dt);
+
+        float muS = dot(up, uSunDir);
+        float muM = dot(up, moonDir);
+
+        vec3 sunT = sampleTransmittance(r, muS) * earthShadow(p, uSunDir);
+        vec3 moonT = sampleTransmittance(r, muM) * earthShadow(p, moonDir);
+
+        vec3 S = kSunIlluminance * (sunT * (scatR * phRSun + scatM * phMSun) + sampleMultiScat(r, muS) * scat)
+               + kMoonIlluminance * (moonT * (scatR * phRMoon + scatM * phMMoon) + sampleMultiScat(r, muM) * scat);
+
+        L += throughput * (S - S * stepT) / max(ext, vec3(1e-6));
+        throughput *= stepT;
+    }
+
+    // Sun + moon discs, attenuated by the atmosphere along the view ray
+    if (tGround < 0.0)
+    {
+        vec3 viewT = sampleTransmittance(length(ro), rd.y);
+        L += kSunDiscColor * viewT * discMask(cosSun, kSunCosRadius);
+        L += kMoonDiscColor * viewT * discMask(cosMoon, kMoonCosRadius);
+    }
+
+    // HDR radiance out, exposure/tonemapping happen in the post-process composite
+    float night = 1.0 - smoothstep(-0.10, 0.20, uSunDir.y);
+    L += kNightFloor * night;
+
+    FragColor = vec4(L, 1.0);
+}
+)";
+
+static std::string withCommon(const char* body)
+{
+    return std::string("#version 330 core\n") + atmosphereCommon + body;
+}
+
+// FNV-1a over the model source so any tweak to the atmosphere invalidates the cache
+static uint32_t hashString(const std::string& s)
+{
+    uint32_t h = 2166136261u;
+    for (unsigned char c : s)
+    {
+        h ^= c;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+struct SkyCacheHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t modelHash;
+    uint32_t transmittanceW;
+    uint32_t transmittanceH;
+    uint32_t multiScatSize;
+};
+
+static GLuint createLutTexture(int w, int h, const float* data)
+{
+    GLuint tex = 0;
+    glGenTextures(1, &tex);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, w, h, 0, GL_RGBA, GL_FLOAT, data);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    return tex;
+}
+
+static bool loadSkyCache(SkyRenderer& sky, const char* path, uint32_t modelHash)
+{
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+
+    SkyCacheHeader hdr{};
+    bool ok = fread(&hdr, sizeof(hdr), 1, f) == 1 &&
+        memcmp(hdr.magic, "SKYL", 4) == 0 &&
+        hdr.version == SKY_CACHE_VERSION &&
+        hdr.modelHash == modelHash &&
+        hdr.transmittanceW == TRANSMITTANCE_W &&
+        hdr.transmittanceH == TRANSMITTANCE_H &&
+        hdr.multiScatSize == MULTISCAT_SIZE;
+
+    std::vector<float> trans(TRANSMITTANCE_W * TRANSMITTANCE_H * 4);
+    std::vector<float> ms(MULTISCAT_SIZE * MULTISCAT_SIZE * 4);
+    if (ok)
+    {
+        ok = fread(trans.data(), sizeof(float), trans.size(), f) == trans.size() &&
+            fread(ms.data(), sizeof(float), ms.size(), f) == ms.size();
+    }
+    fclose(f);
+
+    if (!ok) return false;
+
+    sky.transmittanceLut = createLutTexture(TRANSMITTANCE_W, TRANSMITTANCE_H, trans.data());
+    sky.multiScatLut = createLutTexture(MULTISCAT_SIZE, MULTISCAT_SIZE, ms.data());
+    return true;
+}
+
+static void saveSkyCache(const SkyRenderer& sky, const char* path, uint32_t modelHash)
+{
+    std::vector<float> trans(TRANSMITTANCE_W * TRANSMITTANCE_H * 4);
+    std::vector<float> ms(MULTISCAT_SIZE * MULTISCAT_SIZE * 4);
+
+    glBindTexture(GL_TEXTURE_2D, sky.transmittanceLut);
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_FLOAT, trans.data());
+    glBindTexture(GL_TEXTURE_2D, sky.multiScatLut);
+    glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_FLOAT, ms.data());
+
+    FILE* f = fopen(path, "wb");
+    if (!f)
+    {
+        std::cerr << "Could not write sky cache: " << path << "\n";
+        return;
+    }
+
+    SkyCacheHeader hdr{ { 'S', 'K', 'Y', 'L' }, SKY_CACHE_VERSION, modelHash,
+        (uint32_t)TRANSMITTANCE_W, (uint32_t)TRANSMITTANCE_H, (uint32_t)MULTISCAT_SIZE };
+    fwrite(&hdr, sizeof(hdr), 1, f);
+    fwrite(trans.data(), sizeof(float), trans.size(), f);
+    fwrite(ms.data(), sizeof(float), ms.size(), f);
+    fclose(f);
+}
+
+// Render a fullscreen pass into a LUT texture
+static void bakeLut(GLuint program, GLuint target, int w, int h, GLuint vao)
+{
+    GLuint fbo = 0;
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target, 0);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cerr << "Sky LUT framebuffer incomplete\n";
+
+    glViewport(0, 0, w, h);
+    glUseProgram(program);
+    glBindVertexArray(vao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &fbo);
+}
+
+bool initSky(SkyRenderer& sky, const char* cachePath)
+{
+    glGenVertexArrays(1, &sky.emptyVAO);
+
+    std::string skySrc = withCommon(skyFragBody);
+    sky.program = createProgram(fullscreenVertSource, skySrc.c_str(), "Sky");
+
+    glUseProgram(sky.program);
+    glUniform1i(glGetUniformLocation(sky.program, "uTransmittanceLut"), 0);
+    glUniform1i(glGetUniformLocation(sky.program, "uMultiScatLut"), 1);
+    sky.invViewProjLoc = glGetUniformLocation(sky.program, "uInvViewProj");
+    sky.sunDirLoc = glGetUniformLocation(sky.program, "uSunDir");
+    sky.camHeightLoc = glGetUniformLocation(sky.program, "uCamHeight");
+    sky.currViewProjLoc = glGetUniformLocation(sky.program, "uCurrViewProj");
+    sky.prevViewProjLoc = glGetUniformLocation(sky.program, "uPrevViewProj");
+
+    std::string transSrc = withCommon(transmittanceFragBody);
+    std::string msSrc = withCommon(multiScatFragBody);
+    uint32_t modelHash = hashString(transSrc + msSrc);
+
+    if (cachePath && loadSkyCache(sky, cachePath, modelHash))
+        return true;
+
+    // Bake: transmittance first, multi-scattering reads it
+    GLint prevViewport[4];
+    glGetIntegerv(GL_VIEWPORT, prevViewport);
+
+    sky.transmittanceLut = createLutTexture(TRANSMITTANCE_W, TRANSMITTANCE_H, nullptr);
+    sky.multiScatLut = createLutTexture(MULTISCAT_SIZE, MULTISCAT_SIZE, nullptr);
+
+    GLuint transProgram = createProgram(fullscreenVertSource, transSrc.c_str(), "Sky transmittance");
+    GLuint msProgram = createProgram(fullscreenVertSource, msSrc.c_str(), "Sky multi-scattering");
+
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+
+    bakeLut(transProgram, sky.transmittanceLut, TRANSMITTANCE_W, TRANSMITTANCE_H, sky.emptyVAO);
+
+    glUseProgram(msProgram);
+    glUniform1i(glGetUniformLocation(msProgram, "uTransmittanceLut"), 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, sky.transmittanceLut);
+    bakeLut(msProgram, sky.multiScatLut, MULTISCAT_SIZE, MULTISCAT_SIZE, sky.emptyVAO);
+
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBindVertexArray(0);
+    glViewport(prevViewport[0], prevViewport[1], prevViewport[2], prevViewport[3]);
+
+    glDeleteProgram(transProgram);
+    glDeleteProgram(msProgram);
+
+    if (cachePath)
+        saveSkyCache(sky, cachePath, modelHash);
+
+    return true;
+}
+
+void drawSky(const SkyRenderer& sky,
+    const glm::mat4& view,
+    const glm::mat4& proj,
+    const glm::vec3& sunDir,
+    float cameraHeight,
+    const glm::mat4& currViewProjRot,
+    const glm::mat4& prevViewProjRot)
+{
+    // Rotation-only view so the ray origin stays at the camera
+    glm::mat4 invViewProj = glm::inverse(proj * glm::mat4(glm::mat3(view)));
+
+    glUseProgram(sky.program);
+    glUniformMatrix4fv(sky.invViewProjLoc, 1, GL_FALSE, glm::value_ptr(invViewProj));
+    glUniformMatrix4fv(sky.currViewProjLoc, 1, GL_FALSE, glm::value_ptr(currViewProjRot));
+    glUniformMatrix4fv(sky.prevViewProjLoc, 1, GL_FALSE, glm::value_ptr(prevViewProjRot));
+    glUniform3fv(sky.sunDirLoc, 1, glm::value_ptr(sunDir));
+    glUniform1f(sky.camHeightLoc, cameraHeight);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, sky.transmittanceLut);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, sky.multiScatLut);
+
+    // Background pass: no depth test/write, nothing to blend against
+    glDisable(GL_DEPTH_TEST);
+    glDepthMask(GL_FALSE);
+    glDisable(GL_BLEND);
+
+    glBindVertexArray(sky.emptyVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+
+    glEnable(GL_BLEND);
+    glDepthMask(GL_TRUE);
+    glEnable(GL_DEPTH_TEST);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void destroySky(SkyRenderer& sky)
+{
+    if (sky.transmittanceLut) glDeleteTextures(1, &sky.transmittanceLut);
+    if (sky.multiScatLut) glDeleteTextures(1, &sky.multiScatLut);
+    if (sky.program) glDeleteProgram(sky.program);
+    if (sky.emptyVAO) glDeleteVertexArrays(1, &sky.emptyVAO);
+    sky = SkyRenderer{};
+}
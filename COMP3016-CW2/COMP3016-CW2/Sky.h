@@ -0,0 +1,38 @@
+#pragma once
+
+#define NOMINMAX
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+// Physically based sky (Hillaire-style atmosphere)
+// Transmittance + multiple-scattering LUTs are baked once at startup (or read
+// back from a small cache file), then the whole sky including the sun and moon
+// discs is drawn by one fullscreen-triangle pass.
+struct SkyRenderer
+{
+    GLuint transmittanceLut = 0;
+    GLuint multiScatLut = 0;
+    GLuint program = 0;
+    GLuint emptyVAO = 0;
+
+    GLint invViewProjLoc = -1;
+    GLint sunDirLoc = -1;
+    GLint camHeightLoc = -1;
+    GLint currViewProjLoc = -1;
+    GLint prevViewProjLoc = -1;
+};
+
+bool initSky(SkyRenderer& sky, const char* cachePath);
+
+// sunDir points towards the sun, the moon is drawn opposite to it
+// proj may be jittered; the two rotation-only view-projections are unjittered and only feed the velocity output
+void drawSky(const SkyRenderer& sky,
+    const glm::mat4& view,
+    const glm::mat4& proj,
+    const glm::vec3& sunDir,
+    float cameraHeight,
+    const glm::mat4& currViewProjRot,
+    const glm::mat4& prevViewProjRot);
+
+void destroySky(SkyRenderer& sky);
@@ -0,0 +1,162 @@
+#include "StartupTrace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+std::atomic<bool> gTraceEnabled{ false };
+
+struct TraceEvent
+{
+    std::string name;
+    const char* category;
+    int thread;
+    double startUs;
+    double durationUs;
+};
+
+struct TraceThread
+{
+    int id;
+    const char* name;
+};
+
+static std::mutex gTraceMutex;
+static std::vector<TraceEvent> gTraceEvents;
+static std::vector<TraceThread> gTraceThreads;
+static std::chrono::steady_clock::time_point gTraceOrigin = std::chrono::steady_clock::now();
+static std::atomic<int> gNextTraceThread{ 0 };
+
+// Small sequential ids read better in the viewer than OS thread ids
+static int traceThreadId()
+{
+    thread_local int id = gNextTraceThread.fetch_add(1);
+    return id;
+}
+
+void initStartupTrace(bool enabled)
+{
+    gTraceOrigin = std::chrono::steady_clock::now();
+    gTraceEnabled.store(enabled);
+    if (enabled)
+    {
+        gTraceEvents.reserve(1024);
+        setTraceThreadName("main");
+    }
+}
+
+void setTraceThreadName(const char* name)
+{
+    if (!gTraceEnabled.load(std::memory_order_relaxed))
+        return;
+
+    std::lock_guard<std::mutex> lock(gTraceMutex);
+    gTraceThreads.push_back({ traceThreadId(), name });
+}
+
+double traceNowUs()
+{
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - gTraceOrigin).count();
+}
+
+void recordTraceEvent(const char* name, const char* category, double startUs, double durationUs)
+{
+    if (!gTraceEnabled.load(std::memory_order_relaxed))
+        return;
+
+    int thread = traceThreadId();
+    std::lock_guard<std::mutex> lock(gTraceMutex);
+    gTraceEvents.push_back({ name, category, thread, startUs, durationUs });
+}
+
+static void writeJsonString(std::ostream& out, const char* s)
+{
+    out << '"';
+    for (; *s; ++s)
+    {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\')
+            out << '\\' << (char)c;
+        else if (c < 0x20)
+            out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int)c << std::dec << std::setfill(' ');
+        else
+            out << (char)c;
+    }
+    out << '"';
+}
+
+void writeStartupTrace(const char* jsonPath)
+{
+    if (!gTraceEnabled.exchange(false))
+        return;
+
+    // Recording is off now, but a worker may still be inside recordTraceEvent
+    std::lock_guard<std::mutex> lock(gTraceMutex);
+
+    std::ofstream f(jsonPath);
+    if (!f)
+    {
+        std::cerr << "Can't write " << jsonPath << "\n";
+        return;
+    }
+
+    f << std::fixed << std::setprecision(3);
+    f << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    for (const TraceThread& t : gTraceThreads)
+    {
+        f << (first ? "" : ",\n") << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << t.id << ",\"args\":{\"name\":";
+        writeJsonString(f, t.name);
+        f << "}}";
+        first = false;
+    }
+    for (const TraceEvent& e : gTraceEvents)
+    {
+        f << (first ? "" : ",\n") << "{\"ph\":\"X\",\"name\":";
+        writeJsonString(f, e.name.c_str());
+        f << ",\"cat\":";
+        writeJsonString(f, e.category);
+        f << ",\"pid\":1,\"tid\":" << e.thread << ",\"ts\":" << e.startUs << ",\"dur\":" << e.durationUs << "}";
+        first = false;
+    }
+    f << "\n]}\n";
+    f.close();
+
+    // Longest first; nested scopes overlap their parents, so the column doesn't sum to the total
+    std::vector<const TraceEvent*> sorted;
+    double endUs = 0.0;
+    for (const TraceEvent& e : gTraceEvents)
+    {
+        sorted.push_back(&e);
+        endUs = std::max(endUs, e.startUs + e.durationUs);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const TraceEvent* a, const TraceEvent* b)
+        {
+            return a->durationUs > b->durationUs;
+        });
+
+    std::ios_base::fmtflags flags = std::cout.flags();
+    std::streamsize precision = std::cout.precision();
+    std::cout << std::fixed << std::setprecision(1);
+
+    std::cout << "Startup trace: " << gTraceEvents.size() << " events over " << endUs / 1000.0 << " ms, written to " << jsonPath << "\n";
+    std::cout << "  " << std::right << std::setw(10) << "ms" << " " << std::setw(10) << "start" << "  "
+        << std::left << std::setw(3) << "tid" << " " << std::setw(8) << "category" << " name\n";
+    std::cout << std::setprecision(2);
+    for (const TraceEvent* e : sorted)
+    {
+        std::cout << "  " << std::right << std::setw(10) << e->durationUs / 1000.0 << " " << std::setw(10) << e->startUs / 1000.0 << "  "
+            << std::left << std::setw(3) << e->thread << " " << std::setw(8) << e->category << " " << e->name << "\n";
+    }
+
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+
+    gTraceEvents.clear();
+    gTraceEvents.shrink_to_fit();
+}
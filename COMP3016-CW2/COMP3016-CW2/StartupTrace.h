@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+
+// Startup timeline (run with --trace-startup)
+// Scoped events record thread, start and duration for each startup phase and
+// each asset decode/upload. writeStartupTrace dumps them as startup_trace.json
+// (chrome://tracing / Perfetto) and prints a summary sorted by duration.
+// When tracing is off a scope is a single relaxed load of gTraceEnabled.
+extern std::atomic<bool> gTraceEnabled;
+
+void initStartupTrace(bool enabled);
+
+// Labels the calling thread in the trace (the string must outlive the trace)
+void setTraceThreadName(const char* name);
+
+// name is copied, so temporaries like asset paths are fine
+void recordTraceEvent(const char* name, const char* category, double startUs, double durationUs);
+
+double traceNowUs();
+
+// Writes the JSON file and the text summary, then stops recording
+void writeStartupTrace(const char* jsonPath);
+
+// For flat sequences of phases: start = traceBegin(); ...; traceEnd("phase", "startup", start)
+inline double traceBegin()
+{
+    return gTraceEnabled.load(std::memory_order_relaxed) ? traceNowUs() : -1.0;
+}
+
+inline void traceEnd(const char* name, const char* category, double startUs)
+{
+    if (startUs >= 0.0)
+        recordTraceEvent(name, category, startUs, traceNowUs() - startUs);
+}
+
+struct TraceScope
+{
+    const char* name;
+    const char* category;
+    double startUs;
+
+    TraceScope(const char* eventName, const char* eventCategory)
+        : name(eventName), category(eventCategory), startUs(-1.0)
+    {
+        if (gTraceEnabled.load(std::memory_order_relaxed))
+            startUs = traceNowUs();
+    }
+
+    ~TraceScope()
+    {
+        if (startUs >= 0.0)
+            recordTraceEvent(name, category, startUs, traceNowUs() - startUs);
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name, category) TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name, category)
@@ -0,0 +1,237 @@
+#include "Texture.h"
+#include "DdsFormat.h"
+#include "AssetPack.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+static void setSamplerState(const SamplerDesc& sampler)
+{
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, (GLint)sampler.wrapS);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, (GLint)sampler.wrapT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, (GLint)sampler.minFilter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, (GLint)sampler.magFilter);
+}
+
+static GLenum glFormatForFourCC(uint32_t fourCC)
+{
+    // BC1 is uploaded as RGB so alpha reads back as 1, like the uncompressed RGB path
+    if (fourCC == FOURCC_BC1) return GLEW_EXT_texture_compression_s3tc ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : 0;
+    if (fourCC == FOURCC_BC3) return GLEW_EXT_texture_compression_s3tc ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : 0;
+    if (fourCC == FOURCC_BC5) return GL_COMPRESSED_RG_RGTC2;
+    return 0;
+}
+
+// Maps a BC1/BC3/BC5 DDS and records where each level lives, false if it's missing or unusable
+static bool loadCompressedData(TextureData& data, const char* path)
+{
+    if (!openAssetFile(data.file, path))
+        return false;
+
+    const MappedFile& file = data.file;
+    const size_t headerBytes = sizeof(uint32_t) + sizeof(DdsHeader);
+    DdsHeader hdr;
+    uint32_t magic = 0;
+    bool ok = file.size >= headerBytes;
+    if (ok)
+    {
+        memcpy(&magic, file.data, sizeof(magic));
+        memcpy(&hdr, file.data + sizeof(magic), sizeof(hdr));
+        ok = magic == DDS_MAGIC && hdr.size == sizeof(DdsHeader) &&
+            (hdr.pixelFormat.flags & DDPF_FOURCC) && hdr.width > 0 && hdr.height > 0;
+    }
+
+    GLenum format = ok ? glFormatForFourCC(hdr.pixelFormat.fourCC) : 0;
+    if (format == 0)
+    {
+        closeMappedFile(data.file);
+        return false;
+    }
+
+    uint32_t mipCount = (hdr.flags & DDSD_MIPMAPCOUNT) ? std::max(hdr.mipMapCount, 1u) : 1u;
+    mipCount = std::min(mipCount, (uint32_t)TextureData::MAX_LEVELS);
+
+    // A truncated chain is still usable, sampling just stops at the last level present
+    size_t offset = headerBytes;
+    uint32_t w = hdr.width;
+    uint32_t h = hdr.height;
+    int levels = 0;
+    for (uint32_t i = 0; i < mipCount; ++i)
+    {
+        uint32_t bytes = ddsLevelBytes(hdr.pixelFormat.fourCC, w, h);
+        if (offset + bytes > file.size)
+            break;
+
+        data.levelData[levels] = file.data + offset;
+        data.levelBytes[levels] = bytes;
+        ++levels;
+        offset += bytes;
+
+        if (w == 1 && h == 1)
+            break;
+        w = std::max(w / 2, 1u);
+        h = std::max(h / 2, 1u);
+    }
+
+    if (levels == 0)
+    {
+        closeMappedFile(data.file);
+        return false;
+    }
+
+    data.width = (int)hdr.width;
+    data.height = (int)hdr.height;
+    data.compressedFormat = format;
+    data.levelCount = levels;
+    return true;
+}
+
+bool loadTextureData(TextureData& data, const char* path)
+{
+    if (loadCompressedData(data, bakedTexturePath(path).c_str()))
+        return true;
+
+    // Decoded from memory so it works the same for packed and loose files
+    MappedFile source;
+    if (openAssetFile(source, path) && source.size <= (size_t)INT32_MAX)
+    {
+        // Per-thread flag, the global one isn't safe to use from several loader threads
+        stbi_set_flip_vertically_on_load_thread(true);
+        data.pixels = stbi_load_from_memory(source.data, (int)source.size, &data.width, &data.height, &data.channels, 0);
+    }
+    closeMappedFile(source);
+
+    if (!data.pixels)
+    {
+        std::cerr << "Failed to load texture: " << path << "\n";
+        return false;
+    }
+    return true;
+}
+
+static size_t pixelDataBytes(const TextureData& data)
+{
+    return (size_t)data.width * data.height * data.channels;
+}
+
+bool stageTextureData(TextureData& data, UploadRing& ring)
+{
+    size_t total = 0;
+    if (data.levelCount > 0)
+    {
+        for (int level = data.firstLevel; level < data.levelCount; ++level)
+            total += data.levelBytes[level];
+    }
+    else if (data.pixels)
+    {
+        total = pixelDataBytes(data);
+    }
+
+    StagingAllocation alloc;
+    if (total == 0 || !stagingAlloc(ring, total, alloc))
+        return false;
+
+    if (data.levelCount > 0)
+    {
+        size_t offset = 0;
+        for (int level = data.firstLevel; level < data.levelCount; ++level)
+        {
+            memcpy(alloc.ptr + offset, data.levelData[level], data.levelBytes[level]);
+            data.levelOffset[level] = offset;
+            offset += data.levelBytes[level];
+        }
+
+        // Levels above firstLevel are streamed in later, straight from the mapping
+        if (data.firstLevel == 0)
+        {
+            for (int level = 0; level < data.levelCount; ++level)
+                data.levelData[level] = nullptr;
+            closeMappedFile(data.file);
+        }
+    }
+    else
+    {
+        memcpy(alloc.ptr, data.pixels, total);
+        stbi_image_free(data.pixels);
+        data.pixels = nullptr;
+    }
+
+    data.staging = alloc;
+    return true;
+}
+
+GLuint uploadTexture(const TextureData& data, const SamplerDesc& sampler)
+{
+    const bool staged = data.staging.ptr != nullptr;
+    if (data.levelCount == 0 && !data.pixels && !staged)
+        return 0;
+
+    GLuint texID;
+    glGenTextures(1, &texID);
+    glBindTexture(GL_TEXTURE_2D, texID);
+
+    // With a pixel unpack buffer bound the data pointers below are offsets into it
+    if (staged)
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, data.staging.buffer);
+
+    if (data.levelCount > 0)
+    {
+        // Levels come straight out of the mapping (or the ring), there's nothing to decode
+        for (int level = data.firstLevel; level < data.levelCount; ++level)
+        {
+            int w = std::max(data.width >> level, 1);
+            int h = std::max(data.height >> level, 1);
+            const void* levelSource = staged ? (const void*)(uintptr_t)(data.staging.offset + data.levelOffset[level]) : (const void*)data.levelData[level];
+            glCompressedTexImage2D(GL_TEXTURE_2D, level, data.compressedFormat, w, h, 0, (GLsizei)data.levelBytes[level], levelSource);
+        }
+
+        // Levels under firstLevel aren't defined yet, sampling is clamped to what is
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, data.firstLevel);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, data.levelCount - 1);
+    }
+    else
+    {
+        GLenum format = GL_RGB;
+        if (data.channels == 1) format = GL_RED;
+        else if (data.channels == 3) format = GL_RGB;
+        else if (data.channels == 4) format = GL_RGBA;
+
+        glTexImage2D(GL_TEXTURE_2D, 0, format, data.width, data.height, 0, format, GL_UNSIGNED_BYTE, staged ? (const void*)(uintptr_t)data.staging.offset : (const void*)data.pixels);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+
+    if (staged)
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    setSamplerState(sampler);
+    return texID;
+}
+
+void freeTextureData(TextureData& data)
+{
+    closeMappedFile(data.file);
+    if (data.pixels)
+        stbi_image_free(data.pixels);
+
+    data = TextureData();
+}
+
+size_t textureDataGpuBytes(const TextureData& data)
+{
+    if (data.levelCount > 0)
+    {
+        size_t total = 0;
+        for (int level = data.firstLevel; level < data.levelCount; ++level)
+            total += data.levelBytes[level];
+        return total;
+    }
+
+    // Drivers pad RGB to 4 bytes per texel, mips add a third
+    size_t texelBytes = (data.channels == 1) ? 1 : 4;
+    return (size_t)data.width * data.height * texelBytes * 4 / 3;
+}
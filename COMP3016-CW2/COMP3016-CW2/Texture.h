@@ -0,0 +1,66 @@
+#pragma once
+
+#define NOMINMAX
+#include <GL/glew.h>
+
+#include <cstdint>
+
+#include "MappedFile.h"
+#include "UploadRing.h"
+
+// Texture loading
+// Prefers the baked, block-compressed sibling AssetBaker writes next to the
+// source image (same path, .dds extension): its precomputed mips are uploaded
+// as-is with glCompressedTexImage2D. Falls back to decoding the source with
+// stb_image + glGenerateMipmap when there's no bake or S3TC isn't supported.
+// Both are opened through openAssetFile, so they can come from the asset pack.
+
+// Sampler state baked into the texture object (also part of the registry key)
+struct SamplerDesc
+{
+    GLenum wrapS = GL_REPEAT;
+    GLenum wrapT = GL_REPEAT;
+    GLenum minFilter = GL_LINEAR_MIPMAP_LINEAR;
+    GLenum magFilter = GL_LINEAR;
+};
+
+// CPU side of a texture, produced without touching GL (safe on a loader thread)
+struct TextureData
+{
+    static const int MAX_LEVELS = 16;
+
+    int width = 0;
+    int height = 0;
+
+    // Baked DDS: levels point into the mapping
+    MappedFile file;
+    GLenum compressedFormat = 0;
+    int levelCount = 0;
+    const unsigned char* levelData[MAX_LEVELS] = {};
+    uint32_t levelBytes[MAX_LEVELS] = {};
+    int firstLevel = 0;         // finest level uploaded, the rest are left to the mip streamer
+
+    // stb_image fallback
+    unsigned char* pixels = nullptr;
+    int channels = 0;
+
+    // Set by stageTextureData: the levels (or pixels) live in the upload ring instead
+    StagingAllocation staging;
+    size_t levelOffset[MAX_LEVELS] = {};
+};
+
+bool loadTextureData(TextureData& data, const char* path);
+
+// Loader thread: copies the payload into the upload ring and drops the CPU copy
+// (only levels from firstLevel down; with firstLevel > 0 the mapping stays open for streaming)
+// False (data untouched) if the ring is disabled or full; the upload then reads client memory.
+bool stageTextureData(TextureData& data, UploadRing& ring);
+
+// GL thread: creates the texture, returns 0 on failure
+// Staged data is sourced from the ring as a pixel unpack buffer; the caller fences it afterwards.
+GLuint uploadTexture(const TextureData& data, const SamplerDesc& sampler);
+
+void freeTextureData(TextureData& data);
+
+// Bytes the uploaded texture occupies on the GPU (mip chain from firstLevel down)
+size_t textureDataGpuBytes(const TextureData& data);
@@ -0,0 +1,217 @@
+#include "TextureRegistry.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+std::string normalizeTexturePath(const std::string& path)
+{
+    std::vector<std::string> parts;
+    std::string part;
+    bool absolute = !path.empty() && (path[0] == '/' || path[0] == '\\');
+
+    for (size_t i = 0; i <= path.size(); ++i)
+    {
+        char c = (i < path.size()) ? path[i] : '/';
+        if (c == '\\') c = '/';
+#ifdef _WIN32
+        if (c >= 'A' && c <= 'Z') c = (char)(c - 'A' + 'a');
+#endif
+        if (c != '/')
+        {
+            part += c;
+            continue;
+        }
+
+        if (part == "..")
+        {
+            if (!parts.empty() && parts.back() != "..")
+                parts.pop_back();
+            else if (!absolute)
+                parts.push_back(part);
+        }
+        else if (!part.empty() && part != ".")
+        {
+            parts.push_back(part);
+        }
+        part.clear();
+    }
+
+    std::string out = absolute ? "/" : "";
+    for (size_t i = 0; i < parts.size(); ++i)
+    {
+        if (i > 0) out += '/';
+        out += parts[i];
+    }
+    return out;
+}
+
+static std::string makeKey(const std::string& normalized, const SamplerDesc& sampler)
+{
+    std::ostringstream key;
+    key << normalized << std::hex << "|" << (unsigned)sampler.wrapS << "|" << (unsigned)sampler.wrapT
+        << "|" << (unsigned)sampler.minFilter << "|" << (unsigned)sampler.magFilter;
+    return key.str();
+}
+
+TextureHandle acquireTexture(TextureRegistry& registry, const std::string& path, const SamplerDesc& sampler, bool& isNew)
+{
+    std::string normalized = normalizeTexturePath(path);
+    std::string key = makeKey(normalized, sampler);
+
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.requests++;
+    isNew = false;
+
+    auto it = registry.lookup.find(key);
+    if (it != registry.lookup.end())
+    {
+        TextureEntry& entry = registry.entries[it->second];
+        entry.refCount++;
+        entry.acquireCount++;
+        registry.hits++;
+        registry.savedBytes += entry.gpuBytes;    // 0 while loading, settled in setTextureResident
+        return it->second;
+    }
+
+    TextureHandle handle = INVALID_TEXTURE;
+    if (!registry.freeList.empty())
+    {
+        handle = registry.freeList.back();
+        registry.freeList.pop_back();
+    }
+    else if (registry.highWater < TextureRegistry::MAX_TEXTURES)
+    {
+        handle = registry.highWater++;
+    }
+    else
+    {
+        std::cerr << "Texture registry is full, dropping " << path << "\n";
+        return INVALID_TEXTURE;
+    }
+
+    TextureEntry& entry = registry.entries[handle];
+    entry = TextureEntry();
+    entry.key = key;
+    entry.path = normalized;
+    entry.sampler = sampler;
+    entry.refCount = 1;
+    entry.acquireCount = 1;
+    entry.inUse = true;
+
+    registry.lookup[key] = handle;
+    isNew = true;
+    return handle;
+}
+
+void retainTexture(TextureRegistry& registry, TextureHandle handle)
+{
+    if (handle == INVALID_TEXTURE)
+        return;
+
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.entries[handle].refCount++;
+}
+
+// Caller holds the lock
+static void freeEntry(TextureRegistry& registry, TextureHandle handle)
+{
+    TextureEntry& entry = registry.entries[handle];
+    if (registry.onFree)
+        registry.onFree(registry.onFreeUser, handle);
+
+    if (entry.id != 0)
+    {
+        glDeleteTextures(1, &entry.id);
+        registry.residentBytes -= entry.gpuBytes;
+    }
+
+    registry.lookup.erase(entry.key);
+    entry = TextureEntry();
+    registry.freeList.push_back(handle);
+    registry.freed++;
+}
+
+void releaseTexture(TextureRegistry& registry, TextureHandle handle)
+{
+    if (handle == INVALID_TEXTURE)
+        return;
+
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    TextureEntry& entry = registry.entries[handle];
+    if (!entry.inUse || entry.refCount <= 0)
+        return;
+
+    // Still loading: the loader frees it when the upload lands (setTextureResident)
+    if (--entry.refCount == 0 && entry.loaded)
+        freeEntry(registry, handle);
+}
+
+void setTextureResident(TextureRegistry& registry, TextureHandle handle, GLuint id, size_t gpuBytes)
+{
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    TextureEntry& entry = registry.entries[handle];
+    entry.id = id;
+    entry.loaded = true;
+    entry.gpuBytes = (id != 0) ? gpuBytes : 0;
+
+    registry.residentBytes += entry.gpuBytes;
+    registry.peakBytes = std::max(registry.peakBytes, registry.residentBytes);
+    // Everyone who hit while it was loading shared this upload
+    registry.savedBytes += entry.gpuBytes * (size_t)(entry.acquireCount - 1);
+
+    if (entry.refCount == 0)
+        freeEntry(registry, handle);
+}
+
+void setTextureGpuBytes(TextureRegistry& registry, TextureHandle handle, size_t gpuBytes)
+{
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    TextureEntry& entry = registry.entries[handle];
+    if (!entry.inUse || entry.id == 0)
+        return;
+
+    registry.residentBytes = registry.residentBytes - entry.gpuBytes + gpuBytes;
+    registry.peakBytes = std::max(registry.peakBytes, registry.residentBytes);
+    entry.gpuBytes = gpuBytes;
+}
+
+GLuint textureId(const TextureRegistry& registry, TextureHandle handle)
+{
+    if (handle == INVALID_TEXTURE)
+        return 0;
+    return registry.entries[handle].id;
+}
+
+bool textureLoaded(const TextureRegistry& registry, TextureHandle handle)
+{
+    return handle != INVALID_TEXTURE && registry.entries[handle].loaded;
+}
+
+void reportTextureRegistry(TextureRegistry& registry)
+{
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    double hitRate = registry.requests > 0 ? 100.0 * registry.hits / registry.requests : 0.0;
+    std::ostringstream line;
+    line << std::fixed << "Textures: " << registry.requests << " requests, " << registry.hits << " hits ("
+        << std::setprecision(0) << hitRate << "%), " << registry.lookup.size() << " live, " << std::setprecision(1)
+        << registry.residentBytes / (1024.0 * 1024.0) << " MB resident (peak " << registry.peakBytes / (1024.0 * 1024.0)
+        << " MB), " << registry.savedBytes / (1024.0 * 1024.0) << " MB saved by sharing, " << registry.freed << " freed\n";
+    std::cout << line.str();
+}
+
+void destroyTextureRegistry(TextureRegistry& registry)
+{
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (int i = 0; i < registry.highWater; ++i)
+    {
+        TextureEntry& entry = registry.entries[i];
+        if (!entry.inUse)
+            continue;
+
+        std::cerr << "Texture still referenced at shutdown (" << entry.refCount << " refs): " << entry.path << "\n";
+        freeEntry(registry, i);
+    }
+}
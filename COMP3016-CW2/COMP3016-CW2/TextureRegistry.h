@@ -0,0 +1,80 @@
+#pragma once
+
+#define NOMINMAX
+#include <GL/glew.h>
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Texture.h"
+
+// Shared, reference-counted textures
+// Entries are keyed by normalised path + sampler state, so every mesh or model
+// that points at the same image gets the same GL texture. The last release
+// deletes the texture immediately rather than at shutdown.
+typedef int TextureHandle;
+static const TextureHandle INVALID_TEXTURE = -1;
+
+struct TextureEntry
+{
+    std::string key;
+    std::string path;
+    SamplerDesc sampler;
+
+    GLuint id = 0;              // 0 until the loader uploads it (GL thread only)
+    bool loaded = false;        // upload attempted, id stays 0 if it failed
+    size_t gpuBytes = 0;
+    int refCount = 0;
+    int acquireCount = 0;       // acquires before the upload landed count towards savedBytes then
+    bool inUse = false;
+};
+
+struct TextureRegistry
+{
+    static const int MAX_TEXTURES = 256;
+
+    std::mutex mutex;
+    std::unordered_map<std::string, TextureHandle> lookup;
+    TextureEntry entries[MAX_TEXTURES];
+    std::vector<TextureHandle> freeList;
+    int highWater = 0;
+
+    // Stats
+    int requests = 0;
+    int hits = 0;
+    int freed = 0;
+    size_t residentBytes = 0;
+    size_t peakBytes = 0;
+    size_t savedBytes = 0;      // uploads avoided by sharing
+
+    // Optional, called on the GL thread (registry lock held) just before a texture is deleted
+    void (*onFree)(void* user, TextureHandle handle) = nullptr;
+    void* onFreeUser = nullptr;
+};
+
+// Lower-case on Windows, forward slashes, "." and ".." segments folded
+std::string normalizeTexturePath(const std::string& path);
+
+// Thread-safe. Adds a reference; isNew means the caller has to load it and call setTextureResident
+TextureHandle acquireTexture(TextureRegistry& registry, const std::string& path, const SamplerDesc& sampler, bool& isNew);
+void retainTexture(TextureRegistry& registry, TextureHandle handle);
+
+// GL thread. Deletes the GL texture once the last reference is gone
+void releaseTexture(TextureRegistry& registry, TextureHandle handle);
+
+// GL thread, called once the texture is uploaded (id 0 if loading failed)
+void setTextureResident(TextureRegistry& registry, TextureHandle handle, GLuint id, size_t gpuBytes);
+
+// GL thread, for textures whose footprint changes after upload (mip streaming)
+void setTextureGpuBytes(TextureRegistry& registry, TextureHandle handle, size_t gpuBytes);
+
+// GL thread, 0 while still loading or if loading failed
+GLuint textureId(const TextureRegistry& registry, TextureHandle handle);
+bool textureLoaded(const TextureRegistry& registry, TextureHandle handle);
+
+void reportTextureRegistry(TextureRegistry& registry);
+
+// Frees whatever is left and reports entries that were never released
+void destroyTextureRegistry(TextureRegistry& registry);
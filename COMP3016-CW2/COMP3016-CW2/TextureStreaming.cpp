@@ -0,0 +1,395 @@
+#include "TextureStreaming.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+// Frames without a reported use before a texture only wants its tail
+static const int MIP_STREAM_IDLE_FRAMES = 120;
+
+// A level is only dropped for lack of use once it's this many levels finer than wanted (avoids ping-ponging)
+static const int MIP_STREAM_HYSTERESIS = 1;
+
+static void onTextureFreed(void* user, TextureHandle handle);
+
+static void workerMain(TextureStreamer* streamer)
+{
+    for (;;)
+    {
+        int slot;
+        if (streamer->jobs.tryPop(slot))
+        {
+            streamer->queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+            StreamRead& read = streamer->reads[slot];
+
+            // Into the ring if there's room, otherwise just fault the pages in so the GL thread's read is cheap
+            read.staging = StagingAllocation();
+            if (streamer->staging && stagingAlloc(*streamer->staging, read.bytes, read.staging))
+            {
+                memcpy(read.staging.ptr, read.src, read.bytes);
+            }
+            else
+            {
+                volatile unsigned char sink = 0;
+                for (uint32_t i = 0; i < read.bytes; i += 4096)
+                    sink ^= read.src[i];
+                (void)sink;
+            }
+
+            while (!streamer->done.tryPush(slot))
+                std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(streamer->sleepMutex);
+        streamer->wake.wait(lock, [streamer]
+            {
+                return streamer->quit.load() || streamer->queuedJobs.load() > 0;
+            });
+        if (streamer->quit.load())
+            return;
+    }
+}
+
+void initTextureStreamer(TextureStreamer& streamer, TextureRegistry& textures, UploadRing* staging, size_t budgetBytes)
+{
+    streamer.textures = &textures;
+    streamer.staging = (staging && uploadRingEnabled(*staging)) ? staging : nullptr;
+    streamer.budgetBytes = budgetBytes;
+
+    textures.onFree = onTextureFreed;
+    textures.onFreeUser = &streamer;
+
+    streamer.worker = std::thread(workerMain, &streamer);
+}
+
+int mipStreamFirstLevel(const TextureData& data)
+{
+    // Only baked textures have their finer levels on disk to come back to
+    if (data.levelCount < 2 || !data.file.data)
+        return 0;
+
+    for (int level = 0; level < data.levelCount; ++level)
+    {
+        int w = std::max(data.width >> level, 1);
+        int h = std::max(data.height >> level, 1);
+        if (std::max(w, h) <= MIP_STREAM_TAIL_SIZE)
+            return level;
+    }
+    return 0;
+}
+
+static void closeEntry(TextureStreamer& streamer, StreamedTexture& tex)
+{
+    streamer.residentBytes -= tex.residentBytes;
+    closeMappedFile(tex.file);
+    tex = StreamedTexture();
+}
+
+// Registry lock is held, so this must not call back into the registry
+static void onTextureFreed(void* user, TextureHandle handle)
+{
+    TextureStreamer& streamer = *(TextureStreamer*)user;
+    StreamedTexture& tex = streamer.entries[handle];
+    if (!tex.live)
+        return;
+
+    // The worker may still be reading the mapping: the read keeps it open until it comes back,
+    // and the entry is free for the handle's next texture right away
+    if (tex.read >= 0)
+    {
+        streamer.reads[tex.read].orphan = tex.file;
+        tex.file = MappedFile();
+    }
+    closeEntry(streamer, tex);
+}
+
+void registerStreamedTexture(TextureStreamer& streamer, TextureHandle handle, GLuint id, TextureData& data)
+{
+    StreamedTexture& tex = streamer.entries[handle];
+    if (tex.live || id == 0 || data.firstLevel <= 0)
+        return;
+
+    tex.live = true;
+    tex.id = id;
+    tex.file = data.file;
+    data.file = MappedFile();
+    tex.format = data.compressedFormat;
+    tex.width = data.width;
+    tex.height = data.height;
+    tex.levelCount = data.levelCount;
+    for (int level = 0; level < data.levelCount; ++level)
+    {
+        tex.levelData[level] = data.levelData[level];
+        tex.levelBytes[level] = data.levelBytes[level];
+        data.levelData[level] = nullptr;
+    }
+
+    tex.tailLevel = data.firstLevel;
+    tex.residentBase = data.firstLevel;
+    tex.wantedBase = data.firstLevel;
+    for (int level = data.firstLevel; level < data.levelCount; ++level)
+        tex.residentBytes += tex.levelBytes[level];
+
+    streamer.residentBytes += tex.residentBytes;
+    streamer.peakBytes = std::max(streamer.peakBytes, streamer.residentBytes);
+}
+
+void noteTextureUse(TextureStreamer& streamer, TextureHandle handle, float distance, float radius)
+{
+    if (handle == INVALID_TEXTURE)
+        return;
+
+    StreamedTexture& tex = streamer.entries[handle];
+    if (!tex.live)
+        return;
+
+    // Inside the bounds counts as filling the screen
+    float angular = radius / std::max(distance, radius);
+    tex.angularSize = std::max(tex.angularSize, angular);
+    tex.lastUsedFrame = streamer.frame;
+}
+
+static void setBaseLevel(StreamedTexture& tex, int level)
+{
+    glBindTexture(GL_TEXTURE_2D, tex.id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+    tex.residentBase = level;
+}
+
+static void uploadLevel(TextureStreamer& streamer, StreamedTexture& tex, const StreamRead& read)
+{
+    int level = read.level;
+    int w = std::max(tex.width >> level, 1);
+    int h = std::max(tex.height >> level, 1);
+
+    glBindTexture(GL_TEXTURE_2D, tex.id);
+    if (read.staging.ptr)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, read.staging.buffer);
+        glCompressedTexImage2D(GL_TEXTURE_2D, level, tex.format, w, h, 0, (GLsizei)tex.levelBytes[level], (const void*)(uintptr_t)read.staging.offset);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    else
+    {
+        glCompressedTexImage2D(GL_TEXTURE_2D, level, tex.format, w, h, 0, (GLsizei)tex.levelBytes[level], tex.levelData[level]);
+    }
+    setBaseLevel(tex, level);
+
+    tex.residentBytes += tex.levelBytes[level];
+    streamer.residentBytes += tex.levelBytes[level];
+    streamer.peakBytes = std::max(streamer.peakBytes, streamer.residentBytes);
+    streamer.levelsStreamed++;
+    setTextureGpuBytes(*streamer.textures, read.handle, tex.residentBytes);
+}
+
+static void evictLevel(TextureStreamer& streamer, StreamedTexture& tex, TextureHandle handle)
+{
+    int level = tex.residentBase;
+    setBaseLevel(tex, level + 1);
+
+    // Redefine the dropped level as a single block so the driver can release its storage
+    // (levels under BASE_LEVEL don't take part in completeness)
+    static const unsigned char block[16] = {};
+    GLsizei blockBytes = (tex.format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT) ? 8 : 16;
+    glCompressedTexImage2D(GL_TEXTURE_2D, level, tex.format, 4, 4, 0, blockBytes, block);
+
+    tex.residentBytes -= tex.levelBytes[level];
+    streamer.residentBytes -= tex.levelBytes[level];
+    streamer.levelsEvicted++;
+    setTextureGpuBytes(*streamer.textures, handle, tex.residentBytes);
+}
+
+// Victim for freeing memory on behalf of a texture seen at requesterPixels:
+// levels nothing wants any more first, then the least visible texture below the requester
+static int pickEviction(TextureStreamer& streamer, float requesterPixels)
+{
+    int best = -1;
+    bool bestUnwanted = false;
+    float bestPixels = 0.0f;
+    for (int i = 0; i < TextureStreamer::MAX_TEXTURES; ++i)
+    {
+        StreamedTexture& tex = streamer.entries[i];
+        if (!tex.live || tex.read >= 0 || tex.residentBase >= tex.tailLevel)
+            continue;
+
+        bool unwanted = tex.residentBase < tex.wantedBase;
+        if (!unwanted && tex.screenPixels >= requesterPixels)
+            continue;
+
+        if (best < 0 || (unwanted && !bestUnwanted) || (unwanted == bestUnwanted && tex.screenPixels < bestPixels))
+        {
+            best = i;
+            bestUnwanted = unwanted;
+            bestPixels = tex.screenPixels;
+        }
+    }
+    return best;
+}
+
+static bool makeRoom(TextureStreamer& streamer, size_t bytes, float requesterPixels)
+{
+    while (streamer.residentBytes + bytes > streamer.budgetBytes)
+    {
+        int victim = pickEviction(streamer, requesterPixels);
+        if (victim < 0)
+            return false;
+        evictLevel(streamer, streamer.entries[victim], victim);
+    }
+    return true;
+}
+
+void updateTextureStreaming(TextureStreamer& streamer, float viewportHeight, float fovYRadians)
+{
+    // Finished reads: upload them, or drop them if the texture went away meanwhile
+    // (its handle may already belong to another texture, which won't point at this slot)
+    int slot;
+    while (streamer.done.tryPop(slot))
+    {
+        StreamRead& read = streamer.reads[slot];
+        StreamedTexture& tex = streamer.entries[read.handle];
+        streamer.inFlight--;
+
+        if (tex.live && tex.read == slot)
+        {
+            tex.read = -1;
+            uploadLevel(streamer, tex, read);
+        }
+
+        closeMappedFile(read.orphan);
+        if (streamer.staging)
+            stagingSubmit(*streamer.staging, read.staging);
+        read = StreamRead();
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // Wanted level: enough texels for the object's on-screen diameter, assuming its UVs span the texture once
+    float pixelsPerRadian = viewportHeight / (2.0f * std::tan(fovYRadians * 0.5f));
+    for (int i = 0; i < TextureStreamer::MAX_TEXTURES; ++i)
+    {
+        StreamedTexture& tex = streamer.entries[i];
+        if (!tex.live)
+            continue;
+
+        bool idle = tex.lastUsedFrame < 0 || streamer.frame - tex.lastUsedFrame > MIP_STREAM_IDLE_FRAMES;
+        tex.screenPixels = idle ? 0.0f : 2.0f * tex.angularSize * pixelsPerRadian;
+        tex.angularSize = 0.0f;
+
+        int wanted = tex.tailLevel;
+        if (tex.screenPixels > 0.0f)
+        {
+            float texels = (float)std::max(tex.width, tex.height);
+            int level = (int)std::floor(std::log2(std::max(texels / tex.screenPixels, 1.0f)));
+            wanted = std::min(level, tex.tailLevel);
+        }
+
+        // Keep what's already resident unless it's clearly more than needed
+        if (wanted > tex.residentBase && wanted - tex.residentBase <= MIP_STREAM_HYSTERESIS)
+            wanted = tex.residentBase;
+        tex.wantedBase = wanted;
+    }
+
+    // Stream in: the most visible textures with the largest deficit first
+    while (streamer.inFlight < TextureStreamer::MAX_IN_FLIGHT)
+    {
+        int best = -1;
+        for (int i = 0; i < TextureStreamer::MAX_TEXTURES; ++i)
+        {
+            StreamedTexture& tex = streamer.entries[i];
+            if (!tex.live || tex.read >= 0 || tex.wantedBase >= tex.residentBase)
+                continue;
+            if (best < 0 || tex.screenPixels > streamer.entries[best].screenPixels)
+                best = i;
+        }
+        if (best < 0)
+            break;
+
+        StreamedTexture& tex = streamer.entries[best];
+        int level = tex.residentBase - 1;
+        if (!makeRoom(streamer, tex.levelBytes[level], tex.screenPixels))
+        {
+            // Budget is full of things at least as visible, settle for what's resident
+            tex.wantedBase = tex.residentBase;
+            continue;
+        }
+
+        // Fewer than MAX_IN_FLIGHT reads are out, so a slot is free
+        int slot = 0;
+        while (streamer.reads[slot].handle != INVALID_TEXTURE)
+            ++slot;
+
+        StreamRead& read = streamer.reads[slot];
+        read.handle = best;
+        read.level = level;
+        read.src = tex.levelData[level];
+        read.bytes = tex.levelBytes[level];
+        tex.read = slot;
+        streamer.inFlight++;
+        streamer.queuedJobs.fetch_add(1);
+        streamer.jobs.tryPush(slot);     // can't fail, at most MAX_IN_FLIGHT reads
+        {
+            std::lock_guard<std::mutex> lock(streamer.sleepMutex);
+        }
+        streamer.wake.notify_one();
+    }
+
+    // Unneeded levels are given back once over budget even without a request waiting
+    makeRoom(streamer, 0, 0.0f);
+    streamer.frame++;
+}
+
+void reportTextureStreaming(const TextureStreamer& streamer)
+{
+    int streamed = 0;
+    int full = 0;
+    for (const StreamedTexture& tex : streamer.entries)
+    {
+        if (!tex.live)
+            continue;
+        streamed++;
+        if (tex.residentBase == 0)
+            full++;
+    }
+
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(1) << "Mip streaming: " << streamed << " textures (" << full << " at full res), "
+        << streamer.residentBytes / (1024.0 * 1024.0) << " / " << streamer.budgetBytes / (1024.0 * 1024.0) << " MB resident (peak "
+        << streamer.peakBytes / (1024.0 * 1024.0) << " MB), " << streamer.levelsStreamed << " levels streamed, "
+        << streamer.levelsEvicted << " evicted\n";
+    std::cout << line.str();
+}
+
+void destroyTextureStreamer(TextureStreamer& streamer)
+{
+    {
+        std::lock_guard<std::mutex> lock(streamer.sleepMutex);
+        streamer.quit.store(true);
+    }
+    streamer.wake.notify_all();
+    if (streamer.worker.joinable())
+        streamer.worker.join();
+
+    // Reads that never came back, and anything the registry didn't free (it normally has by now)
+    for (StreamRead& read : streamer.reads)
+    {
+        if (streamer.staging && read.staging.ptr)
+            stagingSubmit(*streamer.staging, read.staging);
+        closeMappedFile(read.orphan);
+        read = StreamRead();
+    }
+    for (StreamedTexture& tex : streamer.entries)
+    {
+        if (tex.live)
+            closeEntry(streamer, tex);
+    }
+
+    if (streamer.textures && streamer.textures->onFreeUser == &streamer)
+    {
+        streamer.textures->onFree = nullptr;
+        streamer.textures->onFreeUser = nullptr;
+    }
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#define NOMINMAX
+#include <GL/glew.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "LockFreeQueue.h"
+#include "MappedFile.h"
+#include "Texture.h"
+#include "TextureRegistry.h"
+#include "UploadRing.h"
+
+// Distance-driven mip streaming for baked (DDS) textures
+// The loader only uploads a texture's small tail mips (MIP_STREAM_TAIL_SIZE and
+// below) and clamps GL_TEXTURE_BASE_LEVEL to them. Each frame the renderer
+// reports how large every textured object appears on screen; the streamer
+// turns the largest of those into a wanted base level and pulls finer levels
+// in one at a time. A background thread reads each level out of the DDS
+// mapping into the upload ring, the GL thread uploads it and lowers
+// BASE_LEVEL. Resident bytes are kept under a budget by evicting the finest
+// levels of textures that no longer need them, then of the least visible ones.
+
+// Levels at or below this size are loaded up front and never evicted
+static const int MIP_STREAM_TAIL_SIZE = 128;
+
+struct StreamedTexture
+{
+    bool live = false;
+    int read = -1;                  // slot in TextureStreamer::reads of the level being read, -1 if none
+
+    GLuint id = 0;
+    MappedFile file;                // DDS mapping (or pack view) levels are read from
+    GLenum format = 0;
+    int width = 0;
+    int height = 0;
+    int levelCount = 0;
+    const unsigned char* levelData[TextureData::MAX_LEVELS] = {};
+    uint32_t levelBytes[TextureData::MAX_LEVELS] = {};
+
+    int tailLevel = 0;              // this level and coarser are always resident
+    int residentBase = 0;           // finest level uploaded (GL_TEXTURE_BASE_LEVEL)
+    int wantedBase = 0;
+    size_t residentBytes = 0;
+
+    float angularSize = 0.0f;       // largest radius / distance reported this frame
+    float screenPixels = 0.0f;      // last frame's largest on-screen diameter
+    int lastUsedFrame = -1;
+};
+
+// One level read handed to the worker. It carries everything the worker touches,
+// so the texture can be freed, and its handle reused, while the read runs.
+struct StreamRead
+{
+    TextureHandle handle = INVALID_TEXTURE;     // INVALID_TEXTURE: slot is free
+    int level = -1;
+    const unsigned char* src = nullptr;
+    uint32_t bytes = 0;
+    StagingAllocation staging;      // filled by the worker
+    MappedFile orphan;              // mapping of a texture freed mid-read, closed when the read comes back
+};
+
+struct TextureStreamer
+{
+    static const int MAX_TEXTURES = TextureRegistry::MAX_TEXTURES;
+    static const int MAX_IN_FLIGHT = 4;
+
+    TextureRegistry* textures = nullptr;
+    UploadRing* staging = nullptr;
+    size_t budgetBytes = 0;
+    size_t residentBytes = 0;
+
+    // Indexed by TextureHandle
+    StreamedTexture entries[MAX_TEXTURES];
+
+    // Reads go to the worker and come back by slot
+    StreamRead reads[MAX_IN_FLIGHT];
+    LockFreeQueue<int, MAX_TEXTURES> jobs;
+    LockFreeQueue<int, MAX_TEXTURES> done;
+    std::atomic<int> queuedJobs{ 0 };
+    int inFlight = 0;
+
+    std::thread worker;
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<bool> quit{ false };
+
+    int frame = 0;
+
+    // Stats
+    size_t peakBytes = 0;
+    int levelsStreamed = 0;
+    int levelsEvicted = 0;
+};
+
+// staging may be null; budgetBytes covers every streamed texture, tails included
+void initTextureStreamer(TextureStreamer& streamer, TextureRegistry& textures, UploadRing* staging, size_t budgetBytes);
+
+// Loader thread: finest level to upload now, 0 (everything) if the texture isn't streamed
+int mipStreamFirstLevel(const TextureData& data);
+
+// GL thread, right after uploadTexture for data with firstLevel > 0. Takes over data.file
+void registerStreamedTexture(TextureStreamer& streamer, TextureHandle handle, GLuint id, TextureData& data);
+
+// GL thread: an object using the texture is drawn with this bounding radius at this distance
+void noteTextureUse(TextureStreamer& streamer, TextureHandle handle, float distance, float radius);
+
+// GL thread, once per frame after drawing: uploads finished levels, evicts, queues new reads
+void updateTextureStreaming(TextureStreamer& streamer, float viewportHeight, float fovYRadians);
+
+void reportTextureStreaming(const TextureStreamer& streamer);
+
+// After the registry is destroyed (its frees call back into the streamer), before the upload ring
+void destroyTextureStreamer(TextureStreamer& streamer);
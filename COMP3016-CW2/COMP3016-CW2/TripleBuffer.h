@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+
+// Single-producer/single-consumer triple buffer
+// The writer fills its back buffer and publishes it by swapping it with the
+// shared middle slot; the reader swaps the middle slot with its front buffer
+// when a newer one is there. Neither side ever waits, the reader always sees
+// the latest complete value, and intermediate values the reader was too slow
+// for are simply skipped.
+template <typename T>
+struct TripleBuffer
+{
+    static const int INDEX_MASK = 3;
+    static const int FRESH = 4;     // middle holds a value the reader hasn't taken
+
+    T buffers[3];
+    alignas(64) std::atomic<int> middle{ 1 };
+    alignas(64) int back = 0;       // writer only
+    alignas(64) int front = 2;      // reader only
+
+    TripleBuffer() = default;
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Before either side starts: every slot holds value
+    void reset(const T& value)
+    {
+        for (T& b : buffers)
+            b = value;
+        middle.store(1, std::memory_order_relaxed);
+        back = 0;
+        front = 2;
+    }
+
+    // Writer
+    T& writeBuffer()
+    {
+        return buffers[back];
+    }
+
+    void publish()
+    {
+        int prev = middle.exchange(back | FRESH, std::memory_order_acq_rel);
+        back = prev & INDEX_MASK;
+    }
+
+    // Reader: true if a newer value was taken
+    bool acquire()
+    {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH))
+            return false;
+        int prev = middle.exchange(front, std::memory_order_acq_rel);
+        front = prev & INDEX_MASK;
+        return true;
+    }
+
+    const T& readBuffer() const
+    {
+        return buffers[front];
+    }
+
+    // The front buffer is the reader's until its next acquire, so it may use it as scratch
+    T& readBuffer()
+    {
+        return buffers[front];
+    }
+};
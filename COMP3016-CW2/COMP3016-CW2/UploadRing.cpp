@@ -0,0 +1,171 @@
+#include "UploadRing.h"
+
+#include <cstdint>
+#include <iostream>
+
+// Keeps every block suitably aligned for any pixel/vertex data sourced from it
+static const size_t STAGING_ALIGN = 256;
+
+static size_t alignUp(size_t v, size_t a)
+{
+    return (v + a - 1) & ~(a - 1);
+}
+
+bool initUploadRing(UploadRing& ring, size_t capacity)
+{
+    if (!GLEW_ARB_buffer_storage)
+    {
+        std::cout << "Upload ring: ARB_buffer_storage not available, using synchronous uploads\n";
+        return false;
+    }
+
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    glGenBuffers(1, &ring.buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, ring.buffer);
+    glBufferStorage(GL_COPY_WRITE_BUFFER, (GLsizeiptr)capacity, nullptr, flags);
+    ring.mapped = (unsigned char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, (GLsizeiptr)capacity, flags);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    if (!ring.mapped)
+    {
+        std::cout << "Upload ring: persistent mapping failed, using synchronous uploads\n";
+        glDeleteBuffers(1, &ring.buffer);
+        ring.buffer = 0;
+        return false;
+    }
+
+    ring.capacity = capacity;
+    ring.head = 0;
+    return true;
+}
+
+bool uploadRingEnabled(const UploadRing& ring)
+{
+    return ring.mapped != nullptr;
+}
+
+bool stagingAlloc(UploadRing& ring, size_t bytes, StagingAllocation& out)
+{
+    out = StagingAllocation();
+    if (!ring.mapped || bytes == 0)
+        return false;
+
+    size_t size = alignUp(bytes, STAGING_ALIGN);
+    if (size > ring.capacity)
+        return false;
+
+    std::lock_guard<std::mutex> lock(ring.mutex);
+
+    size_t offset = 0;
+    if (ring.blocks.empty())
+    {
+        offset = 0;
+    }
+    else
+    {
+        size_t tail = ring.blocks.front().offset;
+        if (ring.head > tail)
+        {
+            // Free space is [head, capacity) then [0, tail); the unused end is skipped on wrap
+            if (ring.head + size <= ring.capacity) offset = ring.head;
+            else if (size < tail) offset = 0;
+            else offset = SIZE_MAX;
+        }
+        else
+        {
+            // Wrapped: free space is [head, tail)
+            offset = (ring.head + size < tail) ? ring.head : SIZE_MAX;
+        }
+    }
+
+    if (offset == SIZE_MAX)
+    {
+        ring.fullCount++;
+        return false;
+    }
+
+    StagingBlock block;
+    block.offset = offset;
+    block.size = size;
+    ring.blocks.push_back(block);
+    ring.head = offset + size;
+    ring.stagedBytes += bytes;
+    ring.stagedCount++;
+
+    out.buffer = ring.buffer;
+    out.ptr = ring.mapped + offset;
+    out.offset = offset;
+    out.size = bytes;
+    return true;
+}
+
+void stagingSubmit(UploadRing& ring, const StagingAllocation& alloc)
+{
+    if (!alloc.ptr)
+        return;
+
+    GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    std::lock_guard<std::mutex> lock(ring.mutex);
+    for (StagingBlock& block : ring.blocks)
+    {
+        if (block.offset == alloc.offset && !block.submitted)
+        {
+            block.fence = fence;
+            block.submitted = true;
+            return;
+        }
+    }
+    glDeleteSync(fence);
+}
+
+void retireStaging(UploadRing& ring)
+{
+    if (!ring.mapped)
+        return;
+
+    std::lock_guard<std::mutex> lock(ring.mutex);
+
+    // In ring order only: a block still being written by a loader holds back everything after it
+    while (!ring.blocks.empty())
+    {
+        StagingBlock& block = ring.blocks.front();
+        if (!block.submitted)
+            break;
+
+        GLenum status = glClientWaitSync(block.fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            break;
+
+        glDeleteSync(block.fence);
+        ring.blocks.pop_front();
+    }
+
+    if (ring.blocks.empty())
+        ring.head = 0;
+}
+
+void destroyUploadRing(UploadRing& ring)
+{
+    if (ring.buffer != 0)
+    {
+        // Make sure nothing still reads from the mapping before it goes away
+        glFinish();
+        for (StagingBlock& block : ring.blocks)
+        {
+            if (block.fence) glDeleteSync(block.fence);
+        }
+        ring.blocks.clear();
+
+        glBindBuffer(GL_COPY_WRITE_BUFFER, ring.buffer);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        glDeleteBuffers(1, &ring.buffer);
+    }
+
+    ring.buffer = 0;
+    ring.mapped = nullptr;
+    ring.capacity = 0;
+    ring.head = 0;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#define NOMINMAX
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+// Persistently mapped staging ring for texture and buffer uploads
+// One GL buffer is created with ARB_buffer_storage and mapped once
+// (PERSISTENT | COHERENT). Loader threads allocate blocks from it and write
+// decoded data straight into the mapping. The GL thread then sources
+// glCompressedTexImage2D / glTexImage2D (as GL_PIXEL_UNPACK_BUFFER) or
+// glCopyBufferSubData from the block and fences it. Blocks are recycled in
+// ring order once their fence has signalled, and allocation never blocks:
+// when the ring is full the caller keeps its data in client memory and takes
+// the old synchronous path. Without ARB_buffer_storage the ring is disabled
+// and every upload takes that path.
+struct StagingAllocation
+{
+    GLuint buffer = 0;
+    unsigned char* ptr = nullptr;   // null when the data wasn't staged
+    size_t offset = 0;              // into the ring buffer
+    size_t size = 0;
+};
+
+struct StagingBlock
+{
+    size_t offset = 0;
+    size_t size = 0;
+    GLsync fence = nullptr;
+    bool submitted = false;
+};
+
+struct UploadRing
+{
+    GLuint buffer = 0;
+    unsigned char* mapped = nullptr;
+    size_t capacity = 0;
+
+    std::mutex mutex;
+    size_t head = 0;
+    std::deque<StagingBlock> blocks;    // oldest first
+
+    // Stats
+    size_t stagedBytes = 0;
+    int stagedCount = 0;
+    int fullCount = 0;                  // allocations refused because the ring was full
+};
+
+// GL thread. Returns false (and leaves the ring disabled) without ARB_buffer_storage
+bool initUploadRing(UploadRing& ring, size_t capacity);
+
+bool uploadRingEnabled(const UploadRing& ring);
+
+// Any thread, never blocks. False if the ring is disabled or has no room right now
+bool stagingAlloc(UploadRing& ring, size_t bytes, StagingAllocation& out);
+
+// GL thread, after the copies sourcing the block have been issued (or if it won't be used)
+void stagingSubmit(UploadRing& ring, const StagingAllocation& alloc);
+
+// GL thread, recycles blocks whose copies have finished (non-blocking fence checks)
+void retireStaging(UploadRing& ring);
+
+void destroyUploadRing(UploadRing& ring);
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+// Bounded Chase-Lev work-stealing deque (fences as in Le et al., "Correct and
+// Efficient Work-Stealing for Weak Memory Models")
+// The owning thread pushes and pops at the bottom like a stack, so it works on
+// its most recently spawned (cache-warm) items; other threads steal from the
+// top, taking the oldest and usually largest pieces of work. Only a pop racing
+// a steal for the last item needs a CAS. Capacity must be a power of two and T
+// must fit in an atomic (pointers, indices).
+template <typename T, size_t Capacity>
+struct WorkStealingDeque
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    std::atomic<T> items[Capacity];
+    alignas(64) std::atomic<int64_t> top{ 0 };
+    alignas(64) std::atomic<int64_t> bottom{ 0 };
+
+    WorkStealingDeque() = default;
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    // Heap-allocated by the job system, and plain new only honours the 64-byte
+    // member alignment from C++17 on
+    static void* operator new(size_t size)
+    {
+#ifdef _WIN32
+        void* p = _aligned_malloc(size, 64);
+#else
+        void* p = aligned_alloc(64, (size + 63) & ~(size_t)63);
+#endif
+        if (!p)
+            throw std::bad_alloc();
+        return p;
+    }
+
+    static void operator delete(void* p)
+    {
+#ifdef _WIN32
+        _aligned_free(p);
+#else
+        free(p);
+#endif
+    }
+
+    // Owner only, false when full
+    bool push(T value)
+    {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_acquire);
+        if (b - t >= (int64_t)Capacity)
+            return false;
+
+        items[b & (Capacity - 1)].store(value, std::memory_order_relaxed);
+        bottom.store(b + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Owner only, false when empty
+    bool pop(T& out)
+    {
+        int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+
+        if (t > b)
+        {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        out = items[b & (Capacity - 1)].load(std::memory_order_relaxed);
+        if (t != b)
+            return true;
+
+        // Last item: whoever moves top first gets it
+        bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return won;
+    }
+
+    // Any thread, false when empty or another thief got there first
+    bool steal(T& out)
+    {
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b)
+            return false;
+
+        T value = items[t & (Capacity - 1)].load(std::memory_order_relaxed);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return false;
+
+        out = value;
+        return true;
+    }
+};
@@ -0,0 +1,408 @@
+#include "WorldStream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+static int floorDiv(float v, float size)
+{
+    return (int)floorf(v / size);
+}
+
+static glm::ivec2 eyeChunk(const WorldStream& stream, const glm::vec3& eye)
+{
+    return glm::ivec2(floorDiv(eye.x, stream.chunkSize), floorDiv(eye.z, stream.chunkSize));
+}
+
+// Chebyshev distance in chunks: the load and unload regions are squares
+static int chunkDistance(glm::ivec2 a, glm::ivec2 b)
+{
+    return std::max(std::abs(a.x - b.x), std::abs(a.y - b.y));
+}
+
+// Background job: terrain vertices and scatter for the slot's chunk, nothing shared is written
+static void generateChunkJob(void* data, int index)
+{
+    WorldStream& stream = *(WorldStream*)data;
+    StreamChunk& chunk = *stream.chunks[index];
+    auto start = std::chrono::steady_clock::now();
+
+    // Vertices in world space, normals from the height function itself so neighbouring chunks agree at the seams
+    const int side = STREAM_CHUNK_QUADS + 1;
+    const float s = stream.spacing;
+    const float uvScale = 0.2f;
+    glm::vec2 origin = glm::vec2(chunk.coord) * stream.chunkSize;
+    float minY = 1e30f;
+    float maxY = -1e30f;
+    for (int z = 0; z < side; ++z)
+    {
+        for (int x = 0; x < side; ++x)
+        {
+            float wx = origin.x + x * s;
+            float wz = origin.y + z * s;
+            float y = stream.height(wx, wz);
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+
+            glm::vec3 dx(2.0f * s, stream.height(wx + s, wz) - stream.height(wx - s, wz), 0.0f);
+            glm::vec3 dz(0.0f, stream.height(wx, wz + s) - stream.height(wx, wz - s), 2.0f * s);
+            glm::vec3 n = glm::normalize(glm::cross(dz, dx));
+
+            BakedVertex& v = chunk.vertices[(size_t)z * side + x];
+            v.position[0] = wx; v.position[1] = y;   v.position[2] = wz;
+            v.normal[0] = n.x;  v.normal[1] = n.y;   v.normal[2] = n.z;
+            v.uv[0] = wx * uvScale;
+            v.uv[1] = wz * uvScale;
+        }
+    }
+    chunk.minHeight = minY;
+    chunk.maxHeight = maxY;
+
+    // Same layers everywhere, reseeded per chunk
+    if (!stream.layers.empty())
+    {
+        ScatterArea area;
+        area.min = origin + glm::vec2(stream.layerMargin);
+        area.max = origin + glm::vec2(stream.chunkSize - stream.layerMargin);
+        area.height = stream.height;
+        area.keepoutCenter = stream.keepoutCenter;
+        area.keepoutRadius = stream.keepoutRadius;
+
+        for (size_t i = 0; i < stream.layers.size(); ++i)
+            chunk.layers[i].seed = hashScatter(stream.layers[i].seed, (uint32_t)chunk.coord.x, (uint32_t)chunk.coord.y);
+        scatterPoisson(area, chunk.layers.data(), (int)chunk.layers.size(), chunk.points.data(), nullptr);
+    }
+
+    chunk.generateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    chunk.state.store(CHUNK_GENERATED, std::memory_order_release);
+}
+
+void initWorldStream(WorldStream& stream, JobSystem& jobs, float (*height)(float x, float z), float spacing,
+    const SceneFile* scene, const Model* const* models)
+{
+    stream.jobs = &jobs;
+    stream.height = height;
+    stream.spacing = spacing;
+    stream.chunkSize = STREAM_CHUNK_QUADS * spacing;
+
+    // Props and layers from the scene; baked instances belong to its fixed map and are left out
+    if (scene && scene->header)
+    {
+        const SceneHeader& hdr = *scene->header;
+        for (uint32_t i = 0; i < hdr.propCount; ++i)
+        {
+            StreamProp prop;
+            prop.model = models[i];
+            prop.collisionRadius = scene->props[i].collisionRadius;
+            stream.props.push_back(prop);
+        }
+        for (uint32_t i = 0; i < hdr.scatterCount; ++i)
+        {
+            stream.layers.push_back(sceneScatterLayer(scene->scatters[i]));
+            stream.layerProp.push_back((int)scene->scatters[i].prop);
+            stream.layerMargin = std::max(stream.layerMargin, scene->scatters[i].radius * 0.5f);
+        }
+        stream.keepoutCenter = glm::vec2(hdr.spawn[0], hdr.spawn[1]);
+        stream.keepoutRadius = hdr.spawnClearRadius;
+    }
+
+    // Offsets in load order: nearest ring first, so the ground under the camera comes in before the horizon
+    for (int z = -STREAM_LOAD_RADIUS; z <= STREAM_LOAD_RADIUS; ++z)
+        for (int x = -STREAM_LOAD_RADIUS; x <= STREAM_LOAD_RADIUS; ++x)
+            stream.loadOrder.push_back(glm::ivec2(x, z));
+    std::stable_sort(stream.loadOrder.begin(), stream.loadOrder.end(), [](glm::ivec2 a, glm::ivec2 b)
+        {
+            return a.x * a.x + a.y * a.y < b.x * b.x + b.y * b.y;
+        });
+
+    int window = 2 * STREAM_UNLOAD_RADIUS + 1;
+    stream.resident.assign((size_t)window * window, -1);
+
+    // One index buffer for every chunk, split like generateTerrain's
+    const int side = STREAM_CHUNK_QUADS + 1;
+    std::vector<uint32_t> indices;
+    indices.reserve((size_t)STREAM_CHUNK_QUADS * STREAM_CHUNK_QUADS * 6);
+    for (int z = 0; z < STREAM_CHUNK_QUADS; ++z)
+    {
+        for (int x = 0; x < STREAM_CHUNK_QUADS; ++x)
+        {
+            uint32_t topLeft = z * side + x;
+            uint32_t topRight = z * side + x + 1;
+            uint32_t bottomLeft = (z + 1) * side + x;
+            uint32_t bottomRight = (z + 1) * side + x + 1;
+            indices.insert(indices.end(), { topLeft, bottomLeft, topRight, topRight, bottomLeft, bottomRight });
+        }
+    }
+    stream.indexCount = (int)indices.size();
+    glGenBuffers(1, &stream.indexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, stream.indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)(indices.size() * sizeof(uint32_t)), indices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    // The pool: every chunk the unload window can hold, plus ones still generating after the camera moved on
+    // Buffers are allocated once here and only ever overwritten
+    int slots = window * window + STREAM_MAX_GENERATING;
+    const GLsizeiptr vertexBytes = (GLsizeiptr)side * side * sizeof(BakedVertex);
+    for (int i = 0; i < slots; ++i)
+    {
+        std::unique_ptr<StreamChunk> chunk(new StreamChunk());
+        chunk->vertices.resize((size_t)side * side);
+        chunk->layers = stream.layers;
+        chunk->points.resize(stream.layers.size());
+
+        glGenVertexArrays(1, &chunk->vao);
+        glGenBuffers(1, &chunk->vbo);
+        glBindVertexArray(chunk->vao);
+        glBindBuffer(GL_ARRAY_BUFFER, chunk->vbo);
+        glBufferData(GL_ARRAY_BUFFER, vertexBytes, nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, stream.indexBuffer);
+
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(BakedVertex), (void*)offsetof(BakedVertex, position));
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(BakedVertex), (void*)offsetof(BakedVertex, normal));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(BakedVertex), (void*)offsetof(BakedVertex, uv));
+        glEnableVertexAttribArray(2);
+        glBindVertexArray(0);
+
+        stream.chunks.push_back(std::move(chunk));
+        stream.freeSlots.push_back(slots - 1 - i);
+    }
+    stream.ready.reserve((size_t)slots);
+
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(1) << "World stream: " << slots << " slots of " << STREAM_CHUNK_QUADS << "x"
+        << STREAM_CHUNK_QUADS << " quads (" << slots * vertexBytes / (1024.0 * 1024.0) << " MB of vertex buffers), load radius "
+        << STREAM_LOAD_RADIUS << ", " << stream.layers.size() << " scatter layers\n";
+    std::cout << line.str();
+}
+
+// Returns true if it took solid props with it
+static bool unloadChunk(WorldStream& stream, World& world, int slot)
+{
+    StreamChunk& chunk = *stream.chunks[slot];
+    bool solid = false;
+    if (chunk.state.load(std::memory_order_relaxed) == CHUNK_LOADED)
+    {
+        for (Entity e : chunk.entities)
+            destroyEntity(world, e);
+        stream.propCount -= chunk.entities.size();
+        chunk.entities.clear();
+        solid = chunk.solid;
+        chunk.solid = false;
+        --stream.loadedCount;
+        ++stream.chunksUnloaded;
+    }
+    chunk.state.store(CHUNK_FREE, std::memory_order_relaxed);
+    stream.freeSlots.push_back(slot);
+    return solid;
+}
+
+// One bulk create per prop, filled like placeSceneProps
+static void spawnChunkProps(WorldStream& stream, World& world, StreamChunk& chunk)
+{
+    for (size_t p = 0; p < stream.props.size(); ++p)
+    {
+        const StreamProp& prop = stream.props[p];
+        size_t count = 0;
+        for (size_t l = 0; l < stream.layers.size(); ++l)
+            if (stream.layerProp[l] == (int)p)
+                count += chunk.points[l].size();
+        if (!prop.model || count == 0)
+            continue;
+
+        ComponentMask mask = componentMask<Transform, RenderMesh, TransformDirty, WorldMatrix, WorldBounds, Visibility>();
+        if (prop.collisionRadius > 0.0f)
+        {
+            mask |= componentMask<CircleCollider>();
+            chunk.solid = true;
+        }
+
+        uint32_t firstRow = 0;
+        Archetype& a = world.archetypes[createEntities(world, mask, count, firstRow)];
+        Transform* transforms = (Transform*)archetypeColumn(a, componentId<Transform>()) + firstRow;
+        RenderMesh* meshes = (RenderMesh*)archetypeColumn(a, componentId<RenderMesh>()) + firstRow;
+        CircleCollider* colliders = (prop.collisionRadius > 0.0f) ?
+            (CircleCollider*)archetypeColumn(a, componentId<CircleCollider>()) + firstRow : nullptr;
+
+        size_t row = 0;
+        for (size_t l = 0; l < stream.layers.size(); ++l)
+        {
+            if (stream.layerProp[l] != (int)p)
+                continue;
+            for (const ScatterPoint& pt : chunk.points[l])
+            {
+                transforms[row].position = glm::vec3(pt.x, stream.height(pt.x, pt.z), pt.z);
+                transforms[row].rotY = pt.rotY;
+                transforms[row].scale = pt.scale;
+                meshes[row].model = prop.model;
+                if (colliders)
+                    colliders[row].radius = prop.collisionRadius;
+                ++row;
+            }
+        }
+        chunk.entities.insert(chunk.entities.end(), a.entities.begin() + firstRow, a.entities.begin() + firstRow + count);
+    }
+
+    stream.propCount += chunk.entities.size();
+    stream.peakPropCount = std::max(stream.peakPropCount, stream.propCount);
+}
+
+bool updateWorldStream(WorldStream& stream, World& world, const glm::vec3& eye)
+{
+    glm::ivec2 center = eyeChunk(stream, eye);
+    bool collidersChanged = false;
+
+    // Unload what the camera has left behind, note what's resident in the window, collect finished chunks
+    std::fill(stream.resident.begin(), stream.resident.end(), -1);
+    stream.ready.clear();
+    stream.generating = 0;
+    const int window = 2 * STREAM_UNLOAD_RADIUS + 1;
+    for (int i = 0; i < (int)stream.chunks.size(); ++i)
+    {
+        StreamChunk& chunk = *stream.chunks[i];
+        int state = chunk.state.load(std::memory_order_acquire);
+        if (state == CHUNK_FREE)
+            continue;
+
+        // A job still owns it: leave it be, even if it's out of range by now
+        bool inRange = chunkDistance(chunk.coord, center) <= STREAM_UNLOAD_RADIUS;
+        if (state == CHUNK_GENERATING)
+            ++stream.generating;
+        if (state == CHUNK_GENERATING && !inRange)
+            continue;
+        if (!inRange)
+        {
+            collidersChanged = unloadChunk(stream, world, i) || collidersChanged;
+            continue;
+        }
+
+        glm::ivec2 local = chunk.coord - center + glm::ivec2(STREAM_UNLOAD_RADIUS);
+        stream.resident[(size_t)local.y * window + local.x] = i;
+        if (state == CHUNK_GENERATED)
+            stream.ready.push_back(i);
+    }
+
+    // Upload the nearest finished chunks, a few a frame so arrivals never spike the frame time
+    std::sort(stream.ready.begin(), stream.ready.end(), [&](int a, int b)
+        {
+            glm::ivec2 da = stream.chunks[a]->coord - center;
+            glm::ivec2 db = stream.chunks[b]->coord - center;
+            return da.x * da.x + da.y * da.y < db.x * db.x + db.y * db.y;
+        });
+    int uploads = std::min((int)stream.ready.size(), STREAM_UPLOADS_PER_FRAME);
+    for (int i = 0; i < uploads; ++i)
+    {
+        StreamChunk& chunk = *stream.chunks[stream.ready[i]];
+        glBindBuffer(GL_ARRAY_BUFFER, chunk.vbo);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)(chunk.vertices.size() * sizeof(BakedVertex)), chunk.vertices.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        spawnChunkProps(stream, world, chunk);
+        collidersChanged = collidersChanged || chunk.solid;
+        chunk.state.store(CHUNK_LOADED, std::memory_order_relaxed);
+        ++stream.loadedCount;
+        ++stream.chunksGenerated;
+        stream.generateMs += chunk.generateMs;
+    }
+
+    // Request missing chunks, nearest first, keeping a few in flight so a turn doesn't queue stale work
+    for (const glm::ivec2& offset : stream.loadOrder)
+    {
+        if (stream.generating >= STREAM_MAX_GENERATING || stream.freeSlots.empty())
+            break;
+
+        glm::ivec2 local = offset + glm::ivec2(STREAM_UNLOAD_RADIUS);
+        if (stream.resident[(size_t)local.y * window + local.x] >= 0)
+            continue;
+
+        int slot = stream.freeSlots.back();
+        stream.freeSlots.pop_back();
+        StreamChunk& chunk = *stream.chunks[slot];
+        chunk.coord = center + offset;
+        chunk.state.store(CHUNK_GENERATING, std::memory_order_relaxed);
+        stream.resident[(size_t)local.y * window + local.x] = slot;
+        ++stream.generating;
+
+        // Background jobs only run on workers; without any the chunk is built here instead of never
+        if (stream.jobs->workers.empty())
+            generateChunkJob(&stream, slot);
+        else
+            submitJob(*stream.jobs, generateChunkJob, &stream, slot, nullptr, nullptr, JOB_BACKGROUND);
+    }
+
+    return collidersChanged;
+}
+
+bool worldStreamSettled(const WorldStream& stream, const glm::vec3& eye)
+{
+    glm::ivec2 center = eyeChunk(stream, eye);
+    int loaded = 0;
+    for (const auto& chunk : stream.chunks)
+        if (chunk->state.load(std::memory_order_relaxed) == CHUNK_LOADED &&
+            chunkDistance(chunk->coord, center) <= STREAM_LOAD_RADIUS)
+            ++loaded;
+    return loaded == (int)stream.loadOrder.size();
+}
+
+void drawWorldStream(const WorldStream& stream, const CullContext& cull)
+{
+    for (const auto& chunk : stream.chunks)
+    {
+        if (chunk->state.load(std::memory_order_relaxed) != CHUNK_LOADED)
+            continue;
+
+        // Bounding sphere of the chunk's box
+        float half = stream.chunkSize * 0.5f;
+        float halfY = (chunk->maxHeight - chunk->minHeight) * 0.5f;
+        glm::vec3 center(chunk->coord.x * stream.chunkSize + half, chunk->minHeight + halfY,
+            chunk->coord.y * stream.chunkSize + half);
+        float radius = sqrtf(2.0f * half * half + halfY * halfY);
+
+        bool inside = true;
+        for (const glm::vec4& p : cull.planes)
+        {
+            if (glm::dot(glm::vec3(p), center) + p.w < -radius)
+            {
+                inside = false;
+                break;
+            }
+        }
+        if (!inside)
+            continue;
+
+        glBindVertexArray(chunk->vao);
+        glDrawElements(GL_TRIANGLES, (GLsizei)stream.indexCount, GL_UNSIGNED_INT, 0);
+    }
+    glBindVertexArray(0);
+}
+
+void destroyWorldStream(WorldStream& stream, World& world)
+{
+    for (int i = 0; i < (int)stream.chunks.size(); ++i)
+    {
+        StreamChunk& chunk = *stream.chunks[i];
+        if (chunk.state.load(std::memory_order_relaxed) == CHUNK_LOADED)
+            unloadChunk(stream, world, i);
+        glDeleteVertexArrays(1, &chunk.vao);
+        glDeleteBuffers(1, &chunk.vbo);
+    }
+    glDeleteBuffers(1, &stream.indexBuffer);
+    stream.chunks.clear();
+    stream.freeSlots.clear();
+    stream.indexBuffer = 0;
+}
+
+void reportWorldStream(const WorldStream& stream)
+{
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(2) << "World stream: " << stream.chunksGenerated << " chunks generated ("
+        << (stream.chunksGenerated > 0 ? stream.generateMs / stream.chunksGenerated : 0.0) << " ms each), "
+        << stream.chunksUnloaded << " unloaded, " << stream.loadedCount << " loaded now; " << stream.propCount
+        << " props now, " << stream.peakPropCount << " at most\n";
+    std::cout << line.str();
+}
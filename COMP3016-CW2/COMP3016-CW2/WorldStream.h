@@ -0,0 +1,126 @@
+#pragma once
+
+#define NOMINMAX
+#include <GL/glew.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Ecs.h"
+#include "JobSystem.h"
+#include "MeshFormat.h"
+#include "Scatter.h"
+#include "Scene.h"
+#include "SceneLoader.h"
+
+// Streamed open world
+// The ground is cut into square chunks of STREAM_CHUNK_QUADS quads. Every chunk
+// within the load radius of the camera gets a terrain mesh and its props, both
+// generated on a background job from the height function and the scene's
+// scatter layers, with each layer reseeded from (layer seed, chunk) so a chunk
+// comes back the same every time it's revisited. Chunks live in a fixed pool of
+// slots, each with its own vertex buffer (all chunks share one index buffer,
+// the grid is the same everywhere): chunks beyond the unload radius give their
+// slot back, and a slot's CPU and GPU memory is reused by the next chunk, so
+// memory stays flat however far the camera goes. The GL thread takes at most
+// STREAM_UPLOADS_PER_FRAME finished chunks a frame, uploading the vertices and
+// bulk-spawning the props into the world.
+//
+// Points are kept half the largest layer radius inside each chunk, so the
+// spacing still holds across chunk borders without looking at the neighbours.
+
+static const int STREAM_CHUNK_QUADS = 64;
+static const int STREAM_LOAD_RADIUS = 4;        // chunks around the camera's, in each direction
+static const int STREAM_UNLOAD_RADIUS = STREAM_LOAD_RADIUS + 1;     // one ring of slack so edges don't thrash
+static const int STREAM_MAX_GENERATING = 4;
+static const int STREAM_UPLOADS_PER_FRAME = 2;
+
+enum ChunkState
+{
+    CHUNK_FREE,
+    CHUNK_GENERATING,       // a job owns the slot's CPU data
+    CHUNK_GENERATED,        // waiting for the GL thread
+    CHUNK_LOADED
+};
+
+struct StreamChunk
+{
+    std::atomic<int> state{ CHUNK_FREE };
+    glm::ivec2 coord{ 0 };
+
+    GLuint vao = 0;
+    GLuint vbo = 0;
+
+    // Written by the generation job, reused by every chunk the slot holds
+    std::vector<BakedVertex> vertices;
+    std::vector<ScatterLayer> layers;                   // the stream's, reseeded for this chunk
+    std::vector<std::vector<ScatterPoint>> points;     // by scatter layer
+    float minHeight = 0.0f;
+    float maxHeight = 0.0f;
+    double generateMs = 0.0;
+
+    std::vector<Entity> entities;
+    bool solid = false;                 // some of them have colliders
+};
+
+struct StreamProp
+{
+    const Model* model = nullptr;       // null: its layers are generated (for spacing) but not spawned
+    float collisionRadius = 0.0f;
+};
+
+struct WorldStream
+{
+    JobSystem* jobs = nullptr;
+    float (*height)(float x, float z) = nullptr;
+    float spacing = 1.0f;               // world units per quad
+    float chunkSize = 0.0f;             // world units per chunk
+
+    std::vector<StreamProp> props;
+    std::vector<ScatterLayer> layers;
+    std::vector<int> layerProp;         // by layer
+    float layerMargin = 0.0f;
+    glm::vec2 keepoutCenter{ 0.0f };
+    float keepoutRadius = 0.0f;
+
+    std::vector<std::unique_ptr<StreamChunk>> chunks;     // the pool; slots never move
+    std::vector<int> freeSlots;
+    std::vector<int> resident;          // slot per cell of the unload window, -1 if none (scratch)
+    std::vector<glm::ivec2> loadOrder;  // offsets within the load radius, nearest first
+    std::vector<int> ready;             // scratch
+    GLuint indexBuffer = 0;
+    int indexCount = 0;
+    int generating = 0;
+
+    // Stats
+    int loadedCount = 0;
+    int chunksGenerated = 0;
+    int chunksUnloaded = 0;
+    double generateMs = 0.0;
+    size_t propCount = 0;
+    size_t peakPropCount = 0;
+};
+
+// GL thread. The scene supplies the props and scatter layers (null: bare terrain);
+// models has one entry per scene prop, as for placeSceneProps
+void initWorldStream(WorldStream& stream, JobSystem& jobs, float (*height)(float x, float z), float spacing,
+    const SceneFile* scene, const Model* const* models);
+
+// After the job system is gone (it may still have been writing into the pool)
+void destroyWorldStream(WorldStream& stream, World& world);
+
+// GL thread, once per frame and not while systems run: unloads, uploads and
+// requests chunks around eye. Returns true if the solid props changed, so the
+// collision grid needs rebuilding.
+bool updateWorldStream(WorldStream& stream, World& world, const glm::vec3& eye);
+
+// Every chunk in the load radius around eye is resident
+bool worldStreamSettled(const WorldStream& stream, const glm::vec3& eye);
+
+// Binds each loaded chunk inside the frustum and draws it (program, uniforms and texture are the caller's)
+void drawWorldStream(const WorldStream& stream, const CullContext& cull);
+
+void reportWorldStream(const WorldStream& stream);
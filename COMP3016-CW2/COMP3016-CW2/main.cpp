@@ -1,9 +1,17 @@
 #include <iostream>
+#include <iomanip>
+#include <sstream>
 #include <vector>
 #include <cmath>
 #include <string>
 #include <algorithm>
 #include <random>
+#include <thread>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
 #define NOMINMAX
 #include <GL/glew.h>
@@ -13,14 +21,26 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
-// ASSIMP
-#include <assimp/Importer.hpp>
-#include <assimp/scene.h>
-#include <assimp/postprocess.h>
-
-// stb_image for texture loading
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
+#include "Shader.h"
+#include "Sky.h"
+#include "PostProcess.h"
+#include "GpuProfiler.h"
+#include "DynamicResolution.h"
+#include "Model.h"
+#include "Texture.h"
+#include "AssetLoader.h"
+#include "AssetPack.h"
+#include "StartupTrace.h"
+#include "Collision.h"
+#include "Ecs.h"
+#include "Scene.h"
+#include "SceneLoader.h"
+#include "Scatter.h"
+#include "WorldStream.h"
+#include "Heightfield.h"
+#include "JobSystem.h"
+#include "LockFreeQueue.h"
+#include "TripleBuffer.h"
 
 // Audio
 #include <irrKlang.h>
@@ -37,13 +57,21 @@ GLFWwindow* gWindow = nullptr;
 int gFBWidth = WIDTH;
 int gFBHeight = HEIGHT;
 
-// Camera state
-glm::vec3 cameraPos = glm::vec3(0.0f, 3.0f, 8.0f);
-glm::vec3 cameraFront = glm::vec3(0.0f, -0.3f, -1.0f);
-glm::vec3 cameraUp = glm::vec3(0.0f, 1.0f, 0.0f);
+// Player (camera) state, owned by the simulation thread once it starts
+struct PlayerState
+{
+    glm::vec3 position = glm::vec3(0.0f, 3.0f, 8.0f);
+    glm::vec3 prevPosition = glm::vec3(0.0f);   // at the previous tick
+    glm::vec3 front = glm::vec3(0.0f, -0.3f, -1.0f);
+    float yaw = -90.0f;
+    float pitch = -15.0f;
+    float verticalVelocity = 0.0f;
+    bool grounded = false;
+    bool flashlightOn = false;                  // starts off
+};
 
-float yaw = -90.0f;
-float pitch = -15.0f;
+PlayerState gPlayer;
+glm::vec3 cameraUp = glm::vec3(0.0f, 1.0f, 0.0f);
 
 double lastX = WIDTH * 0.5;
 double lastY = HEIGHT * 0.5;
@@ -51,13 +79,18 @@ double lastY = HEIGHT * 0.5;
 bool firstMouse = true;
 bool mouseLocked = true;
 
-// timing
-float deltaTime = 0.0f;
-float lastFrame = 0.0f;
+// Fixed-step simulation: movement, gravity, collision and the day/night clock tick
+// at 120 Hz on their own thread; rendering interpolates the camera between the
+// last two ticks
+static const double SIM_TICK_SECONDS = 1.0 / 120.0;
+static const int SIM_MAX_CATCH_UP_TICKS = 8;    // after a hitch, drop the backlog instead of spiralling
 
 // keep player inside terrain
 float worldLimit = 50.0f;
 
+// --open-world: terrain and props stream in around the camera instead, with no bounds
+bool gOpenWorld = false;
+
 // fullscreen toggle state
 bool fullscreen = false;
 int  windowedX = 100;
@@ -75,44 +108,99 @@ float walkSpeed = 5.0f;
 float runMultiplier = 2.0f;
 float gravity = 20.0f;
 float jumpSpeed = 8.0f;
-float verticalVelocity = 0.0f;
-bool  isGrounded = false;
 float eyeHeight = 1.5f;
 
-// Match rendering scales
-const float TREE_RENDER_SCALE = 2.0f;
-const float ROCK_RENDER_SCALE = 1.0f;
-
-// Base collision sizes for the *unscaled* model
-float treeCollisionBaseRadius = 0.55f;
-float rockCollisionBaseRadius = 0.60f;
-
 // Collision
 float playerRadius = 0.45f;
 
-// Approx radii in world units
-float treeCollisionRadius = 0.55f;
-float rockCollisionRadius = 0.60f;
+// Broadphase over the solid props (built once after placement by the collision system)
+static CollisionGrid gPropCollision;
+
+// Open world: the render thread rebuilds it as chunks come and go, the simulation takes the latest
+static TripleBuffer<CollisionGrid> gStreamCollision;
+
+// Simulation thread
+// Owns the camera/player state, look angles, flashlight and day/night clock. GLFW
+// callbacks (main thread) forward input through gInputEvents; each tick publishes
+// an immutable snapshot through gSimSnapshots, and the renderer only reads those.
+enum InputEventType
+{
+    INPUT_KEY,
+    INPUT_LOOK
+};
 
-// Scene instances
-struct SceneInstance
+struct InputEvent
 {
-    glm::vec3 pos{ 0.0f };
-    float rotY = 0.0f;
-    float scale = 1.0f;
+    InputEventType type = INPUT_KEY;
+    int key = 0;
+    int action = 0;
+    float dx = 0.0f;        // look offsets in degrees
+    float dy = 0.0f;
 };
 
-// Instances for collisions + rendering (populated in main)
-static std::vector<SceneInstance> treeInstances;
-static std::vector<SceneInstance> rockInstances;
+struct SimSnapshot
+{
+    uint64_t tick = 0;
+    double time = 0.0;      // glfwGetTime at which the tick was due
+
+    glm::vec3 cameraPos{ 0.0f };
+    glm::vec3 prevCameraPos{ 0.0f };
+    glm::vec3 cameraFront{ 0.0f, 0.0f, -1.0f };
+
+    glm::vec3 lightDir{ 0.0f, -1.0f, 0.0f };
+    glm::vec3 lightColor{ 1.0f };
+    bool flashlightOn = false;
+};
+
+static LockFreeQueue<InputEvent, 256> gInputEvents;
+static TripleBuffer<SimSnapshot> gSimSnapshots;
+static std::thread gSimThread;
+static std::atomic<bool> gSimQuit{ false };
+static bool gSimKeys[GLFW_KEY_LAST + 1] = {};   // held keys as the simulation has seen them
+
+static bool simKeyDown(int key)
+{
+    return gSimKeys[key];
+}
+
+static void forwardInput(const InputEvent& e)
+{
+    // Only drops if the simulation has stalled for hundreds of events
+    gInputEvents.tryPush(e);
+}
 
 // Day/Night cycle
 bool  gDayNightEnabled = true;
 float gCycleSeconds = 60.0f;  // full day length in seconds
 float gTimeScale = 1.0f;    // speed multiplier
 
-// Flashlight state
-bool flashlightOn = false; // starts off
+// Dynamic resolution (scene render scale driven by GPU frame time)
+DynamicResolution gDynRes;
+
+// Temporal AA / upsampling (scene rendered at up to 75% and accumulated to full resolution)
+bool gTaaEnabled = true;
+const float TAA_MAX_RENDER_SCALE = 0.75f;
+
+// Periodic GPU/CPU timing report in the console
+bool gProfilerReport = false;
+
+// GL time per frame spent uploading streamed assets
+const double ASSET_UPLOAD_BUDGET_MS = 2.0;
+
+// Packed assets written by AssetBaker --pack; loose files under assets/ are used when it's missing
+const char* ASSET_PACK_PATH = "assets.pack";
+
+// Terrain and prop layout, baked by AssetBaker from assets/default.scn (--scene overrides it)
+const char* DEFAULT_SCENE_PATH = "assets/default.scene";
+
+// Written when the game is started with --trace-startup
+const char* STARTUP_TRACE_PATH = "startup_trace.json";
+
+// VRAM the mip streamer may fill with baked textures (--texture-budget-mb overrides it)
+const size_t TEXTURE_STREAM_BUDGET_MB = 128;
+
+// Persistently mapped staging memory the loader threads write decoded assets into
+const size_t UPLOAD_RING_BYTES = 32 * 1024 * 1024;
 
 // Ambient sound state
 bool gAmbientIsNight = false;
@@ -120,17 +208,23 @@ bool gAmbientPlaying = false;
 
 static ISoundEngine* gSoundEngine = nullptr;
 
-static void playFlashlightSound(bool on)
+// Main thread, once the pack is mounted: the device keeps thread affinity, so it's
+// created and played on thread 0 only
+static void initSoundEngine()
 {
+    gSoundEngine = createIrrKlangDevice();
     if (!gSoundEngine)
     {
-        gSoundEngine = createIrrKlangDevice();
-        if (!gSoundEngine)
-        {
-            std::cerr << "Failed to create irrKlang sound engine\n";
-            return;
-        }
+        std::cerr << "Failed to create irrKlang sound engine\n";
+        return;
     }
+    installPackFileFactory(gSoundEngine);
+}
+
+static void playFlashlightSound(bool on)
+{
+    if (!gSoundEngine)
+        return;
 
     const char* base = "assets/audio/";
     const char* candidatesOn[] = { "Flashlight.wav" };
@@ -170,8 +264,7 @@ static glm::vec3 lerp3(const glm::vec3& a, const glm::vec3& b, float t)
 
 static void computeDayNight(float t,
     glm::vec3& outLightDir,
-    glm::vec3& outLightColor,
-    glm::vec3& outSkyColor)
+    glm::vec3& outLightColor)
 {
     const float TWO_PI = 6.28318530718f;
 
@@ -200,41 +293,6 @@ static void computeDayNight(float t,
 
     float intensity = 0.20f + day * (1.0f - 0.20f);
     outLightColor = baseLight * intensity;
-
-    glm::vec3 nightSky = glm::vec3(0.02f, 0.03f, 0.07f);
-    glm::vec3 daySky = glm::vec3(0.45f, 0.70f, 0.95f);
-    glm::vec3 dawnSky = glm::vec3(0.65f, 0.35f, 0.25f);
-
-    glm::vec3 skyDay = lerp3(daySky, dawnSky, horizon * 0.85f);
-    outSkyColor = lerp3(nightSky, skyDay, day);
-}
-
-// Billboard model for sun/moon (faces camera)
-static glm::mat4 makeBillboardModel(const glm::vec3& worldPos, float size, const glm::mat4& view)
-{
-    glm::mat4 model(1.0f);
-    model = glm::translate(model, worldPos);
-
-    glm::mat3 rot = glm::mat3(view);
-    glm::mat3 invRot = glm::transpose(rot);
-
-    model *= glm::mat4(invRot);
-    model = glm::scale(model, glm::vec3(size));
-    return model;
-}
-
-static float horizonFade(const glm::vec3& worldPos, const glm::mat4& view, const glm::mat4& proj)
-{
-    glm::vec4 clip = proj * view * glm::vec4(worldPos, 1.0f);
-    if (clip.w <= 0.0001f) return 0.0f; 
-
-    float ndcY = clip.y / clip.w; 
-    return smoothstepf(-0.10f, 0.25f, ndcY);
-}
-
-static float lookUpFade(const glm::vec3& camFront)
-{
-    return smoothstepf(-0.15f, 0.20f, camFront.y);
 }
 
 // Shaders main 
@@ -248,15 +306,25 @@ layout (location = 2) in vec2 aTexCoord;
 uniform mat4 u_Model;
 uniform mat4 u_MVP;
 
+// Unjittered current/previous transforms for the velocity buffer
+uniform mat4 u_PrevModel;
+uniform mat4 u_CurrViewProj;
+uniform mat4 u_PrevViewProj;
+uniform mat3 u_NormalMatrix;    // inverse transpose of u_Model, built on the CPU once per object
+
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoord;
+out vec4 CurrClip;
+out vec4 PrevClip;
 
 void main()
 {
     gl_Position = u_MVP * vec4(aPos, 1.0);
+    CurrClip = u_CurrViewProj * u_Model * vec4(aPos, 1.0);
+    PrevClip = u_PrevViewProj * u_PrevModel * vec4(aPos, 1.0);
     FragPos = vec3(u_Model * vec4(aPos, 1.0));
-    Normal  = mat3(transpose(inverse(u_Model))) * aNormal;
+    Normal  = u_NormalMatrix * aNormal;
     TexCoord = aTexCoord;
 }
 )";
@@ -267,8 +335,11 @@ const char* fragmentShaderSource = R"(
 in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoord;
+in vec4 CurrClip;
+in vec4 PrevClip;
 
-out vec4 FragColor;
+layout (location = 0) out vec4 FragColor;
+layout (location = 1) out vec2 Velocity;
 
 uniform sampler2D uTexture;
 uniform vec3 uLightDir;
@@ -289,6 +360,9 @@ void main()
     vec4 texSample = texture(uTexture, TexCoord);
     if (texSample.a < 0.1) discard;
 
+    // Textures are authored in sRGB, light in linear HDR
+    texSample.rgb = pow(texSample.rgb, vec3(2.2));
+
     vec3 norm     = normalize(Normal);
     vec3 lightDir = normalize(-uLightDir);
     float diff    = max(dot(norm, lightDir), 0.0);
@@ -334,110 +408,13 @@ void main()
     }
 
     FragColor = vec4(result, texSample.a);
+    Velocity = (CurrClip.xy / CurrClip.w - PrevClip.xy / PrevClip.w) * 0.5;
 }
 )";
 
-// Shaders  billboards 
-const char* billboardVert = R"(
-#version 330 core
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec2 aUV;
-
-uniform mat4 u_MVP;
-out vec2 vUV;
-
-void main() {
-    vUV = aUV;
-    gl_Position = u_MVP * vec4(aPos, 1.0);
-}
-)";
-
-const char* billboardFrag = R"(
-#version 330 core
-in vec2 vUV;
-out vec4 FragColor;
-
-uniform vec3 uColor;
-uniform float uSoftness;
-uniform float uAlpha;
-
-void main() {
-    vec2 p = vUV - vec2(0.5);
-    float r = length(p);
-
-    float radius = 0.48;
-    float mask = 1.0 - smoothstep(radius - uSoftness, radius + uSoftness, r);
-
-    float a = mask * uAlpha;
-    if (a < 0.01) discard;
-
-    FragColor = vec4(uColor, a);
-}
-)";
-
-GLuint compileShader(GLenum type, const char* source)
-{
-    GLuint shader = glCreateShader(type);
-    glShaderSource(shader, 1, &source, nullptr);
-    glCompileShader(shader);
-
-    GLint success = 0;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        char infoLog[512];
-        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
-        std::cerr << "Shader compilation failed: " << infoLog << "\n";
-    }
-    return shader;
-}
-
 GLuint createShaderProgram()
 {
-    GLuint vert = compileShader(GL_VERTEX_SHADER, vertexShaderSource);
-    GLuint frag = compileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
-
-    GLuint program = glCreateProgram();
-    glAttachShader(program, vert);
-    glAttachShader(program, frag);
-    glLinkProgram(program);
-
-    GLint success = 0;
-    glGetProgramiv(program, GL_LINK_STATUS, &success);
-    if (!success)
-    {
-        char infoLog[512];
-        glGetProgramInfoLog(program, 512, nullptr, infoLog);
-        std::cerr << "Program linking failed: " << infoLog << "\n";
-    }
-
-    glDeleteShader(vert);
-    glDeleteShader(frag);
-    return program;
-}
-
-GLuint createBillboardProgram()
-{
-    GLuint vert = compileShader(GL_VERTEX_SHADER, billboardVert);
-    GLuint frag = compileShader(GL_FRAGMENT_SHADER, billboardFrag);
-
-    GLuint program = glCreateProgram();
-    glAttachShader(program, vert);
-    glAttachShader(program, frag);
-    glLinkProgram(program);
-
-    GLint success = 0;
-    glGetProgramiv(program, GL_LINK_STATUS, &success);
-    if (!success)
-    {
-        char infoLog[512];
-        glGetProgramInfoLog(program, 512, nullptr, infoLog);
-        std::cerr << "Billboard linking failed: " << infoLog << "\n";
-    }
-
-    glDeleteShader(vert);
-    glDeleteShader(frag);
-    return program;
+    return createProgram(vertexShaderSource, fragmentShaderSource, "Program");
 }
 
 // Terrain generation
@@ -449,94 +426,94 @@ float sampleTerrainHeight(float worldX, float worldZ)
     return h;
 }
 
-void generateTerrain(int size, float spacing,
-    std::vector<float>& vertices,
-    std::vector<unsigned int>& indices)
+static float terrainGridCoord(int i, int gridSize, float spacing)
+{
+    return (i - gridSize / 2.0f) * spacing;
+}
+
+int terrainVertexCount(int size)
+{
+    return (size + 1) * (size + 1);
+}
+
+int terrainIndexCount(int size)
 {
-    vertices.clear();
-    indices.clear();
+    return size * size * 6;
+}
 
+// Writes straight into (write-only, possibly mapped) buffers sized with the two
+// functions above; nothing is read back, so it's fine on write-combined memory
+// Rows are independent, so they're split over jobs (null = all on the caller)
+void generateTerrain(int size, float spacing, BakedVertex* vertices, uint32_t* indices, JobSystem* jobs)
+{
     int gridSize = size;
     int vertPerSide = gridSize + 1;
-    int vertCount = vertPerSide * vertPerSide;
-
-    std::vector<glm::vec3> positions(vertCount);
-    std::vector<glm::vec3> normals(vertCount, glm::vec3(0.0f));
-    std::vector<glm::vec2> uvs(vertCount);
 
     float uvScale = 0.2f;
 
-    for (int z = 0; z < vertPerSide; ++z)
-    {
-        for (int x = 0; x < vertPerSide; ++x)
+    // One height sample per grid point, kept in ordinary memory for the normals to read
+    std::vector<float> heights((size_t)vertPerSide * vertPerSide);
+    parallelFor(jobs, vertPerSide, 16, [&](int zBegin, int zEnd)
         {
-            int i = z * vertPerSide + x;
-
-            float worldX = (x - gridSize / 2.0f) * spacing;
-            float worldZ = (z - gridSize / 2.0f) * spacing;
-            float h = sampleTerrainHeight(worldX, worldZ);
-
-            positions[i] = glm::vec3(worldX, h, worldZ);
-            uvs[i] = glm::vec2(worldX * uvScale, worldZ * uvScale);
-        }
-    }
+            for (int z = zBegin; z < zEnd; ++z)
+            {
+                float worldZ = terrainGridCoord(z, gridSize, spacing);
+                for (int x = 0; x < vertPerSide; ++x)
+                    heights[(size_t)z * vertPerSide + x] = sampleTerrainHeight(terrainGridCoord(x, gridSize, spacing), worldZ);
+            }
+        });
 
-    for (int z = 0; z < vertPerSide; ++z)
-    {
-        for (int x = 0; x < vertPerSide; ++x)
+    parallelFor(jobs, vertPerSide, 16, [&](int zBegin, int zEnd)
         {
-            int i = z * vertPerSide + x;
-
-            int xL = std::max(x - 1, 0);
-            int xR = std::min(x + 1, gridSize);
-            int zD = std::max(z - 1, 0);
-            int zU = std::min(z + 1, gridSize);
-
-            glm::vec3 left = positions[z * vertPerSide + xL];
-            glm::vec3 right = positions[z * vertPerSide + xR];
-            glm::vec3 down = positions[zD * vertPerSide + x];
-            glm::vec3 up = positions[zU * vertPerSide + x];
-
-            glm::vec3 dx = right - left;
-            glm::vec3 dz = up - down;
-
-            normals[i] = glm::normalize(glm::cross(dz, dx));
-        }
-    }
-
-    vertices.reserve(vertCount * 8);
-    for (int i = 0; i < vertCount; ++i)
-    {
-        vertices.push_back(positions[i].x);
-        vertices.push_back(positions[i].y);
-        vertices.push_back(positions[i].z);
-
-        vertices.push_back(normals[i].x);
-        vertices.push_back(normals[i].y);
-        vertices.push_back(normals[i].z);
-
-        vertices.push_back(uvs[i].x);
-        vertices.push_back(uvs[i].y);
-    }
+            for (int z = zBegin; z < zEnd; ++z)
+            {
+                const float* row = heights.data() + (size_t)z * vertPerSide;
+                for (int x = 0; x < vertPerSide; ++x)
+                {
+                    glm::vec3 pos(terrainGridCoord(x, gridSize, spacing), row[x], terrainGridCoord(z, gridSize, spacing));
+
+                    // Central differences over the neighbouring grid points (one-sided at the edges)
+                    int xL = std::max(x - 1, 0);
+                    int xR = std::min(x + 1, gridSize);
+                    int zD = std::max(z - 1, 0);
+                    int zU = std::min(z + 1, gridSize);
+
+                    glm::vec3 dx((xR - xL) * spacing, row[xR] - row[xL], 0.0f);
+                    glm::vec3 dz(0.0f, heights[(size_t)zU * vertPerSide + x] - heights[(size_t)zD * vertPerSide + x], (zU - zD) * spacing);
+                    glm::vec3 n = glm::normalize(glm::cross(dz, dx));
+
+                    BakedVertex v;
+                    v.position[0] = pos.x; v.position[1] = pos.y; v.position[2] = pos.z;
+                    v.normal[0] = n.x;     v.normal[1] = n.y;     v.normal[2] = n.z;
+                    v.uv[0] = pos.x * uvScale;
+                    v.uv[1] = pos.z * uvScale;
+                    vertices[z * vertPerSide + x] = v;
+                }
+            }
+        });
 
-    for (int z = 0; z < gridSize; ++z)
-    {
-        for (int x = 0; x < gridSize; ++x)
+    parallelFor(jobs, gridSize, 32, [&](int zBegin, int zEnd)
         {
-            int topLeft = z * vertPerSide + x;
-            int topRight = z * vertPerSide + x + 1;
-            int bottomLeft = (z + 1) * vertPerSide + x;
-            int bottomRight = (z + 1) * vertPerSide + x + 1;
-
-            indices.push_back(topLeft);
-            indices.push_back(bottomLeft);
-            indices.push_back(topRight);
-
-            indices.push_back(topRight);
-            indices.push_back(bottomLeft);
-            indices.push_back(bottomRight);
-        }
-    }
+            for (int z = zBegin; z < zEnd; ++z)
+            {
+                for (int x = 0; x < gridSize; ++x)
+                {
+                    uint32_t topLeft = z * vertPerSide + x;
+                    uint32_t topRight = z * vertPerSide + x + 1;
+                    uint32_t bottomLeft = (z + 1) * vertPerSide + x;
+                    uint32_t bottomRight = (z + 1) * vertPerSide + x + 1;
+
+                    uint32_t* quad = indices + (z * gridSize + x) * 6;
+                    quad[0] = topLeft;
+                    quad[1] = bottomLeft;
+                    quad[2] = topRight;
+
+                    quad[3] = topRight;
+                    quad[4] = bottomLeft;
+                    quad[5] = bottomRight;
+                }
+            }
+        });
 }
 
 // Fullscreen toggle
@@ -588,23 +565,26 @@ void cursor_pos_callback(GLFWwindow*, double xpos, double ypos)
     lastY = ypos;
 
     float sensitivity = 0.1f;
-    xoffset *= sensitivity;
-    yoffset *= sensitivity;
-
-    yaw += xoffset;
-    pitch += yoffset;
-
-    pitch = std::max(-89.0f, std::min(89.0f, pitch));
 
-    glm::vec3 front;
-    front.x = cosf(glm::radians(yaw)) * cosf(glm::radians(pitch));
-    front.y = sinf(glm::radians(pitch));
-    front.z = sinf(glm::radians(yaw)) * cosf(glm::radians(pitch));
-    cameraFront = glm::normalize(front);
+    InputEvent e;
+    e.type = INPUT_LOOK;
+    e.dx = xoffset * sensitivity;
+    e.dy = yoffset * sensitivity;
+    forwardInput(e);
 }
 
 void key_callback(GLFWwindow* window, int key, int, int action, int)
 {
+    // Held keys and gameplay toggles belong to the simulation; window/render toggles stay here
+    if (action != GLFW_REPEAT && key >= 0 && key <= GLFW_KEY_LAST)
+    {
+        InputEvent e;
+        e.type = INPUT_KEY;
+        e.key = key;
+        e.action = action;
+        forwardInput(e);
+    }
+
     if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
     {
         if (mouseLocked)
@@ -621,22 +601,25 @@ void key_callback(GLFWwindow* window, int key, int, int action, int)
     if (key == GLFW_KEY_F11 && action == GLFW_PRESS)
         toggleFullscreen();
 
-    if (key == GLFW_KEY_N && action == GLFW_PRESS)
-        gDayNightEnabled = !gDayNightEnabled;
-
-    if (key == GLFW_KEY_K && action == GLFW_PRESS)
-        gTimeScale = std::min(10.0f, gTimeScale + 0.25f);
-
-    if (key == GLFW_KEY_J && action == GLFW_PRESS)
-        gTimeScale = std::max(0.25f, gTimeScale - 0.25f);
+    // Toggle temporal AA
+    if (key == GLFW_KEY_T && action == GLFW_PRESS)
+    {
+        gTaaEnabled = !gTaaEnabled;
+        std::cout << "TAA: " << (gTaaEnabled ? "ON" : "OFF") << "\n";
+    }
 
-    // Toggle flashlight
-    if (key == GLFW_KEY_F && action == GLFW_PRESS)
+    // Toggle dynamic resolution
+    if (key == GLFW_KEY_R && action == GLFW_PRESS)
     {
-        flashlightOn = !flashlightOn;
-        std::cout << "Flashlight: " << (flashlightOn ? "ON" : "OFF") << "\n";
+        gDynRes.enabled = !gDynRes.enabled;
+        std::cout << "Dynamic resolution: " << (gDynRes.enabled ? "ON" : "OFF") << "\n";
+    }
 
-        playFlashlightSound(flashlightOn);
+    // Toggle the profiler report
+    if (key == GLFW_KEY_P && action == GLFW_PRESS)
+    {
+        gProfilerReport = !gProfilerReport;
+        std::cout << "Profiler report: " << (gProfilerReport ? "ON" : "OFF") << "\n";
     }
 }
 
@@ -668,287 +651,484 @@ void window_focus_callback(GLFWwindow*, int focused)
     }
 }
 
-static void resolveCircleCollisions(
-    glm::vec3& playerPos,
-    const std::vector<SceneInstance>& trees,
-    const std::vector<SceneInstance>& rocks,
-    float playerRadius,
-    float treeBaseRadius,
-    float rockBaseRadius,
-    float treeRenderScale,
-    float rockRenderScale)
+// Prop drawing (GL, so main thread): reads WorldMatrix, WorldBounds, RenderMesh, Visibility
+struct PropRenderContext
+{
+    glm::mat4 viewProj{ 1.0f };     // jittered, for drawing
+    GLint modelLoc = -1;
+    GLint mvpLoc = -1;
+    GLint prevModelLoc = -1;
+    GLint normalMatrixLoc = -1;
+    GLuint fallbackTex = 0;         // for submeshes without a diffuse texture
+    TextureStreamer* streamer = nullptr;
+};
+
+static void propRenderSystem(World& world, void* context)
 {
-    glm::vec2 p(playerPos.x, playerPos.z);
+    PropRenderContext& ctx = *(PropRenderContext*)context;
+    const Model* bound = nullptr;
 
-    auto pushOut = [&](const SceneInstance& inst, float baseR, float renderScale)
+    glActiveTexture(GL_TEXTURE0);
+    forEachChunk<const WorldMatrix, const WorldBounds, const RenderMesh, const Visibility>(world,
+        [&](size_t count, const Entity*, const WorldMatrix* matrices, const WorldBounds* bounds,
+            const RenderMesh* meshes, const Visibility* visibility)
         {
-            glm::vec2 c(inst.pos.x, inst.pos.z);
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (!visibility[i].visible || !meshes[i].model)
+                    continue;
 
-            float r = baseR * (renderScale * inst.scale);
+                const Model& m = *meshes[i].model;
+                if (&m != bound)
+                {
+                    glBindVertexArray(m.VAO);
+                    bound = &m;
+                }
 
-            glm::vec2 d = p - c;
-            float dist2 = glm::dot(d, d);
-            float minR = playerRadius + r;
+                // Props are static, so the previous model matrix is the current one
+                const glm::mat4& model = matrices[i].model;
+                glm::mat4 mvp = ctx.viewProj * model;
+                glUniformMatrix4fv(ctx.modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+                glUniformMatrix4fv(ctx.mvpLoc, 1, GL_FALSE, glm::value_ptr(mvp));
+                glUniformMatrix4fv(ctx.prevModelLoc, 1, GL_FALSE, glm::value_ptr(model));
+                glUniformMatrix3fv(ctx.normalMatrixLoc, 1, GL_FALSE, glm::value_ptr(matrices[i].normal));
 
-            if (dist2 < (minR * minR) && dist2 > 0.000001f)
-            {
-                float dist = sqrtf(dist2);
-                glm::vec2 n = d / dist;
-                float penetration = (minR - dist);
-                p += n * penetration;
-            }
-            else if (dist2 <= 0.000001f)
-            {
-                p += glm::vec2(minR, 0.0f);
-            }
-        };
+                for (const Mesh& mm : m.meshes)
+                {
+                    noteTextureUse(*ctx.streamer, mm.diffuseHandle, visibility[i].distance, bounds[i].radius);
+                    glBindTexture(GL_TEXTURE_2D, (mm.diffuseTex != 0) ? mm.diffuseTex : ctx.fallbackTex);
 
-    for (int iter = 0; iter < 2; ++iter)
-    {
-        for (const auto& t : trees) pushOut(t, treeBaseRadius, treeRenderScale);
-        for (const auto& r : rocks) pushOut(r, rockBaseRadius, rockRenderScale);
-    }
+                    glDrawElements(GL_TRIANGLES, mm.indexCount, GL_UNSIGNED_INT, (void*)(mm.firstIndex * sizeof(GLuint)));
+                }
+            }
+        });
+    glBindVertexArray(0);
+}
 
-    playerPos.x = p.x;
-    playerPos.z = p.y;
+// Flashlight click when the toggle the simulation published differs from what was last heard
+// Reads and writes Flashlight; main thread, like the sound engine
+static void audioSystem(World& world, void*)
+{
+    forEachEntity<Flashlight>(world, [](Flashlight& f)
+        {
+            if (f.on == f.heard)
+                return;
+            f.heard = f.on;
+            std::cout << "Flashlight: " << (f.on ? "ON" : "OFF") << "\n";
+            playFlashlightSound(f.on != 0);
+        });
 }
 
 // Movement 
-void processMovement(float dt)
+void processMovement(float dt, CollisionGrid& collision)
 {
     float speed = walkSpeed;
-    if (glfwGetKey(gWindow, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
+    if (simKeyDown(GLFW_KEY_LEFT_SHIFT))
         speed *= runMultiplier;
 
     glm::vec3 moveDir(0.0f);
 
-    if (glfwGetKey(gWindow, GLFW_KEY_W) == GLFW_PRESS)
-        moveDir += glm::vec3(cameraFront.x, 0.0f, cameraFront.z);
-    if (glfwGetKey(gWindow, GLFW_KEY_S) == GLFW_PRESS)
-        moveDir -= glm::vec3(cameraFront.x, 0.0f, cameraFront.z);
+    if (simKeyDown(GLFW_KEY_W))
+        moveDir += glm::vec3(gPlayer.front.x, 0.0f, gPlayer.front.z);
+    if (simKeyDown(GLFW_KEY_S))
+        moveDir -= glm::vec3(gPlayer.front.x, 0.0f, gPlayer.front.z);
 
-    glm::vec3 right = glm::normalize(glm::cross(cameraFront, cameraUp));
-    if (glfwGetKey(gWindow, GLFW_KEY_A) == GLFW_PRESS)
+    glm::vec3 right = glm::normalize(glm::cross(gPlayer.front, cameraUp));
+    if (simKeyDown(GLFW_KEY_A))
         moveDir -= glm::vec3(right.x, 0.0f, right.z);
-    if (glfwGetKey(gWindow, GLFW_KEY_D) == GLFW_PRESS)
+    if (simKeyDown(GLFW_KEY_D))
         moveDir += glm::vec3(right.x, 0.0f, right.z);
 
     if (glm::length(moveDir) > 0.0f)
         moveDir = glm::normalize(moveDir);
 
-    cameraPos += moveDir * speed * dt;
+    // sweep the move against props (trees + rocks) so fast moves can't pass through trunks,
+    // then push out of anything still overlapping (e.g. after a world-bounds clamp)
+    glm::vec2 p(gPlayer.position.x, gPlayer.position.z);
+    glm::vec3 move = moveDir * speed * dt;
+    sweepCircle(collision, p, glm::vec2(move.x, move.z), playerRadius);
 
-    // world bounds first (optional either side)
-    cameraPos.x = std::max(-worldLimit, std::min(worldLimit, cameraPos.x));
-    cameraPos.z = std::max(-worldLimit, std::min(worldLimit, cameraPos.z));
+    if (!gOpenWorld)
+    {
+        p.x = std::max(-worldLimit, std::min(worldLimit, p.x));
+        p.y = std::max(-worldLimit, std::min(worldLimit, p.y));
+    }
 
-    // collide against props (trees + rocks)
-    resolveCircleCollisions(
-        cameraPos,
-        treeInstances,
-        rockInstances,
-        playerRadius,
-        treeCollisionBaseRadius,
-        rockCollisionBaseRadius,
-        TREE_RENDER_SCALE,
-        ROCK_RENDER_SCALE
-    );
+    resolveCircleCollisions(collision, p, playerRadius);
+    gPlayer.position.x = p.x;
+    gPlayer.position.z = p.y;
 
     // clamp again in case collision pushed you slightly out of bounds
-    cameraPos.x = std::max(-worldLimit, std::min(worldLimit, cameraPos.x));
-    cameraPos.z = std::max(-worldLimit, std::min(worldLimit, cameraPos.z));
+    if (!gOpenWorld)
+    {
+        gPlayer.position.x = std::max(-worldLimit, std::min(worldLimit, gPlayer.position.x));
+        gPlayer.position.z = std::max(-worldLimit, std::min(worldLimit, gPlayer.position.z));
+    }
 
-    if (glfwGetKey(gWindow, GLFW_KEY_SPACE) == GLFW_PRESS && isGrounded)
+    if (simKeyDown(GLFW_KEY_SPACE) && gPlayer.grounded)
     {
-        isGrounded = false;
-        verticalVelocity = jumpSpeed;
+        gPlayer.grounded = false;
+        gPlayer.verticalVelocity = jumpSpeed;
     }
 
-    verticalVelocity -= gravity * dt;
-    cameraPos.y += verticalVelocity * dt;
+    gPlayer.verticalVelocity -= gravity * dt;
+    gPlayer.position.y += gPlayer.verticalVelocity * dt;
 
-    float terrainY = sampleTerrainHeight(cameraPos.x, cameraPos.z) + eyeHeight;
-    if (cameraPos.y <= terrainY)
+    float terrainY = sampleTerrainHeight(gPlayer.position.x, gPlayer.position.z) + eyeHeight;
+    if (gPlayer.position.y <= terrainY)
     {
-        cameraPos.y = terrainY;
-        verticalVelocity = 0.0f;
-        isGrounded = true;
+        gPlayer.position.y = terrainY;
+        gPlayer.verticalVelocity = 0.0f;
+        gPlayer.grounded = true;
     }
 }
 
-// Texture loading
-GLuint loadTexture(const char* path)
+// Simulation thread: input events since the last tick
+static void applyInputEvents()
 {
-    int width, height, channels;
-    stbi_set_flip_vertically_on_load(true);
-    unsigned char* data = stbi_load(path, &width, &height, &channels, 0);
-
-    if (!data)
+    InputEvent e;
+    while (gInputEvents.tryPop(e))
     {
-        std::cerr << "Failed to load texture: " << path << "\n";
-        return 0;
-    }
+        if (e.type == INPUT_LOOK)
+        {
+            gPlayer.yaw += e.dx;
+            gPlayer.pitch += e.dy;
 
-    GLenum format = GL_RGB;
-    if (channels == 1) format = GL_RED;
-    else if (channels == 3) format = GL_RGB;
-    else if (channels == 4) format = GL_RGBA;
+            gPlayer.pitch = std::max(-89.0f, std::min(89.0f, gPlayer.pitch));
 
-    GLuint texID;
-    glGenTextures(1, &texID);
-    glBindTexture(GL_TEXTURE_2D, texID);
+            glm::vec3 front;
+            front.x = cosf(glm::radians(gPlayer.yaw)) * cosf(glm::radians(gPlayer.pitch));
+            front.y = sinf(glm::radians(gPlayer.pitch));
+            front.z = sinf(glm::radians(gPlayer.yaw)) * cosf(glm::radians(gPlayer.pitch));
+            gPlayer.front = glm::normalize(front);
+            continue;
+        }
 
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
+        gSimKeys[e.key] = (e.action != GLFW_RELEASE);
+        if (e.action != GLFW_PRESS)
+            continue;
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        if (e.key == GLFW_KEY_N)
+            gDayNightEnabled = !gDayNightEnabled;
 
-    stbi_image_free(data);
-    return texID;
-}
+        if (e.key == GLFW_KEY_K)
+            gTimeScale = std::min(10.0f, gTimeScale + 0.25f);
 
-// Path helpers for relative textures
-static std::string getDirectory(const std::string& filepath)
-{
-    size_t slash = filepath.find_last_of("/\\");
-    if (slash == std::string::npos) return ".";
-    return filepath.substr(0, slash);
-}
+        if (e.key == GLFW_KEY_J)
+            gTimeScale = std::max(0.25f, gTimeScale - 0.25f);
 
-static std::string joinPath(const std::string& a, const std::string& b)
-{
-    if (a.empty()) return b;
-    char last = a.back();
-    if (last == '/' || last == '\\') return a + b;
-    return a + "/" + b;
+        // Toggle flashlight (the renderer plays the sound when it sees the change)
+        if (e.key == GLFW_KEY_F)
+            gPlayer.flashlightOn = !gPlayer.flashlightOn;
+    }
 }
 
-// Mesh struct
-struct Mesh
+static void simulationThread(GpuProfiler* prof, int profLane, glm::vec3 lightDir, glm::vec3 lightColor)
 {
-    GLuint VAO = 0;
-    GLuint VBO = 0;
-    GLuint EBO = 0;
-    GLsizei indexCount = 0;
-    GLuint diffuseTex = 0;
-};
+    float dayPhase = 0.0f;
+    uint64_t tick = 0;
+    double nextTick = glfwGetTime();
 
-float rotY = 0.0f;
-float scale = 1.0f;
-
-std::vector<Mesh> loadAllMeshesAssimp(const std::string& path)
-{
-    std::vector<Mesh> meshes;
-
-    Assimp::Importer importer;
-    const aiScene* scene = importer.ReadFile(
-        path,
-        aiProcess_Triangulate |
-        aiProcess_GenSmoothNormals |
-        aiProcess_JoinIdenticalVertices |
-        aiProcess_ImproveCacheLocality |
-        aiProcess_OptimizeMeshes |
-        aiProcess_FlipUVs
-    );
-
-    if (!scene || !scene->mRootNode || scene->mNumMeshes == 0)
+    while (!gSimQuit.load(std::memory_order_relaxed))
     {
-        std::cerr << "ASSIMP failed to load model: " << path
-            << " (" << importer.GetErrorString() << ")\n";
-        return meshes;
-    }
+        double now = glfwGetTime();
+        if (now < nextTick)
+        {
+            // Sleep through most of the wait, then yield so the tick isn't late by a whole timer slice
+            if (nextTick - now > 0.002)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            else
+                std::this_thread::yield();
+            continue;
+        }
 
-    std::string dir = getDirectory(path);
-    meshes.reserve(scene->mNumMeshes);
+        if (now - nextTick > SIM_MAX_CATCH_UP_TICKS * SIM_TICK_SECONDS)
+            nextTick = now;
 
-    for (unsigned int m = 0; m < scene->mNumMeshes; ++m)
-    {
-        const aiMesh* aMesh = scene->mMeshes[m];
-        Mesh mesh;
+        applyInputEvents();
 
-        std::vector<float> vertices;
-        std::vector<unsigned int> indices;
+        // Props near the player, as of the render thread's last chunk change
+        CollisionGrid* collision = &gPropCollision;
+        if (gOpenWorld)
+        {
+            gStreamCollision.acquire();
+            collision = &gStreamCollision.readBuffer();
+        }
 
-        vertices.reserve(aMesh->mNumVertices * 8);
+        gPlayer.prevPosition = gPlayer.position;
+        processMovement((float)SIM_TICK_SECONDS, *collision);
 
-        for (unsigned int i = 0; i < aMesh->mNumVertices; ++i)
+        // Day/night clock runs on simulated time, paused while the cycle is off
+        if (gDayNightEnabled)
         {
-            const aiVector3D& pos = aMesh->mVertices[i];
+            dayPhase = fmodf(dayPhase + (float)SIM_TICK_SECONDS * gTimeScale / gCycleSeconds, 1.0f);
+            computeDayNight(dayPhase, lightDir, lightColor);
+        }
 
-            aiVector3D norm(0, 1, 0);
-            if (aMesh->HasNormals()) norm = aMesh->mNormals[i];
+        SimSnapshot& snap = gSimSnapshots.writeBuffer();
+        snap.tick = ++tick;
+        snap.time = nextTick;
+        snap.cameraPos = gPlayer.position;
+        snap.prevCameraPos = gPlayer.prevPosition;
+        snap.cameraFront = gPlayer.front;
+        snap.lightDir = lightDir;
+        snap.lightColor = lightColor;
+        snap.flashlightOn = gPlayer.flashlightOn;
+        gSimSnapshots.publish();
+
+        nextTick += SIM_TICK_SECONDS;
+        recordCpuTime(*prof, profLane, (glfwGetTime() - now) * 1000.0);
+    }
+}
 
-            aiVector3D uv(0, 0, 0);
-            if (aMesh->HasTextureCoords(0)) uv = aMesh->mTextureCoords[0][i];
+float rotY = 0.0f;
+float scale = 1.0f;
 
-            vertices.push_back(pos.x); vertices.push_back(pos.y); vertices.push_back(pos.z);
-            vertices.push_back(norm.x); vertices.push_back(norm.y); vertices.push_back(norm.z);
-            vertices.push_back(uv.x);   vertices.push_back(uv.y);
-        }
+// Job system scaling: the engine's parallel work run with 1..N threads (best of a few runs each)
+static void runJobBenchmark()
+{
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::time_point since) { return std::chrono::duration<double, std::milli>(Clock::now() - since).count(); };
+
+    const int TERRAIN_SIZE = 1024;
+    const int ENTITIES = 200000;
+    const int HEIGHTFIELD_SIZE = 1024;
+    const int RAYS = 1 << 18;
+    const int DECODE_COPIES = 8;
+    const int RUNS = 5;
+
+    std::vector<BakedVertex> vertices((size_t)terrainVertexCount(TERRAIN_SIZE));
+    std::vector<uint32_t> indices((size_t)terrainIndexCount(TERRAIN_SIZE));
+
+    // A big prop field: transforms and culling are the per-frame systems
+    // (left dirty, so every run rebuilds the transforms as if everything moved)
+    Model box;
+    box.boundsMin = glm::vec3(-1.0f);
+    box.boundsMax = glm::vec3(1.0f);
+    World world;
+    std::mt19937 rng(7u);
+    std::uniform_real_distribution<float> distXZ(-500.0f, 500.0f);
+    for (int i = 0; i < ENTITIES; ++i)
+    {
+        Transform t;
+        t.position = glm::vec3(distXZ(rng), 0.0f, distXZ(rng));
+        t.rotY = 0.001f * i;
+        spawnEntity(world, t, RenderMesh{ &box }, TransformDirty{}, WorldMatrix{}, WorldBounds{}, Visibility{});
+    }
 
-        for (unsigned int f = 0; f < aMesh->mNumFaces; ++f)
-        {
-            const aiFace& face = aMesh->mFaces[f];
-            if (face.mNumIndices != 3) continue;
-            indices.push_back(face.mIndices[0]);
-            indices.push_back(face.mIndices[1]);
-            indices.push_back(face.mIndices[2]);
-        }
+    CullContext cull;
+    glm::mat4 viewProj = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 300.0f) *
+        glm::lookAt(glm::vec3(0.0f, 2.0f, 0.0f), glm::vec3(0.0f, 2.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    setCullFrustum(cull, viewProj, glm::vec3(0.0f, 2.0f, 0.0f));
+
+    SystemSchedule systems;
+    addSystem(systems, "transform", componentMask<Transform, RenderMesh, TransformDirty>(),
+        componentMask<WorldMatrix, WorldBounds>(), transformSystem, nullptr);
+    addSystem(systems, "cull", componentMask<WorldBounds>(), componentMask<Visibility>(), cullSystem, &cull);
+    buildSchedule(systems);
+
+    Heightfield hf;
+    buildHeightfield(hf, HEIGHTFIELD_SIZE, 1.0f, sampleTerrainHeight);
+    std::vector<HeightfieldRay> rays((size_t)RAYS);
+    std::vector<HeightfieldHit> hits((size_t)RAYS);
+    std::uniform_real_distribution<float> distHf(-0.45f * HEIGHTFIELD_SIZE, 0.45f * HEIGHTFIELD_SIZE);
+    std::uniform_real_distribution<float> distAngle(0.0f, 6.2831853f);
+    for (HeightfieldRay& ray : rays)
+    {
+        float x = distHf(rng);
+        float z = distHf(rng);
+        float yaw = distAngle(rng);
+        ray.origin = glm::vec3(x, sampleTerrainHeight(x, z) + 1.7f, z);
+        ray.dir = glm::normalize(glm::vec3(cosf(yaw), -0.2f, sinf(yaw)));
+    }
 
-        mesh.indexCount = (GLsizei)indices.size();
+    // Decodes: whichever of the loose source textures are present, several times over
+    std::vector<std::string> decodePaths;
+    const char* sources[] = { "assets/grass.png", "assets/Leavs_basecolor_.tga.png", "assets/Trank_basecolor.tga.png" };
+    for (const char* path : sources)
+    {
+        TextureData probe;
+        if (!loadTextureData(probe, path))
+            continue;
+        freeTextureData(probe);
+        for (int i = 0; i < DECODE_COPIES; ++i)
+            decodePaths.push_back(path);
+    }
 
-        glGenVertexArrays(1, &mesh.VAO);
-        glGenBuffers(1, &mesh.VBO);
-        glGenBuffers(1, &mesh.EBO);
+    int maxThreads = (int)std::max(std::thread::hardware_concurrency(), 1u);
+    std::vector<int> threadCounts;
+    for (int n = 1; n < maxThreads; n *= 2)
+        threadCounts.push_back(n);
+    threadCounts.push_back(maxThreads);
 
-        glBindVertexArray(mesh.VAO);
+    std::cout << "Job system scaling: terrain " << TERRAIN_SIZE << "^2, " << ENTITIES << " entities (transform + cull), "
+        << RAYS << " rays on " << HEIGHTFIELD_SIZE << "^2, " << decodePaths.size() << " texture decodes (best of " << RUNS << " runs)\n";
+    std::cout << std::left << std::setw(8) << "threads" << std::right << std::setw(19) << "terrain ms" << std::setw(19) << "systems ms"
+        << std::setw(19) << "rays ms" << std::setw(19) << "decode ms" << "\n";
 
-        glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    double base[4] = {};
+    for (int threads : threadCounts)
+    {
+        JobSystem jobs;
+        initJobSystem(jobs, threads - 1);
+        world.jobs = &jobs;
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+        double best[4] = { 1e30, 1e30, 1e30, 1e30 };
+        for (int run = 0; run < RUNS; ++run)
+        {
+            auto t0 = Clock::now();
+            generateTerrain(TERRAIN_SIZE, 1.0f, vertices.data(), indices.data(), &jobs);
+            best[0] = std::min(best[0], ms(t0));
 
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
+            t0 = Clock::now();
+            runSchedule(systems, world);
+            best[1] = std::min(best[1], ms(t0));
 
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-        glEnableVertexAttribArray(1);
+            t0 = Clock::now();
+            raycastHeightfieldBatch(hf, rays.data(), hits.data(), RAYS, &jobs);
+            best[2] = std::min(best[2], ms(t0));
 
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-        glEnableVertexAttribArray(2);
+            if (!decodePaths.empty())
+            {
+                t0 = Clock::now();
+                parallelFor(&jobs, (int)decodePaths.size(), 1, [&](int begin, int end)
+                    {
+                        for (int i = begin; i < end; ++i)
+                        {
+                            TextureData data;
+                            if (loadTextureData(data, decodePaths[i].c_str()))
+                                freeTextureData(data);
+                        }
+                    });
+                best[3] = std::min(best[3], ms(t0));
+            }
+        }
 
-        glBindVertexArray(0);
+        world.jobs = nullptr;
+        destroyJobSystem(jobs);
 
-        if (aMesh->mMaterialIndex >= 0 && scene->mNumMaterials > 0)
+        std::cout << std::left << std::setw(8) << threads << std::right;
+        for (int i = 0; i < 4; ++i)
         {
-            aiMaterial* mat = scene->mMaterials[aMesh->mMaterialIndex];
-            aiString texPath;
-            if (mat && mat->GetTextureCount(aiTextureType_DIFFUSE) > 0 &&
-                mat->GetTexture(aiTextureType_DIFFUSE, 0, &texPath) == AI_SUCCESS)
-            {
-                std::string fullPath = joinPath(dir, texPath.C_Str());
-                mesh.diffuseTex = loadTexture(fullPath.c_str());
-            }
+            if (threads == threadCounts.front())
+                base[i] = best[i];
+
+            std::ostringstream cell;
+            if (i == 3 && decodePaths.empty())
+                cell << "-";
+            else
+                cell << std::fixed << std::setprecision(2) << best[i] << " (x" << std::setprecision(1) << base[i] / best[i] << ")";
+            std::cout << std::setw(19) << cell.str();
         }
+        std::cout << "\n";
+    }
+}
 
-        meshes.push_back(mesh);
+// Scene loading: a baked scene placed into a bare world (placeholder models, no GL), then its transforms built
+static void runSceneBenchmark(const char* path)
+{
+    using Clock = std::chrono::steady_clock;
+    auto ms = [](Clock::time_point since) { return std::chrono::duration<double, std::milli>(Clock::now() - since).count(); };
+
+    auto t0 = Clock::now();
+    SceneFile file;
+    if (!openSceneFile(file, path))
+        return;
+    double openMs = ms(t0);
+    gHeightScale = file.header->heightScale;
+
+    JobSystem jobs;
+    initJobSystem(jobs, -1);
+
+    std::vector<Model> models(file.header->propCount);
+    std::vector<const Model*> modelPtrs;
+    for (Model& model : models)
+    {
+        model.boundsMin = glm::vec3(-1.0f);
+        model.boundsMax = glm::vec3(1.0f);
+        modelPtrs.push_back(&model);
+    }
+
+    {
+        World world;
+        world.jobs = &jobs;
+
+        t0 = Clock::now();
+        size_t placed = placeSceneProps(file, world, modelPtrs.data(), sampleTerrainHeight);
+        double placeMs = ms(t0);
+
+        t0 = Clock::now();
+        transformSystem(world, nullptr);
+        double transformMs = ms(t0);
+
+        t0 = Clock::now();
+        clearTransformDirty(world);
+        double clearMs = ms(t0);
+
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(2) << "Scene " << path << " on " << jobThreadCount(jobs) << " threads: " << placed
+            << " instances, open " << openMs << " ms, place " << placeMs << " ms, transforms " << transformMs
+            << " ms, clear dirty " << clearMs << " ms\n";
+        std::cout << line.str();
+        reportWorld(world);
     }
 
-    return meshes;
+    destroyJobSystem(jobs);
+    closeSceneFile(file);
 }
 
 // Main
-int main()
+int main(int argc, char** argv)
 {
+    bool traceStartup = false;
+    size_t textureBudgetMB = TEXTURE_STREAM_BUDGET_MB;
+    const char* scenePath = DEFAULT_SCENE_PATH;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--trace-startup") == 0)
+            traceStartup = true;
+        else if (strcmp(argv[i], "--texture-budget-mb") == 0 && i + 1 < argc)
+            textureBudgetMB = (size_t)std::max(atoi(argv[++i]), 1);
+        else if (strcmp(argv[i], "--bench-collision") == 0)
+        {
+            runCollisionBenchmark();
+            return 0;
+        }
+        else if (strcmp(argv[i], "--bench-heightfield") == 0)
+        {
+            runHeightfieldBenchmark(sampleTerrainHeight);
+            return 0;
+        }
+        else if (strcmp(argv[i], "--bench-jobs") == 0)
+        {
+            runJobBenchmark();
+            return 0;
+        }
+        else if (strcmp(argv[i], "--bench-scatter") == 0)
+        {
+            runScatterBenchmark(sampleTerrainHeight);
+            return 0;
+        }
+        else if (strcmp(argv[i], "--scene") == 0 && i + 1 < argc)
+            scenePath = argv[++i];
+        else if (strcmp(argv[i], "--open-world") == 0)
+            gOpenWorld = true;
+        else if (strcmp(argv[i], "--bench-scene") == 0 && i + 1 < argc)
+        {
+            runSceneBenchmark(argv[++i]);
+            return 0;
+        }
+    }
+    initStartupTrace(traceStartup);
+    double startupStart = traceBegin();
+
+    double phase = traceBegin();
     if (!glfwInit())
     {
         std::cerr << "GLFW init failed\n";
         return 1;
     }
+    traceEnd("glfwInit", "startup", phase);
 
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -958,6 +1138,7 @@ int main()
 #endif
     glfwWindowHint(GLFW_MAXIMIZED, GLFW_TRUE);
 
+    phase = traceBegin();
     gWindow = glfwCreateWindow(WIDTH, HEIGHT, "Interactive 3D Scene Explorer", nullptr, nullptr);
     if (!gWindow)
     {
@@ -967,6 +1148,7 @@ int main()
 
     glfwMakeContextCurrent(gWindow);
     glfwSwapInterval(1);
+    traceEnd("create window + GL context", "startup", phase);
 
     glfwSetFramebufferSizeCallback(gWindow, framebuffer_size_callback);
     glfwSetCursorPosCallback(gWindow, cursor_pos_callback);
@@ -975,6 +1157,7 @@ int main()
     glfwSetWindowFocusCallback(gWindow, window_focus_callback);
     glfwSetInputMode(gWindow, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
+    phase = traceBegin();
     glewExperimental = GL_TRUE;
     if (glewInit() != GLEW_OK)
     {
@@ -982,6 +1165,7 @@ int main()
         glfwTerminate();
         return 1;
     }
+    traceEnd("glewInit", "startup", phase);
 
     glfwGetFramebufferSize(gWindow, &gFBWidth, &gFBHeight);
     glViewport(0, 0, gFBWidth, gFBHeight);
@@ -990,158 +1174,219 @@ int main()
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    GLuint shaderProgram = createShaderProgram();
-    GLuint billboardProgram = createBillboardProgram();
-
-    // Billboard quad VAO
-    GLuint bbVAO = 0, bbVBO = 0, bbEBO = 0;
+    // Assets decode on worker threads while shaders, sky LUTs and terrain are built below
+    // Models are baked from the .obj sources by AssetBaker (pre-build step), which also packs them into assets.pack
+    // Textures are shared through the registry (same path + sampler = same GL texture)
+    phase = traceBegin();
+    if (!mountAssetPack(ASSET_PACK_PATH))
+        std::cout << "No asset pack, loading loose files from assets/\n";
+    traceEnd("mount asset pack", "startup", phase);
+
+    phase = traceBegin();
+    initSoundEngine();
+    traceEnd("start sound engine", "startup", phase);
+
+    // Scene first: its terrain settings size everything built below
+    // Without one the game still runs, on the default terrain and with no props
+    phase = traceBegin();
+    SceneFile sceneFile;
+    uint32_t propCount = 0;
+    if (openSceneFile(sceneFile, scenePath))
     {
-        float quad[] = {
-            -0.5f, -0.5f, 0.0f,  0.0f, 0.0f,
-             0.5f, -0.5f, 0.0f,  1.0f, 0.0f,
-             0.5f,  0.5f, 0.0f,  1.0f, 1.0f,
-            -0.5f,  0.5f, 0.0f,  0.0f, 1.0f
-        };
-        unsigned int idx[] = { 0,1,2, 2,3,0 };
-
-        glGenVertexArrays(1, &bbVAO);
-        glGenBuffers(1, &bbVBO);
-        glGenBuffers(1, &bbEBO);
-
-        glBindVertexArray(bbVAO);
-
-        glBindBuffer(GL_ARRAY_BUFFER, bbVBO);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STATIC_DRAW);
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bbEBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(idx), idx, GL_STATIC_DRAW);
-
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-        glEnableVertexAttribArray(0);
-
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-        glEnableVertexAttribArray(1);
-
-        glBindVertexArray(0);
+        gTerrainSize = sceneFile.header->terrainSize;
+        gTerrainStep = sceneFile.header->terrainSpacing;
+        gHeightScale = sceneFile.header->heightScale;
+        gPlayer.position.x = sceneFile.header->spawn[0];
+        gPlayer.position.z = sceneFile.header->spawn[1];
+        propCount = sceneFile.header->propCount;
     }
-
-    // Terrain
-    std::vector<float> terrainVertices;
-    std::vector<unsigned int> terrainIndices;
-    generateTerrain(gTerrainSize, gTerrainStep, terrainVertices, terrainIndices);
-
+    traceEnd("open scene", "startup", phase);
+
+    // Job system: the asset decodes, terrain rows and per-frame systems all run on it
+    phase = traceBegin();
+    JobSystem jobs;
+    initJobSystem(jobs, -1);
+    traceEnd("start job system", "startup", phase);
+
+    phase = traceBegin();
+    TextureRegistry textures;
+    UploadRing uploadRing;
+    initUploadRing(uploadRing, UPLOAD_RING_BYTES);
+    TextureStreamer streamer;
+    initTextureStreamer(streamer, textures, &uploadRing, textureBudgetMB * 1024 * 1024);
+    AssetLoader assets;
+    initAssetLoader(assets, textures, &uploadRing, &streamer, jobs);
+    traceEnd("start asset loader", "startup", phase);
+
+    GLuint grassTex = 0;
+    GLuint flashlightBaseTex = 0;
+    Model flashlightModel;
+    std::vector<Model> propModels(propCount);     // sized once, the loader holds pointers into it
+
+    TextureHandle grassHandle = requestTexture(assets, "assets/grass.png", &grassTex);
+    for (uint32_t i = 0; i < propCount; ++i)
+        requestModel(assets, sceneFile.props[i].meshPath, &propModels[i]);
+    requestModel(assets, "assets/Flashlight.mesh", &flashlightModel);
+    TextureHandle flashlightBaseHandle = requestTexture(assets, "assets/textures/T_Flashlight_V01_BaseColor-T_Flashlight_V01_Opacity.png", &flashlightBaseTex);
+
+    phase = traceBegin();
+    GLuint shaderProgram = createShaderProgram();
+    traceEnd("compile scene shader", "startup", phase);
+
+    // Sky LUTs are baked here once (or read back from the cache)
+    phase = traceBegin();
+    SkyRenderer sky;
+    initSky(sky, "sky_lut.cache");
+    traceEnd("sky LUTs", "startup", phase);
+
+    // HDR target + bloom + fused composite (optional grading LUT in assets/)
+    phase = traceBegin();
+    PostProcess post;
+    initPostProcess(post, gFBWidth, gFBHeight, "assets/grading.cube");
+    traceEnd("post process", "startup", phase);
+
+    enum GpuStage { GPU_SKY, GPU_SCENE, GPU_TAA, GPU_BLOOM, GPU_COMPOSITE, GPU_STAGE_COUNT };
+    const char* gpuStageNames[GPU_STAGE_COUNT] = { "sky", "scene", "taa", "bloom", "composite" };
+    GpuProfiler gpuProf;
+    initGpuProfiler(gpuProf, gpuStageNames, GPU_STAGE_COUNT);
+
+    // Terrain: generated straight into the GL buffers, no CPU-side copy of the mesh
+    // (the open world streams its own, in chunks)
     worldLimit = gTerrainSize * gTerrainStep * 0.5f - 2.0f;
 
     GLuint terrainVAO = 0, terrainVBO = 0, terrainEBO = 0;
-    glGenVertexArrays(1, &terrainVAO);
-    glGenBuffers(1, &terrainVBO);
-    glGenBuffers(1, &terrainEBO);
-
-    glBindVertexArray(terrainVAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, terrainVBO);
-    glBufferData(GL_ARRAY_BUFFER, terrainVertices.size() * sizeof(float), terrainVertices.data(), GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, terrainEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, terrainIndices.size() * sizeof(unsigned int), terrainIndices.data(), GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-
-    glBindVertexArray(0);
+    int terrainIdxCount = 0;
+    if (!gOpenWorld)
+    {
+        const int terrainVertCount = terrainVertexCount(gTerrainSize);
+        terrainIdxCount = terrainIndexCount(gTerrainSize);
+        const GLsizeiptr terrainVertexBytes = (GLsizeiptr)terrainVertCount * sizeof(BakedVertex);
+        const GLsizeiptr terrainIndexBytes = (GLsizeiptr)terrainIdxCount * sizeof(uint32_t);
 
-    // Assets
-    GLuint grassTex = loadTexture("assets/grass.png");
-    std::vector<Mesh> treeMeshes = loadAllMeshesAssimp("assets/tree.obj");
-    bool hasTree = !treeMeshes.empty();
+        glGenVertexArrays(1, &terrainVAO);
+        glGenBuffers(1, &terrainVBO);
+        glGenBuffers(1, &terrainEBO);
 
-    std::vector<Mesh> rockMeshes = loadAllMeshesAssimp("assets/rock.obj");
-    bool hasRock = !rockMeshes.empty();
+        glBindVertexArray(terrainVAO);
 
-    // Flashlight 
-    std::vector<Mesh> flashlightMeshes = loadAllMeshesAssimp("assets/Flashlight.obj");
-    bool hasFlashlight = !flashlightMeshes.empty();
-    GLuint flashlightBaseTex = loadTexture("assets/textures/T_Flashlight_V01_BaseColor-T_Flashlight_V01_Opacity.png");
+        glBindBuffer(GL_ARRAY_BUFFER, terrainVBO);
+        glBufferData(GL_ARRAY_BUFFER, terrainVertexBytes, nullptr, GL_STATIC_DRAW);
 
-    // Place camera on terrain
-    cameraPos.y = sampleTerrainHeight(cameraPos.x, cameraPos.z) + eyeHeight;
-    isGrounded = true;
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, terrainEBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, terrainIndexBytes, nullptr, GL_STATIC_DRAW);
 
-    // Procedural placement: trees + rocks (simple, deterministic scatter)
-    {
-        std::mt19937 rng(1337u);
-        std::uniform_real_distribution<float> distXZ(-worldLimit, worldLimit);
-        std::uniform_real_distribution<float> distRot(0.0f, 6.2831853f);
-        std::uniform_real_distribution<float> distTreeS(0.7f, 1.2f);
-        std::uniform_real_distribution<float> distRockS(0.4f, 0.9f);
+        {
+            TRACE_SCOPE("terrain", "startup");
+            auto genStart = std::chrono::steady_clock::now();
 
-        auto farFromSpawn = [&](float x, float z)
+            // Unmap can report the storage was lost (mode switch etc.), in which case just write it again
+            bool written = false;
+            for (int attempt = 0; attempt < 3 && !written; ++attempt)
             {
-                glm::vec2 p(x, z);
-                glm::vec2 spawn(cameraPos.x, cameraPos.z);
-                return glm::distance(p, spawn) > 6.0f;
-            };
-
-        if (hasTree)
-        {
-            const int TREE_COUNT = 30;
-            treeInstances.reserve(TREE_COUNT);
+                const GLbitfield mapFlags = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT;
+                BakedVertex* vtx = (BakedVertex*)glMapBufferRange(GL_ARRAY_BUFFER, 0, terrainVertexBytes, mapFlags);
+                uint32_t* idx = (uint32_t*)glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, terrainIndexBytes, mapFlags);
+                if (vtx && idx)
+                    generateTerrain(gTerrainSize, gTerrainStep, vtx, idx, &jobs);
+
+                bool vtxOk = vtx && glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE;
+                bool idxOk = idx && glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER) == GL_TRUE;
+                written = vtx && idx && vtxOk && idxOk;
+            }
 
-            for (int i = 0; i < TREE_COUNT; ++i)
+            if (!written)
             {
-                float x = distXZ(rng);
-                float z = distXZ(rng);
+                // Mapping unavailable: stage through one heap block instead
+                std::vector<unsigned char> staging((size_t)(terrainVertexBytes + terrainIndexBytes));
+                BakedVertex* vtx = (BakedVertex*)staging.data();
+                uint32_t* idx = (uint32_t*)(staging.data() + terrainVertexBytes);
+                generateTerrain(gTerrainSize, gTerrainStep, vtx, idx, &jobs);
+                glBufferSubData(GL_ARRAY_BUFFER, 0, terrainVertexBytes, vtx);
+                glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, terrainIndexBytes, idx);
+            }
 
-                for (int r = 0; r < 6 && !farFromSpawn(x, z); ++r)
-                {
-                    x = distXZ(rng);
-                    z = distXZ(rng);
-                }
+            double genMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - genStart).count();
+            std::ostringstream line;
+            line << std::fixed << std::setprecision(2) << "Terrain: " << terrainVertCount << " verts, " << terrainIdxCount / 3
+                << " tris (" << (terrainVertexBytes + terrainIndexBytes) / (1024.0 * 1024.0) << " MB) generated in " << genMs << " ms, "
+                << (written ? "written in place through glMapBufferRange" : "staged through the heap") << "\n";
+            std::cout << line.str();
+        }
 
-                float y = sampleTerrainHeight(x, z);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(BakedVertex), (void*)offsetof(BakedVertex, position));
+        glEnableVertexAttribArray(0);
 
-                SceneInstance inst;
-                inst.pos = glm::vec3(x, y, z);
-                inst.rotY = distRot(rng);
-                inst.scale = distTreeS(rng);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(BakedVertex), (void*)offsetof(BakedVertex, normal));
+        glEnableVertexAttribArray(1);
 
-                treeInstances.push_back(inst);
-            }
-        }
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(BakedVertex), (void*)offsetof(BakedVertex, uv));
+        glEnableVertexAttribArray(2);
 
-        if (hasRock)
-        {
-            const int ROCK_COUNT = 45;
-            rockInstances.reserve(ROCK_COUNT);
+        glBindVertexArray(0);
+    }
 
-            for (int i = 0; i < ROCK_COUNT; ++i)
-            {
-                float x = distXZ(rng);
-                float z = distXZ(rng);
+    // Assets: the startup set has to be resident before props are placed
+    // Uploads still go in frame-sized slices so the window keeps pumping events
+    phase = traceBegin();
+    while (assetsPending(assets))
+    {
+        if (pumpAssetUploads(assets, ASSET_UPLOAD_BUDGET_MS) == 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        glfwPollEvents();
+    }
+    traceEnd("wait for startup assets", "startup", phase);
 
-                for (int r = 0; r < 6 && !farFromSpawn(x, z); ++r)
-                {
-                    x = distXZ(rng);
-                    z = distXZ(rng);
-                }
+    bool hasFlashlight = !flashlightModel.meshes.empty();
+    reportTextureRegistry(textures);
 
-                float y = sampleTerrainHeight(x, z);
+    // Place camera on terrain
+    gPlayer.position.y = sampleTerrainHeight(gPlayer.position.x, gPlayer.position.z) + eyeHeight;
+    gPlayer.grounded = true;
 
-                SceneInstance inst;
-                inst.pos = glm::vec3(x, y, z);
-                inst.rotY = distRot(rng);
-                inst.scale = distRockS(rng);
+    // Scene entities (render thread); the player entity only carries what the systems need from it
+    World scene;
+    scene.jobs = &jobs;
+    Entity player = spawnEntity(scene, Flashlight{ gPlayer.flashlightOn ? 1u : 0u, gPlayer.flashlightOn ? 1u : 0u });
+    WorldStream worldStream;
 
-                rockInstances.push_back(inst);
+    {
+        // Props whose model failed to load are left out
+        std::vector<const Model*> models(propCount, nullptr);
+        for (uint32_t i = 0; i < propCount; ++i)
+            if (!propModels[i].meshes.empty())
+                models[i] = &propModels[i];
+
+        // The open world takes the scene's props and scatter layers and brings in the chunks around the spawn
+        // before the first frame; the fixed map places everything now
+        if (gOpenWorld)
+        {
+            TRACE_SCOPE("stream in spawn chunks", "startup");
+            initWorldStream(worldStream, jobs, sampleTerrainHeight, gTerrainStep,
+                propCount > 0 ? &sceneFile : nullptr, models.data());
+            while (!worldStreamSettled(worldStream, gPlayer.position))
+            {
+                updateWorldStream(worldStream, scene, gPlayer.position);
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                glfwPollEvents();
             }
         }
+        else if (propCount > 0)
+            placeSceneProps(sceneFile, scene, models.data(), sampleTerrainHeight);
+
+        // Placement is final (until the stream moves on): derive transforms and the collision grid once
+        CollisionGrid* collision = gOpenWorld ? &gStreamCollision.writeBuffer() : &gPropCollision;
+        SystemSchedule startupSystems;
+        addSystem(startupSystems, "transform", componentMask<Transform, RenderMesh, TransformDirty>(),
+            componentMask<WorldMatrix, WorldBounds>(), transformSystem, nullptr);
+        addSystem(startupSystems, "collision build", componentMask<Transform, CircleCollider>(), 0,
+            collisionBuildSystem, collision);
+        buildSchedule(startupSystems);
+        runSchedule(startupSystems, scene);
+        clearTransformDirty(scene);
+        if (gOpenWorld)
+            gStreamCollision.publish();
     }
+    reportWorld(scene);
 
     // Main shader uniforms
     glUseProgram(shaderProgram);
@@ -1152,6 +1397,10 @@ int main()
     GLint viewPosLoc = glGetUniformLocation(shaderProgram, "uViewPos");
     GLint modelLoc = glGetUniformLocation(shaderProgram, "u_Model");
     GLint mvpLoc = glGetUniformLocation(shaderProgram, "u_MVP");
+    GLint prevModelLoc = glGetUniformLocation(shaderProgram, "u_PrevModel");
+    GLint normalMatrixLoc = glGetUniformLocation(shaderProgram, "u_NormalMatrix");
+    GLint currViewProjLoc = glGetUniformLocation(shaderProgram, "u_CurrViewProj");
+    GLint prevViewProjLoc = glGetUniformLocation(shaderProgram, "u_PrevViewProj");
 
     // Flashlight uniform locations
     GLint flashOnLoc = glGetUniformLocation(shaderProgram, "uFlashOn");
@@ -1162,48 +1411,140 @@ int main()
     GLint flashOuterLoc = glGetUniformLocation(shaderProgram, "uFlashOuterCos");
     GLint flashRangeLoc = glGetUniformLocation(shaderProgram, "uFlashRange");
 
-    // Billboard shader uniforms
-    GLint bbMvpLoc = glGetUniformLocation(billboardProgram, "u_MVP");
-    GLint bbColLoc = glGetUniformLocation(billboardProgram, "uColor");
-    GLint bbSoftLoc = glGetUniformLocation(billboardProgram, "uSoftness");
-    GLint bbAlphaLoc = glGetUniformLocation(billboardProgram, "uAlpha");
-
-    glm::vec3 lightDir = glm::normalize(glm::vec3(-0.4f, -1.0f, -0.2f));
-    glm::vec3 lightColor = glm::vec3(1.0f, 0.97f, 0.90f);
+    glm::vec3 initialLightDir = glm::normalize(glm::vec3(-0.4f, -1.0f, -0.2f));
+    glm::vec3 initialLightColor = glm::vec3(1.0f, 0.97f, 0.90f);
+
+    // Previous-frame transforms for velocity
+    unsigned frameIndex = 0;
+    glm::mat4 prevViewProj(1.0f);
+    glm::mat4 prevViewProjRot(1.0f);
+    glm::mat4 prevFlashlightModel(1.0f);
+    bool hasPrevFlashlight = false;
+
+    traceEnd("startup", "startup", startupStart);
+    writeStartupTrace(STARTUP_TRACE_PATH);
+
+    // Simulation starts now, from a snapshot of the initial state so the first frame has one
+    int renderLane = addCpuThread(gpuProf, "render");
+    int simLane = addCpuThread(gpuProf, "simulation");
+
+    gPlayer.prevPosition = gPlayer.position;
+    SimSnapshot initial;
+    initial.time = glfwGetTime();
+    initial.cameraPos = gPlayer.position;
+    initial.prevCameraPos = gPlayer.position;
+    initial.cameraFront = gPlayer.front;
+    initial.lightDir = initialLightDir;
+    initial.lightColor = initialLightColor;
+    initial.flashlightOn = gPlayer.flashlightOn;
+    gSimSnapshots.reset(initial);
+    gSimThread = std::thread(simulationThread, &gpuProf, simLane, initialLightDir, initialLightColor);
+
+    // Per-frame systems; the scheduler runs transform and audio side by side, then culling, then drawing
+    // (the transform system only sees entities marked dirty since the last frame, none for static props)
+    CullContext cullCtx;
+    PropRenderContext propCtx;
+    propCtx.modelLoc = modelLoc;
+    propCtx.mvpLoc = mvpLoc;
+    propCtx.prevModelLoc = prevModelLoc;
+    propCtx.normalMatrixLoc = normalMatrixLoc;
+    propCtx.streamer = &streamer;
+
+    SystemSchedule frameSystems;
+    addSystem(frameSystems, "transform", componentMask<Transform, RenderMesh, TransformDirty>(),
+        componentMask<WorldMatrix, WorldBounds>(), transformSystem, nullptr);
+    addSystem(frameSystems, "cull", componentMask<WorldBounds>(), componentMask<Visibility>(), cullSystem, &cullCtx);
+    addSystem(frameSystems, "audio", componentMask<Flashlight>(), componentMask<Flashlight>(), audioSystem, nullptr, true);
+    addSystem(frameSystems, "render props", componentMask<WorldMatrix, WorldBounds, RenderMesh, Visibility>(), 0,
+        propRenderSystem, &propCtx, true);
+    buildSchedule(frameSystems);
+    printSchedule(frameSystems);
 
     while (!glfwWindowShouldClose(gWindow))
     {
-        float now = (float)glfwGetTime();
-        deltaTime = now - lastFrame;
-        lastFrame = now;
+        double now = glfwGetTime();
 
         glfwPollEvents();
-        processMovement(deltaTime);
+
+        // Anything requested at runtime is uploaded a little each frame
+        pumpAssetUploads(assets, ASSET_UPLOAD_BUDGET_MS);
+
+        // Latest tick from the simulation thread
+        gSimSnapshots.acquire();
+        const SimSnapshot& snap = gSimSnapshots.readBuffer();
+
+        // Render between the snapshot's last two ticks, one tick behind real time
+        float simAlpha = glm::clamp((float)((now - snap.time) / SIM_TICK_SECONDS), 0.0f, 1.0f);
+        glm::vec3 eyePos = glm::mix(snap.prevCameraPos, snap.cameraPos, simAlpha);
+        glm::vec3 eyeFront = snap.cameraFront;
+        glm::vec3 lightDir = snap.lightDir;
+        glm::vec3 lightColor = snap.lightColor;
+
+        getComponent<Flashlight>(scene, player)->on = snap.flashlightOn ? 1u : 0u;
+
+        // Chunks in and out around the camera, before the systems see the world; new props come in dirty
+        if (gOpenWorld && updateWorldStream(worldStream, scene, eyePos))
+        {
+            collisionBuildSystem(scene, &gStreamCollision.writeBuffer());
+            gStreamCollision.publish();
+        }
 
         // View/projection
-        glm::mat4 view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
+        glm::mat4 view = glm::lookAt(eyePos, eyePos + eyeFront, cameraUp);
 
         float aspect = (gFBHeight > 0) ? (float)gFBWidth / (float)gFBHeight : 16.0f / 9.0f;
-        glm::mat4 projection = glm::perspective(glm::radians(60.0f), aspect, 0.1f, 1000.0f);
+        float fovY = glm::radians(60.0f);
+        glm::mat4 projection = glm::perspective(fovY, aspect, 0.1f, 1000.0f);
 
-        // Day/night
-        glm::vec3 skyColor(0.45f, 0.70f, 0.95f);
-        float t = 0.25f;
+        gpuProfilerBeginFrame(gpuProf);
 
-        if (gDayNightEnabled)
+        if (post.taaEnabled != gTaaEnabled)
         {
-            t = fmodf(((float)glfwGetTime() * gTimeScale) / gCycleSeconds, 1.0f);
-            computeDayNight(t, lightDir, lightColor, skyColor);
+            post.taaEnabled = gTaaEnabled;
+            resetTemporalHistory(post);
         }
 
-        glClearColor(skyColor.r, skyColor.g, skyColor.b, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        // Scene renders into the HDR target, scaled to fit the GPU budget
+        // (TAA and composite run at native resolution, so they count as fixed cost)
+        resizePostProcess(post, gFBWidth, gFBHeight);
+        gDynRes.maxScale = gTaaEnabled ? TAA_MAX_RENDER_SCALE : 1.0f;
+        float renderScale = updateDynamicResolution(gDynRes,
+            gpuProf.lastFrameMs, gpuProf.lastMs[GPU_TAA] + gpuProf.lastMs[GPU_COMPOSITE], gpuProf.resolvedCount);
+        setRenderScale(post, renderScale);
+        beginScenePass(post);
+
+        // Unjittered matrices feed the velocity buffer, the jittered projection is used for drawing
+        glm::mat4 currViewProj = projection * view;
+        glm::mat4 currViewProjRot = projection * glm::mat4(glm::mat3(view));
+        if (frameIndex == 0)
+        {
+            prevViewProj = currViewProj;
+            prevViewProjRot = currViewProjRot;
+        }
+
+        glm::vec2 jitter = temporalJitter(post, frameIndex);
+        projection = jitterProjection(projection, jitter);
+
+        // Sky covers every pixel, so only depth needs clearing
+        glClear(GL_DEPTH_BUFFER_BIT);
+
+        // Sky (atmosphere + sun/moon discs) as the background pass
+        gpuStageBegin(gpuProf, GPU_SKY);
+        glm::vec3 sunDir = glm::normalize(-lightDir);
+        drawSky(sky, view, projection, sunDir, std::max(eyePos.y, 0.0f) * 0.001f + 0.05f,
+            currViewProjRot, prevViewProjRot);
+        gpuStageEnd(gpuProf);
+
+        // Velocity must not be blended with what's behind alpha-blended leaves
+        glDisablei(GL_BLEND, 1);
+
+        gpuStageBegin(gpuProf, GPU_SCENE);
 
         // Main draw
         glUseProgram(shaderProgram);
 
         // Compute camera-relative flashlight origin and basis so spotlight is positioned at the hand
-        glm::vec3 camForward = glm::normalize(cameraFront);
+        glm::vec3 camForward = glm::normalize(eyeFront);
         glm::vec3 camRight = glm::normalize(glm::cross(camForward, cameraUp));
         glm::vec3 camUp = glm::normalize(glm::cross(camRight, camForward));
 
@@ -1211,11 +1552,11 @@ int main()
         const float handUp = -0.28f;
         const float handForward = 0.30f;
 
-        glm::vec3 flashPos = cameraPos + camRight * handRight + camUp * handUp + camForward * handForward;
+        glm::vec3 flashPos = eyePos + camRight * handRight + camUp * handUp + camForward * handForward;
         glm::vec3 flashDir = camForward;
 
         // If flashlight is on, provide flashlight uniforms 
-        if (flashOnLoc >= 0) glUniform1f(flashOnLoc, flashlightOn ? 1.0f : 0.0f);
+        if (flashOnLoc >= 0) glUniform1f(flashOnLoc, snap.flashlightOn ? 1.0f : 0.0f);
         if (flashPosLoc >= 0) glUniform3fv(flashPosLoc, 1, glm::value_ptr(flashPos));
         if (flashDirLoc >= 0) glUniform3fv(flashDirLoc, 1, glm::value_ptr(flashDir));
         if (flashColLoc >= 0)
@@ -1229,7 +1570,12 @@ int main()
         if (flashRangeLoc >= 0) glUniform1f(flashRangeLoc, 60.0f);
         if (lightDirLoc >= 0) glUniform3fv(lightDirLoc, 1, glm::value_ptr(lightDir));
         if (lightColorLoc >= 0) glUniform3fv(lightColorLoc, 1, glm::value_ptr(lightColor));
-        if (viewPosLoc >= 0) glUniform3fv(viewPosLoc, 1, glm::value_ptr(cameraPos));
+        if (viewPosLoc >= 0) glUniform3fv(viewPosLoc, 1, glm::value_ptr(eyePos));
+        glUniformMatrix4fv(currViewProjLoc, 1, GL_FALSE, glm::value_ptr(currViewProj));
+        glUniformMatrix4fv(prevViewProjLoc, 1, GL_FALSE, glm::value_ptr(prevViewProj));
+
+        // Culled against the unjittered frustum, drawn with the jittered one
+        setCullFrustum(cullCtx, currViewProj, eyePos);
 
         // Terrain
         {
@@ -1238,72 +1584,28 @@ int main()
 
             glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
             glUniformMatrix4fv(mvpLoc, 1, GL_FALSE, glm::value_ptr(mvp));
+            glUniformMatrix4fv(prevModelLoc, 1, GL_FALSE, glm::value_ptr(model));
+            glUniformMatrix3fv(normalMatrixLoc, 1, GL_FALSE, glm::value_ptr(glm::mat3(1.0f)));
 
             glActiveTexture(GL_TEXTURE0);
             glBindTexture(GL_TEXTURE_2D, grassTex);
+            noteTextureUse(streamer, grassHandle, 0.0f, 1.0f);     // underfoot, always wants full detail
 
-            glBindVertexArray(terrainVAO);
-            glDrawElements(GL_TRIANGLES, (GLsizei)terrainIndices.size(), GL_UNSIGNED_INT, 0);
-            glBindVertexArray(0);
-        }
-
-        // Trees
-        if (hasTree)
-        {
-            glActiveTexture(GL_TEXTURE0);
-
-            for (const SceneInstance& inst : treeInstances)
+            if (gOpenWorld)
+                drawWorldStream(worldStream, cullCtx);
+            else
             {
-                glm::mat4 model(1.0f);
-                model = glm::translate(model, inst.pos);
-                model = glm::rotate(model, inst.rotY, glm::vec3(0.0f, 1.0f, 0.0f));
-                model = glm::scale(model, glm::vec3(2.0f * inst.scale));
-
-                glm::mat4 mvp = projection * view * model;
-
-                glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-                glUniformMatrix4fv(mvpLoc, 1, GL_FALSE, glm::value_ptr(mvp));
-
-                for (const Mesh& mm : treeMeshes)
-                {
-                    GLuint texToUse = (mm.diffuseTex != 0) ? mm.diffuseTex : ((flashlightBaseTex != 0) ? flashlightBaseTex : grassTex);
-                    glBindTexture(GL_TEXTURE_2D, texToUse);
-
-                    glBindVertexArray(mm.VAO);
-                    glDrawElements(GL_TRIANGLES, mm.indexCount, GL_UNSIGNED_INT, 0);
-                }
+                glBindVertexArray(terrainVAO);
+                glDrawElements(GL_TRIANGLES, (GLsizei)terrainIdxCount, GL_UNSIGNED_INT, 0);
+                glBindVertexArray(0);
             }
-            glBindVertexArray(0);
         }
 
-        // Rocks
-        if (hasRock)
-        {
-            glActiveTexture(GL_TEXTURE0);
-
-            for (const SceneInstance& inst : rockInstances)
-            {
-                glm::mat4 model(1.0f);
-                model = glm::translate(model, inst.pos);
-                model = glm::rotate(model, inst.rotY, glm::vec3(0.0f, 1.0f, 0.0f));
-                model = glm::scale(model, glm::vec3(1.0f * inst.scale));
-
-                glm::mat4 mvp = projection * view * model;
-
-                glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-                glUniformMatrix4fv(mvpLoc, 1, GL_FALSE, glm::value_ptr(mvp));
-
-                for (const Mesh& mm : rockMeshes)
-                {
-                    GLuint texToUse = (mm.diffuseTex != 0) ? mm.diffuseTex : ((flashlightBaseTex != 0) ? flashlightBaseTex : grassTex);
-                    glBindTexture(GL_TEXTURE_2D, texToUse);
-
-                    glBindVertexArray(mm.VAO);
-                    glDrawElements(GL_TRIANGLES, mm.indexCount, GL_UNSIGNED_INT, 0);
-                }
-            }
-            glBindVertexArray(0);
-        }
+        // Props
+        propCtx.viewProj = projection * view;
+        propCtx.fallbackTex = (flashlightBaseTex != 0) ? flashlightBaseTex : grassTex;
+        runSchedule(frameSystems, scene);
+        clearTransformDirty(scene);
 
         // Flashlight
         if (hasFlashlight)
@@ -1311,7 +1613,7 @@ int main()
             glActiveTexture(GL_TEXTURE0);
 
             // Build a camera-relative transform so it stays in place on screen
-            glm::vec3 camForward = glm::normalize(cameraFront);
+            glm::vec3 camForward = glm::normalize(eyeFront);
             glm::vec3 camRight = glm::normalize(glm::cross(camForward, cameraUp));
             glm::vec3 camUp = glm::normalize(glm::cross(camRight, camForward));
 
@@ -1320,7 +1622,7 @@ int main()
             const float handUp = -0.28f;
             const float handForward = 0.30f;
 
-            glm::vec3 handPos = cameraPos + camRight * handRight + camUp * handUp + camForward * handForward;
+            glm::vec3 handPos = eyePos + camRight * handRight + camUp * handUp + camForward * handForward;
 
             // Camera orientation basis as a matrix 
             glm::mat4 orient(1.0f);
@@ -1340,132 +1642,97 @@ int main()
 
             glm::mat4 mvp = projection * view * model;
 
+            glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(model)));
             glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
             glUniformMatrix4fv(mvpLoc, 1, GL_FALSE, glm::value_ptr(mvp));
+            glUniformMatrix3fv(normalMatrixLoc, 1, GL_FALSE, glm::value_ptr(normalMatrix));
+
+            // Camera-attached, so its previous transform comes from last frame's camera
+            glm::mat4 prevModel = hasPrevFlashlight ? prevFlashlightModel : model;
+            glUniformMatrix4fv(prevModelLoc, 1, GL_FALSE, glm::value_ptr(prevModel));
+            prevFlashlightModel = model;
+            hasPrevFlashlight = true;
 
             // Flashlight texture
             glBindTexture(GL_TEXTURE_2D, flashlightBaseTex);
+            noteTextureUse(streamer, flashlightBaseHandle, 0.0f, 1.0f);
 
-            for (const Mesh& mm : flashlightMeshes)
+            glBindVertexArray(flashlightModel.VAO);
+            for (const Mesh& mm : flashlightModel.meshes)
             {
-                glBindVertexArray(mm.VAO);
-                glDrawElements(GL_TRIANGLES, mm.indexCount, GL_UNSIGNED_INT, 0);
+                glDrawElements(GL_TRIANGLES, mm.indexCount, GL_UNSIGNED_INT, (void*)(mm.firstIndex * sizeof(GLuint)));
             }
             glBindVertexArray(0);
         }
 
-        // Sun + Moon 
-        {
-            glm::vec3 worldCenter(0.0f, 0.0f, 0.0f);
-            float skyDist = 600.0f;
-
-            glm::vec3 sunDir = glm::normalize(-lightDir);
-            glm::vec3 moonDir = -sunDir;
+        gpuStageEnd(gpuProf);
 
-            glm::vec3 sunPos = worldCenter + sunDir * skyDist;
-            glm::vec3 moonPos = worldCenter + moonDir * skyDist;
+        // Temporal resolve into the full-resolution history
+        gpuStageBegin(gpuProf, GPU_TAA);
+        renderTemporalAA(post, jitter);
+        gpuStageEnd(gpuProf);
 
-            sunPos.y += 250.0f;
-            moonPos.y += 250.0f;
+        // Post: bloom chain, then tonemap/grade/vignette straight to the backbuffer
+        gpuStageBegin(gpuProf, GPU_BLOOM);
+        renderBloom(post);
+        gpuStageEnd(gpuProf);
 
-            float day = clamp01((sunDir.y + 0.1f) / 0.6f);
-            float night = 1.0f - day;
+        gpuStageBegin(gpuProf, GPU_COMPOSITE);
+        renderComposite(post, gFBWidth, gFBHeight);
+        gpuStageEnd(gpuProf);
 
-            glm::vec3 sunColor = glm::vec3(1.0f, 0.95f, 0.75f);
-            glm::vec3 moonColor = glm::vec3(0.75f, 0.85f, 1.0f);
+        gpuProfilerEndFrame(gpuProf);
+        if (gProfilerReport)
+            reportGpuProfiler(gpuProf, now, 2.0);
 
-            float sunSize = 80.0f;
-            float moonSize = 70.0f;
+        // Mip levels for what was just drawn at the output resolution (TAA upsamples to it)
+        updateTextureStreaming(streamer, (float)gFBHeight, fovY);
 
-            float fadeLook = lookUpFade(cameraFront);
+        prevViewProj = currViewProj;
+        prevViewProjRot = currViewProjRot;
+        frameIndex++;
 
-            glUseProgram(billboardProgram);
-            glBindVertexArray(bbVAO);
-
-            glDisable(GL_DEPTH_TEST);
-
-            // Sun
-            {
-                float fadeH = horizonFade(sunPos, view, projection);
-                float alpha = fadeLook * fadeH;
-                alpha *= (0.35f + 0.65f * day);
-
-                if (alpha > 0.01f)
-                {
-                    glm::mat4 model = makeBillboardModel(sunPos, sunSize, view);
-                    glm::mat4 mvp = projection * view * model;
-
-                    glUniformMatrix4fv(bbMvpLoc, 1, GL_FALSE, glm::value_ptr(mvp));
-                    glUniform3fv(bbColLoc, 1, glm::value_ptr(sunColor));
-                    glUniform1f(bbSoftLoc, 0.02f);
-                    glUniform1f(bbAlphaLoc, alpha);
-
-                    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-                }
-            }
-
-            // Moon
-            {
-                float fadeH = horizonFade(moonPos, view, projection);
-                float alpha = fadeLook * fadeH;
-                alpha *= (0.25f + 0.75f * night);
-
-                if (alpha > 0.01f)
-                {
-                    glm::mat4 model = makeBillboardModel(moonPos, moonSize, view);
-                    glm::mat4 mvp = projection * view * model;
-
-                    glUniformMatrix4fv(bbMvpLoc, 1, GL_FALSE, glm::value_ptr(mvp));
-                    glUniform3fv(bbColLoc, 1, glm::value_ptr(moonColor));
-                    glUniform1f(bbSoftLoc, 0.03f);
-                    glUniform1f(bbAlphaLoc, alpha);
-
-                    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-                }
-            }
-
-            glEnable(GL_DEPTH_TEST);
-            glBindVertexArray(0);
-        }
+        // Swap waits on vsync, so it isn't counted as render thread work
+        recordCpuTime(gpuProf, renderLane, (glfwGetTime() - now) * 1000.0);
 
         glfwSwapBuffers(gWindow);
     }
 
-    // Cleanup
-    glDeleteTextures(1, &grassTex);
+    gSimQuit.store(true);
+    gSimThread.join();
 
+    // Cleanup
     glDeleteVertexArrays(1, &terrainVAO);
     glDeleteBuffers(1, &terrainVBO);
     glDeleteBuffers(1, &terrainEBO);
 
-    for (Mesh& m : treeMeshes)
+    // Loader first: it may still hold waiters pointing into the models
+    // The streamer and upload ring go after the registry, whose frees call back into the streamer
+    destroyAssetLoader(assets);
+    destroyJobSystem(jobs);
+    if (gOpenWorld)
     {
-        if (m.diffuseTex != 0) glDeleteTextures(1, &m.diffuseTex);
-        if (m.VAO != 0)
-        {
-            glDeleteVertexArrays(1, &m.VAO);
-            glDeleteBuffers(1, &m.VBO);
-            glDeleteBuffers(1, &m.EBO);
-        }
+        reportWorldStream(worldStream);
+        destroyWorldStream(worldStream, scene);
     }
 
-    for (Mesh& m : rockMeshes)
-    {
-        if (m.diffuseTex != 0) glDeleteTextures(1, &m.diffuseTex);
-        if (m.VAO != 0)
-        {
-            glDeleteVertexArrays(1, &m.VAO);
-            glDeleteBuffers(1, &m.VBO);
-            glDeleteBuffers(1, &m.EBO);
-        }
-    }
+    releaseTexture(textures, grassHandle);
+    releaseTexture(textures, flashlightBaseHandle);
+    for (Model& model : propModels)
+        destroyModel(model, textures);
+    destroyModel(flashlightModel, textures);
 
-    glDeleteVertexArrays(1, &bbVAO);
-    glDeleteBuffers(1, &bbVBO);
-    glDeleteBuffers(1, &bbEBO);
+    reportTextureRegistry(textures);
+    reportTextureStreaming(streamer);
+    destroyTextureRegistry(textures);
+    destroyTextureStreamer(streamer);
+    destroyUploadRing(uploadRing);
+
+    destroyGpuProfiler(gpuProf);
+    destroyPostProcess(post);
+    destroySky(sky);
 
     glDeleteProgram(shaderProgram);
-    glDeleteProgram(billboardProgram);
 
     // Shut down irrKlang
     if (gSoundEngine)
@@ -1474,6 +1741,10 @@ int main()
         gSoundEngine = nullptr;
     }
 
+    // Last: the sound engine, loader and scene all read straight out of the pack
+    closeSceneFile(sceneFile);
+    unmountAssetPack();
+
     glfwDestroyWindow(gWindow);
     glfwTerminate();
     return 0;